@@ -84,6 +84,25 @@ string_vector make_vector(SEXP const& r_string_vector)
     return v;
 }
 
+/**
+ *  @brief Creates a std::vector of stopping conditions from R vectors of
+ *  quantity names, comparison strings, and thresholds, which should all have
+ *  the same length
+ */
+vector<stopping_condition> stopping_conditions_from_vectors(
+    SEXP const& quantities,
+    SEXP const& comparisons,
+    SEXP const& thresholds)
+{
+    string_vector q = make_vector(quantities);
+    string_vector c = make_vector(comparisons);
+    vector<stopping_condition> conditions;
+    for (size_t i = 0; i < q.size(); ++i) {
+        conditions.push_back({q[i], c[i], REAL(thresholds)[i]});
+    }
+    return conditions;
+}
+
 /**
  *  @brief Creates a std::vector of pointers to module_wrapper_base objects from
  *  an R vector of R external pointer objects
@@ -177,6 +196,22 @@ SEXP list_from_map(std::unordered_map<string, string_vector> const& m)
     return list;
 }
 
+/**
+ *  @brief Creates an unnamed R list whose elements are R lists made from each
+ *  of the `state_vector_map` objects in the input, e.g., the results from each
+ *  member of an ensemble of simulations
+ */
+SEXP list_from_map_vector(std::vector<state_vector_map> const& v)
+{
+    auto n = v.size();
+    SEXP list = PROTECT(Rf_allocVector(VECSXP, n));
+    for (size_t i = 0; i < n; ++i) {
+        SET_VECTOR_ELT(list, i, list_from_map(v[i]));
+    }
+    UNPROTECT(1);
+    return list;
+}
+
 SEXP list_from_module_info(
     std::string const& module_name,
     string_vector const& module_inputs,
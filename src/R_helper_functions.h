@@ -6,6 +6,7 @@
 #include <string>
 #include "module_wrapper.h" // for module_wrapper_base, mwp_vector
 #include "state_map.h"  // for state_map, string_vector
+#include "stopping_criteria.h"  // for stopping_condition
 
 state_map map_from_list(SEXP const& list);
 
@@ -15,12 +16,19 @@ string_vector make_vector(SEXP const& r_string_vector);
 
 mwp_vector mw_vector_from_list(SEXP const& list);
 
+std::vector<stopping_condition> stopping_conditions_from_vectors(
+    SEXP const& quantities,
+    SEXP const& comparisons,
+    SEXP const& thresholds);
+
 SEXP list_from_map(state_map const& m);
 
 SEXP list_from_map(state_vector_map const& m);
 
 SEXP list_from_map(std::unordered_map<std::string, string_vector> const& m);
 
+SEXP list_from_map_vector(std::vector<state_vector_map> const& v);
+
 SEXP list_from_module_info(
     std::string const& module_name,
     string_vector const& module_inputs,
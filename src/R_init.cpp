@@ -0,0 +1,18 @@
+#include <Rinternals.h>
+#include <R_ext/Rdynload.h>  // for DllInfo
+#include "R_lazy_output_columns.h"
+
+extern "C" {
+
+/**
+ *  @brief Called by R when the BioCro library is loaded.
+ *
+ *  The `.Call` entry points are found by name from the `useDynLib` directive
+ *  in the package NAMESPACE file, so they are not registered here.
+ */
+void R_init_BioCro(DllInfo* dll)
+{
+    register_lazy_output_column_class(dll);
+}
+
+}  // extern "C"
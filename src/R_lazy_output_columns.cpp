@@ -0,0 +1,186 @@
+#include <Rinternals.h>
+#include <Rversion.h>
+#include <R_ext/Rdynload.h>  // for DllInfo
+#include <memory>            // for std::shared_ptr
+#include <string>
+#include <vector>
+#include <algorithm>         // for std::copy, std::fill
+#include <exception>         // for std::exception
+#include "lazy_simulation_result.h"
+#include "R_helper_functions.h"
+#include "R_lazy_output_columns.h"
+
+// ALTREP classes are available beginning with R 3.5.0. Older versions of
+// their header use `class` as a parameter name and do not declare C linkage.
+#if R_VERSION >= R_Version(3, 5, 0)
+#define BIOCRO_USE_ALTREP
+#define class altrep_class
+extern "C" {
+#include <R_ext/Altrep.h>
+}
+#undef class
+#endif
+
+using std::string;
+
+namespace
+{
+using lazy_result_ptr = std::shared_ptr<lazy_simulation_result>;
+
+/**
+ *  @brief Releases a column's reference to a lazy result; the result itself is
+ *  deleted along with its last reference.
+ */
+void finalize_lazy_result_pointer(SEXP ptr)
+{
+    delete static_cast<lazy_result_ptr*>(R_ExternalPtrAddr(ptr));
+    R_ClearExternalPtr(ptr);
+}
+
+#ifdef BIOCRO_USE_ALTREP
+
+/*
+ * Each lazy column is an ALTREP real vector. Its first data element is an R
+ * external pointer to a reference to the lazy result, whose tag is the name of
+ * the column's quantity. Its second data element is `R_NilValue` until the
+ * values are needed, when they are calculated and stored there as an ordinary
+ * real vector; the reference to the lazy result is then released. Serializing
+ * a lazy column stores it as an ordinary vector.
+ */
+R_altrep_class_t lazy_output_column_class;
+
+SEXP materialize(SEXP x)
+{
+    SEXP values = R_altrep_data2(x);
+    if (values != R_NilValue) {
+        return values;
+    }
+
+    SEXP ptr = R_altrep_data1(x);
+    lazy_result_ptr const& result = *static_cast<lazy_result_ptr*>(R_ExternalPtrAddr(ptr));
+    string const name = CHAR(STRING_ELT(R_ExternalPtrTag(ptr), 0));
+
+    std::vector<double> column;
+    try {
+        column = result->get_column(name);
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception while calculating a lazy output column: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception while calculating a lazy output column.");
+    }
+
+    values = PROTECT(Rf_allocVector(REALSXP, column.size()));
+    std::copy(column.begin(), column.end(), REAL(values));
+    R_set_altrep_data2(x, values);
+    UNPROTECT(1);  // UNPROTECT values
+
+    finalize_lazy_result_pointer(ptr);
+
+    return values;
+}
+
+R_xlen_t lazy_output_column_length(SEXP x)
+{
+    SEXP values = R_altrep_data2(x);
+    if (values != R_NilValue) {
+        return XLENGTH(values);
+    }
+    lazy_result_ptr const& result =
+        *static_cast<lazy_result_ptr*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+    return result->size();
+}
+
+Rboolean lazy_output_column_inspect(
+    SEXP x, int /*pre*/, int /*deep*/, int /*pvec*/,
+    void (* /*inspect_subtree*/)(SEXP, int, int, int))
+{
+    Rprintf(" biocro_lazy_column %s (%s)\n",
+            CHAR(STRING_ELT(R_ExternalPtrTag(R_altrep_data1(x)), 0)),
+            R_altrep_data2(x) == R_NilValue ? "not calculated" : "calculated");
+    return TRUE;
+}
+
+void* lazy_output_column_dataptr(SEXP x, Rboolean /*writeable*/)
+{
+    return REAL(materialize(x));
+}
+
+const void* lazy_output_column_dataptr_or_null(SEXP x)
+{
+    SEXP values = R_altrep_data2(x);
+    return values == R_NilValue ? nullptr : REAL(values);
+}
+
+double lazy_output_column_elt(SEXP x, R_xlen_t i)
+{
+    return REAL(materialize(x))[i];
+}
+
+#endif
+
+}  // namespace
+
+/**
+ *  @brief Registers the ALTREP class used for lazy output columns; this must be
+ *  called when the package is loaded.
+ */
+void register_lazy_output_column_class(DllInfo* dll)
+{
+#ifdef BIOCRO_USE_ALTREP
+    lazy_output_column_class = R_make_altreal_class("biocro_lazy_column", "BioCro", dll);
+    R_set_altrep_Length_method(lazy_output_column_class, lazy_output_column_length);
+    R_set_altrep_Inspect_method(lazy_output_column_class, lazy_output_column_inspect);
+    R_set_altvec_Dataptr_method(lazy_output_column_class, lazy_output_column_dataptr);
+    R_set_altvec_Dataptr_or_null_method(lazy_output_column_class, lazy_output_column_dataptr_or_null);
+    R_set_altreal_Elt_method(lazy_output_column_class, lazy_output_column_elt);
+#else
+    (void)dll;
+#endif
+}
+
+/**
+ *  @brief Creates a named R list with one column for each output quantity of a
+ *  lazy result, along with the usual `ncalls` column.
+ *
+ *  The output columns are only calculated when R first needs their values. In
+ *  versions of R that do not support ALTREP classes, every column is
+ *  calculated immediately.
+ */
+SEXP list_from_lazy_result(std::shared_ptr<lazy_simulation_result> const& result)
+{
+    string_vector const names = result->get_quantity_names();
+
+#ifdef BIOCRO_USE_ALTREP
+    size_t const ncolumns = names.size();
+
+    SEXP list = PROTECT(Rf_allocVector(VECSXP, ncolumns + 1));
+    SEXP list_names = PROTECT(Rf_allocVector(STRSXP, ncolumns + 1));
+
+    for (size_t i = 0; i < ncolumns; ++i) {
+        SEXP tag = PROTECT(Rf_mkString(names[i].c_str()));
+        SEXP ptr = PROTECT(R_MakeExternalPtr(new lazy_result_ptr(result), tag, R_NilValue));
+
+        R_RegisterCFinalizerEx(
+            ptr,
+            (R_CFinalizer_t)finalize_lazy_result_pointer,
+            TRUE);
+
+        SET_VECTOR_ELT(list, i, R_new_altrep(lazy_output_column_class, ptr, R_NilValue));
+        SET_STRING_ELT(list_names, i, Rf_mkChar(names[i].c_str()));
+        UNPROTECT(2);  // UNPROTECT tag and ptr
+    }
+
+    SEXP ncalls = PROTECT(Rf_allocVector(REALSXP, result->size()));
+    std::fill(REAL(ncalls), REAL(ncalls) + result->size(), result->get_ncalls());
+    SET_VECTOR_ELT(list, ncolumns, ncalls);
+    SET_STRING_ELT(list_names, ncolumns, Rf_mkChar("ncalls"));
+
+    Rf_setAttrib(list, R_NamesSymbol, list_names);
+    UNPROTECT(3);  // UNPROTECT list, list_names, and ncalls
+    return list;
+#else
+    state_vector_map columns = result->get_columns(names);
+    columns["ncalls"] = std::vector<double>(result->size(), result->get_ncalls());
+    return list_from_map(columns);
+#endif
+}
@@ -0,0 +1,13 @@
+#ifndef R_LAZY_OUTPUT_COLUMNS_H
+#define R_LAZY_OUTPUT_COLUMNS_H
+
+#include <Rinternals.h>
+#include <R_ext/Rdynload.h>  // for DllInfo
+#include <memory>            // for std::shared_ptr
+#include "lazy_simulation_result.h"
+
+void register_lazy_output_column_class(DllInfo* dll);
+
+SEXP list_from_lazy_result(std::shared_ptr<lazy_simulation_result> const& result);
+
+#endif
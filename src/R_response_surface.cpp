@@ -0,0 +1,111 @@
+#include <Rinternals.h>
+#include <memory>       // for std::shared_ptr
+#include <string>
+#include <vector>
+#include <exception>    // for std::exception
+#include "state_map.h"  // for state_map, state_vector_map, string_vector
+#include "utils/response_surface.h"
+#include "module_library/module_wrapper_factory.h"
+#include "R_helper_functions.h"
+
+using std::string;
+
+namespace
+{
+/**
+ *  @brief Describes a response surface using an R list with the following
+ *  elements: `module_names`, `fixed_inputs`, `grid`, `estimated_abs_error`,
+ *  `output_range`, and `ncheck`
+ */
+SEXP list_from_response_surface(response_surface const& rs)
+{
+    state_vector_map grid;
+    for (size_t a = 0; a < rs.get_axis_names().size(); ++a) {
+        grid[rs.get_axis_names()[a]] = rs.get_axis_points()[a];
+    }
+
+    state_map estimated_abs_error;
+    state_map output_range;
+    std::vector<double> const ranges = rs.get_output_ranges();
+    for (size_t j = 0; j < rs.get_output_names().size(); ++j) {
+        estimated_abs_error[rs.get_output_names()[j]] = rs.get_estimated_abs_errors()[j];
+        output_range[rs.get_output_names()[j]] = ranges[j];
+    }
+
+    SEXP ans = PROTECT(Rf_allocVector(VECSXP, 6));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 6));
+
+    SET_VECTOR_ELT(ans, 0, r_string_vector_from_vector(rs.get_module_names()));
+    SET_VECTOR_ELT(ans, 1, list_from_map(rs.get_fixed_inputs()));
+    SET_VECTOR_ELT(ans, 2, list_from_map(grid));
+    SET_VECTOR_ELT(ans, 3, vector_from_map(estimated_abs_error));
+    SET_VECTOR_ELT(ans, 4, vector_from_map(output_range));
+    SET_VECTOR_ELT(ans, 5, Rf_ScalarReal(rs.get_ncheck()));
+
+    SET_STRING_ELT(names, 0, Rf_mkChar("module_names"));
+    SET_STRING_ELT(names, 1, Rf_mkChar("fixed_inputs"));
+    SET_STRING_ELT(names, 2, Rf_mkChar("grid"));
+    SET_STRING_ELT(names, 3, Rf_mkChar("estimated_abs_error"));
+    SET_STRING_ELT(names, 4, Rf_mkChar("output_range"));
+    SET_STRING_ELT(names, 5, Rf_mkChar("ncheck"));
+
+    Rf_setAttrib(ans, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return ans;
+}
+}  // namespace
+
+extern "C" {
+
+SEXP R_tabulate_response_surface(
+    SEXP module_names,
+    SEXP fixed_inputs,
+    SEXP grid,
+    SEXP output_names,
+    SEXP ncheck,
+    SEXP file)
+{
+    try {
+        string_vector modules = make_vector(module_names);
+        state_map fixed = map_from_list(fixed_inputs);
+        string_vector outputs = make_vector(output_names);
+
+        // Keep the axes in the order they were given
+        string_vector axis_names = make_vector(Rf_getAttrib(grid, R_NamesSymbol));
+        std::vector<std::vector<double>> axis_points;
+        for (size_t a = 0; a < axis_names.size(); ++a) {
+            SEXP points = VECTOR_ELT(grid, a);
+            axis_points.push_back(std::vector<double>(REAL(points), REAL(points) + Rf_length(points)));
+        }
+
+        response_surface rs = response_surface::tabulate(
+            modules, fixed, axis_names, axis_points, outputs,
+            static_cast<size_t>(REAL(ncheck)[0]));
+
+        rs.save(CHAR(STRING_ELT(file, 0)));
+
+        return list_from_response_surface(rs);
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception in R_tabulate_response_surface: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_tabulate_response_surface.");
+    }
+}
+
+SEXP R_load_response_surface(SEXP file, SEXP emulator_name)
+{
+    try {
+        auto rs = std::make_shared<response_surface const>(
+            response_surface::load(CHAR(STRING_ELT(file, 0))));
+
+        module_wrapper_factory::register_emulator(CHAR(STRING_ELT(emulator_name, 0)), rs);
+
+        return list_from_response_surface(*rs);
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception in R_load_response_surface: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_load_response_surface.");
+    }
+}
+
+}  // extern "C"
@@ -1,9 +1,13 @@
 #include <Rinternals.h>
 #include <string>
+#include <vector>
+#include <memory>       // for std::shared_ptr
 #include <exception>    // for std::exception
 #include "state_map.h"  // for state_map, state_vector_map, string_vector
 #include "biocro_simulation.h"
+#include "solver_diagnostics.h"
 #include "R_helper_functions.h"
+#include "R_lazy_output_columns.h"
 
 using std::string;
 
@@ -20,7 +24,15 @@ SEXP R_run_biocro(
     SEXP solver_adaptive_rel_error_tol,
     SEXP solver_adaptive_abs_error_tol,
     SEXP solver_adaptive_max_steps,
-    SEXP verbose)
+    SEXP solver_jacobian_threads,
+    SEXP solver_fast_modules,
+    SEXP verbose,
+    SEXP stopping_quantities,
+    SEXP stopping_comparisons,
+    SEXP stopping_thresholds,
+    SEXP return_diagnostics,
+    SEXP lazy_outputs,
+    SEXP cached_modules)
 {
     try {
         state_map iv = map_from_list(initial_values);
@@ -40,18 +52,69 @@ SEXP R_run_biocro(
         double adaptive_rel_error_tol = REAL(solver_adaptive_rel_error_tol)[0];
         double adaptive_abs_error_tol = REAL(solver_adaptive_abs_error_tol)[0];
         int adaptive_max_steps = (int)REAL(solver_adaptive_max_steps)[0];
+        int jacobian_threads = (int)REAL(solver_jacobian_threads)[0];
+        string_vector fast_module_names = make_vector(solver_fast_modules);
+        string_vector cached_module_names = make_vector(cached_modules);
+
+        std::vector<stopping_condition> stopping_conditions =
+            stopping_conditions_from_vectors(stopping_quantities,
+                                             stopping_comparisons,
+                                             stopping_thresholds);
 
         biocro_simulation gro(iv, p, d, direct_names, differential_names,
                               solver_type_string, output_step_size,
                               adaptive_rel_error_tol, adaptive_abs_error_tol,
-                              adaptive_max_steps);
-        state_vector_map result = gro.run_simulation();
+                              adaptive_max_steps, stopping_conditions);
+        gro.set_jacobian_threads(jacobian_threads);
+        gro.set_fast_modules(fast_module_names);
+        gro.set_cached_modules(cached_module_names);
+
+        // Only the differential quantities are stored for lazy outputs; the
+        // other columns are calculated when R needs them
+        if (LOGICAL(lazy_outputs)[0]) {
+            bool const with_diagnostics = LOGICAL(return_diagnostics)[0];
+            solver_diagnostics diagnostics;
+            std::shared_ptr<lazy_simulation_result> result =
+                gro.run_simulation_lazily(with_diagnostics ? &diagnostics : nullptr);
+
+            if (loquacious) {
+                Rprintf(gro.generate_report().c_str());
+            }
+
+            if (!with_diagnostics) {
+                return list_from_lazy_result(result);
+            }
+
+            SEXP ans = PROTECT(Rf_allocVector(VECSXP, 2));
+            SET_VECTOR_ELT(ans, 0, list_from_lazy_result(result));
+            SET_VECTOR_ELT(ans, 1, list_from_map(diagnostics.get_results()));
+            UNPROTECT(1);
+            return ans;
+        }
+
+        if (!LOGICAL(return_diagnostics)[0]) {
+            state_vector_map result = gro.run_simulation();
+
+            if (loquacious) {
+                Rprintf(gro.generate_report().c_str());
+            }
+
+            return list_from_map(result);
+        }
+
+        // Return the result along with the solver diagnostics
+        solver_diagnostics diagnostics;
+        state_vector_map result = gro.run_simulation(diagnostics);
 
         if (loquacious) {
             Rprintf(gro.generate_report().c_str());
         }
 
-        return list_from_map(result);
+        SEXP ans = PROTECT(Rf_allocVector(VECSXP, 2));
+        SET_VECTOR_ELT(ans, 0, list_from_map(result));
+        SET_VECTOR_ELT(ans, 1, list_from_map(diagnostics.get_results()));
+        UNPROTECT(1);
+        return ans;
     } catch (std::exception const& e) {
         Rf_error(string(string("Caught exception in R_run_biocro: ") + e.what()).c_str());
     } catch (...) {
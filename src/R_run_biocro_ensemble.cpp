@@ -0,0 +1,68 @@
+#include <Rinternals.h>
+#include <string>
+#include <vector>
+#include <exception>    // for std::exception
+#include "state_map.h"  // for state_map, state_vector_map, string_vector
+#include "biocro_ensemble.h"
+#include "R_helper_functions.h"
+
+using std::string;
+
+extern "C" {
+
+SEXP R_run_biocro_ensemble(
+    SEXP initial_values,
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_module_names,
+    SEXP differential_module_names,
+    SEXP member_values,
+    SEXP solver_type,
+    SEXP solver_output_step_size,
+    SEXP verbose,
+    SEXP share_prefix,
+    SEXP activation_times)
+{
+    try {
+        state_map iv = map_from_list(initial_values);
+        state_map p = map_from_list(parameters);
+        state_vector_map d = map_vector_from_list(drivers);
+
+        if (d.begin()->second.size() == 0) {
+            return R_NilValue;
+        }
+
+        string_vector direct_names = make_vector(direct_module_names);
+        string_vector differential_names = make_vector(differential_module_names);
+
+        std::vector<state_map> members;
+        size_t n = Rf_length(member_values);
+        for (size_t i = 0; i < n; ++i) {
+            members.push_back(map_from_list(VECTOR_ELT(member_values, i)));
+        }
+
+        bool loquacious = LOGICAL(VECTOR_ELT(verbose, 0))[0];
+        string solver_type_string = CHAR(STRING_ELT(solver_type, 0));
+        double output_step_size = REAL(solver_output_step_size)[0];
+        bool share = LOGICAL(share_prefix)[0];
+        state_map activation = map_from_list(activation_times);
+
+        biocro_ensemble ensemble(iv, p, d, direct_names, differential_names,
+                                 members, solver_type_string, output_step_size,
+                                 share, activation);
+
+        std::vector<state_vector_map> results = ensemble.run_ensemble();
+
+        if (loquacious) {
+            Rprintf(ensemble.generate_report().c_str());
+        }
+
+        return list_from_map_vector(results);
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception in R_run_biocro_ensemble: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_run_biocro_ensemble.");
+    }
+}
+
+}  // extern "C"
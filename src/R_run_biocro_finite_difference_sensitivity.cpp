@@ -0,0 +1,61 @@
+#include <Rinternals.h>
+#include <string>
+#include <vector>
+#include <exception>    // for std::exception
+#include "state_map.h"  // for state_map, state_vector_map, string_vector
+#include "biocro_finite_difference_sensitivity.h"
+#include "R_helper_functions.h"
+
+using std::string;
+
+extern "C" {
+
+SEXP R_run_biocro_finite_difference_sensitivity(
+    SEXP initial_values,
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_module_names,
+    SEXP differential_module_names,
+    SEXP sensitivity_names,
+    SEXP relative_step,
+    SEXP verbose)
+{
+    try {
+        state_map iv = map_from_list(initial_values);
+        state_map p = map_from_list(parameters);
+        state_vector_map d = map_vector_from_list(drivers);
+
+        if (d.begin()->second.size() == 0) {
+            return R_NilValue;
+        }
+
+        string_vector direct_names = make_vector(direct_module_names);
+        string_vector differential_names = make_vector(differential_module_names);
+        string_vector sens_names = make_vector(sensitivity_names);
+
+        bool loquacious = LOGICAL(VECTOR_ELT(verbose, 0))[0];
+        double step = REAL(relative_step)[0];
+
+        biocro_finite_difference_sensitivity sim(
+            iv, p, d, direct_names, differential_names, sens_names, step);
+
+        std::vector<state_vector_map> sensitivities;
+        state_vector_map result = sim.run_simulation(sensitivities);
+
+        if (loquacious) {
+            Rprintf(sim.generate_report().c_str());
+        }
+
+        SEXP ans = PROTECT(Rf_allocVector(VECSXP, 2));
+        SET_VECTOR_ELT(ans, 0, list_from_map(result));
+        SET_VECTOR_ELT(ans, 1, list_from_map_vector(sensitivities));
+        UNPROTECT(1);
+        return ans;
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception in R_run_biocro_finite_difference_sensitivity: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_run_biocro_finite_difference_sensitivity.");
+    }
+}
+
+}  // extern "C"
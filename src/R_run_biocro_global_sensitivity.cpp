@@ -0,0 +1,101 @@
+#include <Rinternals.h>
+#include <string>
+#include <vector>
+#include <exception>    // for std::exception
+#include "state_map.h"  // for state_map, state_vector_map, string_vector
+#include "biocro_global_sensitivity.h"
+#include "R_helper_functions.h"
+
+using std::string;
+
+extern "C" {
+
+SEXP R_run_biocro_global_sensitivity(
+    SEXP initial_values,
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_module_names,
+    SEXP differential_module_names,
+    SEXP range_names,
+    SEXP range_lower,
+    SEXP range_upper,
+    SEXP output_quantities,
+    SEXP output_ops,
+    SEXP design,
+    SEXP nsamples,
+    SEXP seed,
+    SEXP threads,
+    SEXP solver_type,
+    SEXP solver_output_step_size,
+    SEXP solver_adaptive_rel_error_tol,
+    SEXP solver_adaptive_abs_error_tol,
+    SEXP solver_adaptive_max_steps,
+    SEXP verbose)
+{
+    try {
+        state_map iv = map_from_list(initial_values);
+        state_map p = map_from_list(parameters);
+        state_vector_map d = map_vector_from_list(drivers);
+
+        if (d.begin()->second.size() == 0) {
+            return R_NilValue;
+        }
+
+        string_vector direct_names = make_vector(direct_module_names);
+        string_vector differential_names = make_vector(differential_module_names);
+
+        string_vector names = make_vector(range_names);
+        std::vector<parameter_range> ranges;
+        for (size_t i = 0; i < names.size(); ++i) {
+            ranges.push_back({names[i], REAL(range_lower)[i], REAL(range_upper)[i]});
+        }
+
+        // The window of each output is set by biocro_global_sensitivity
+        string_vector quantities = make_vector(output_quantities);
+        string_vector ops = make_vector(output_ops);
+        std::vector<output_reduction> outputs;
+        for (size_t i = 0; i < quantities.size(); ++i) {
+            outputs.push_back({quantities[i], 0.0, ops[i]});
+        }
+
+        string design_name = CHAR(STRING_ELT(design, 0));
+        size_t number_of_samples = (size_t)REAL(nsamples)[0];
+        unsigned random_seed = (unsigned)REAL(seed)[0];
+        size_t number_of_threads = (size_t)REAL(threads)[0];
+
+        bool loquacious = LOGICAL(VECTOR_ELT(verbose, 0))[0];
+        string solver_type_string = CHAR(STRING_ELT(solver_type, 0));
+        double output_step_size = REAL(solver_output_step_size)[0];
+        double adaptive_rel_error_tol = REAL(solver_adaptive_rel_error_tol)[0];
+        double adaptive_abs_error_tol = REAL(solver_adaptive_abs_error_tol)[0];
+        int adaptive_max_steps = (int)REAL(solver_adaptive_max_steps)[0];
+
+        biocro_global_sensitivity gsa(iv, p, d, direct_names, differential_names,
+                                      ranges, outputs, design_name,
+                                      number_of_samples, random_seed,
+                                      solver_type_string, output_step_size,
+                                      adaptive_rel_error_tol, adaptive_abs_error_tol,
+                                      adaptive_max_steps);
+        gsa.run(number_of_threads);
+
+        if (loquacious) {
+            Rprintf(gsa.generate_report().c_str());
+        }
+
+        state_vector_map result;
+        result["first_order"] = gsa.get_first_order_indices();
+        result["total"] = gsa.get_total_indices();
+        result["mean"] = gsa.get_output_means();
+        result["variance"] = gsa.get_output_variances();
+        result["nsamples"] = std::vector<double>{static_cast<double>(gsa.get_nsamples())};
+        result["nskipped"] = std::vector<double>{static_cast<double>(gsa.get_nskipped())};
+
+        return list_from_map(result);
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception in R_run_biocro_global_sensitivity: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_run_biocro_global_sensitivity.");
+    }
+}
+
+}  // extern "C"
@@ -0,0 +1,131 @@
+#include <Rinternals.h>
+#include <string>
+#include <vector>
+#include <exception>    // for std::exception
+#include "state_map.h"  // for state_map, state_vector_map, string_vector
+#include "biocro_simulation.h"
+#include "biocro_ensemble.h"
+#include "calibration_objective.h"
+#include "output_observer.h"
+#include "R_helper_functions.h"
+
+using std::string;
+
+namespace
+{
+// Describes the comparison between a simulation and the observations
+state_vector_map table_from_objective(calibration_objective const& objective)
+{
+    state_vector_map table;
+    table["objective"] = std::vector<double>{objective.get_objective()};
+    table["predicted"] = objective.get_predictions();
+    table["residual"] = objective.get_residuals();
+    table["weighted_residual"] = objective.get_weighted_residuals();
+    return table;
+}
+}  // namespace
+
+extern "C" {
+
+SEXP R_run_biocro_objective(
+    SEXP initial_values,
+    SEXP parameters,
+    SEXP drivers,
+    SEXP direct_module_names,
+    SEXP differential_module_names,
+    SEXP member_values,
+    SEXP observation_times,
+    SEXP observation_quantities,
+    SEXP observation_values,
+    SEXP observation_weights,
+    SEXP loss,
+    SEXP solver_type,
+    SEXP solver_output_step_size,
+    SEXP solver_adaptive_rel_error_tol,
+    SEXP solver_adaptive_abs_error_tol,
+    SEXP solver_adaptive_max_steps,
+    SEXP verbose)
+{
+    try {
+        state_map iv = map_from_list(initial_values);
+        state_map p = map_from_list(parameters);
+        state_vector_map d = map_vector_from_list(drivers);
+
+        if (d.begin()->second.size() == 0) {
+            return R_NilValue;
+        }
+
+        string_vector direct_names = make_vector(direct_module_names);
+        string_vector differential_names = make_vector(differential_module_names);
+
+        string_vector quantities = make_vector(observation_quantities);
+        std::vector<observation> observations;
+        for (size_t i = 0; i < quantities.size(); ++i) {
+            observations.push_back({REAL(observation_times)[i], quantities[i],
+                                    REAL(observation_values)[i],
+                                    REAL(observation_weights)[i]});
+        }
+        string loss_name = CHAR(STRING_ELT(loss, 0));
+
+        bool loquacious = LOGICAL(VECTOR_ELT(verbose, 0))[0];
+        string solver_type_string = CHAR(STRING_ELT(solver_type, 0));
+        double output_step_size = REAL(solver_output_step_size)[0];
+        double adaptive_rel_error_tol = REAL(solver_adaptive_rel_error_tol)[0];
+        double adaptive_abs_error_tol = REAL(solver_adaptive_abs_error_tol)[0];
+        int adaptive_max_steps = (int)REAL(solver_adaptive_max_steps)[0];
+
+        std::vector<state_vector_map> results;
+
+        if (Rf_length(member_values) == 0) {
+            // A single simulation, which can use any ode_solver
+            calibration_objective objective(observations, loss_name);
+
+            biocro_simulation gro(iv, p, d, direct_names, differential_names,
+                                  solver_type_string, output_step_size,
+                                  adaptive_rel_error_tol, adaptive_abs_error_tol,
+                                  adaptive_max_steps);
+            gro.run_simulation(objective);
+
+            if (loquacious) {
+                Rprintf(gro.generate_report().c_str());
+            }
+
+            results.push_back(table_from_objective(objective));
+        } else {
+            // An ensemble of simulations
+            std::vector<state_map> members;
+            size_t n = Rf_length(member_values);
+            for (size_t i = 0; i < n; ++i) {
+                members.push_back(map_from_list(VECTOR_ELT(member_values, i)));
+            }
+
+            std::vector<calibration_objective> objectives(
+                n, calibration_objective(observations, loss_name));
+
+            std::vector<output_observer*> observers;
+            for (calibration_objective& objective : objectives) {
+                observers.push_back(&objective);
+            }
+
+            biocro_ensemble ensemble(iv, p, d, direct_names, differential_names,
+                                     members, solver_type_string, output_step_size);
+            ensemble.run_ensemble(observers);
+
+            if (loquacious) {
+                Rprintf(ensemble.generate_report().c_str());
+            }
+
+            for (calibration_objective const& objective : objectives) {
+                results.push_back(table_from_objective(objective));
+            }
+        }
+
+        return list_from_map_vector(results);
+    } catch (std::exception const& e) {
+        Rf_error(string(string("Caught exception in R_run_biocro_objective: ") + e.what()).c_str());
+    } catch (...) {
+        Rf_error("Caught unhandled exception in R_run_biocro_objective.");
+    }
+}
+
+}  // extern "C"
@@ -0,0 +1,381 @@
+#ifndef BIOCRO_ENSEMBLE_H
+#define BIOCRO_ENSEMBLE_H
+
+#include <vector>
+#include <string>
+#include <memory>     // for std::shared_ptr
+#include <limits>     // for std::numeric_limits
+#include <algorithm>  // for std::min
+#include <cmath>      // for std::floor
+#include <stdexcept>  // for std::out_of_range, std::logic_error
+#include "state_map.h"
+#include "dynamical_system.h"
+#include "output_observer.h"
+#include "ode_solver_library/ensemble_member_solver.h"
+
+// Class that represents an ensemble of BioCro simulations that share the same
+// module lists and drivers but use different values for some of their
+// parameters or initial values. The members share a single copy of the
+// drivers, along with the outputs of any direct modules that only depend on
+// the drivers and on parameters that are the same for all members. Otherwise,
+// the members are integrated one after another, each in the same way as a
+// separate simulation.
+//
+// When `share_prefix` is true, the ensemble also shares the beginning of the
+// simulation: a "trunk" simulation using the base parameters and initial
+// values is run first, and each member begins from the trunk's state at the
+// first step where its own values would make a difference. Before then, its
+// output is copied from the trunk. That step is found in one of two ways:
+//
+// - A parameter may be given an activation time, in units of the `time`
+//   driver, before which it is declared to have no effect on the simulation.
+//
+// - Otherwise, after each derivative calculation of the trunk, its system
+//   checks whether the member's values would change any output quantity or
+//   derivative; see `dynamical_system::parameter_change_affects_outputs`.
+//
+// Prefix sharing cannot be used with modules that require an Euler ode_solver
+// or with other modules that keep information between calls, such as
+// `c4_canopy_warm_start`. A member could not inherit that information from the
+// trunk, and the extra calls made to check each member's values would disturb
+// the trunk's own results. A member that changes an initial value begins at
+// the first step. If the trunk stops early, any member that has not begun yet
+// begins at its last step. A member's `ncalls` column only counts the
+// derivatives calculated after it began. Outputs observed by `output_observer`
+// objects do not use the trunk.
+class biocro_ensemble
+{
+   public:
+    biocro_ensemble(
+        // parameters passed to each dynamical_system constructor
+        state_map const& initial_values,
+        state_map const& parameters,
+        state_vector_map const& drivers,
+        string_vector const& direct_module_names,
+        string_vector const& differential_module_names,
+        // the values that change between members of the ensemble
+        std::vector<state_map> const& member_values,
+        // parameters passed to the ensemble_member_solver constructor
+        std::string ode_solver_name,
+        double output_step_size,
+        // settings for sharing the beginning of the simulation
+        bool share_prefix = false,
+        state_map const& activation_times = {})
+        : solver{ode_solver_name, output_step_size},
+          trunk_solver{ode_solver_name, output_step_size},
+          uses_euler{ode_solver_name == "homemade_euler"},
+          step_size{output_step_size}
+    {
+        for (state_map const& member : member_values) {
+            state_map member_initial_values = initial_values;
+            state_map member_parameters = parameters;
+
+            for (auto const& x : member) {
+                if (member_initial_values.count(x.first) > 0) {
+                    member_initial_values[x.first] = x.second;
+                } else if (member_parameters.count(x.first) > 0) {
+                    member_parameters[x.first] = x.second;
+                } else {
+                    throw std::out_of_range(
+                        std::string("\"") + x.first + std::string("\" was ") +
+                        std::string("given as an ensemble member value, but ") +
+                        std::string("it is not one of the initial values or ") +
+                        std::string("parameters.\n"));
+                }
+            }
+
+            members.push_back(std::shared_ptr<dynamical_system>(
+                new dynamical_system(member_initial_values, member_parameters,
+                                     drivers, direct_module_names,
+                                     differential_module_names)));
+
+            members.back()->precalculate_driver_modules();
+        }
+
+        if (!share_prefix) {
+            if (!activation_times.empty()) {
+                throw std::out_of_range(
+                    std::string("Activation times can only be used when the ") +
+                    std::string("ensemble shares the beginning of its simulation.\n"));
+            }
+            return;
+        }
+
+        trunk = std::shared_ptr<dynamical_system>(
+            new dynamical_system(initial_values, parameters, drivers,
+                                 direct_module_names, differential_module_names));
+
+        // Modules that keep state would be disturbed by the extra calls made
+        // to check the members, and their state could not be inherited
+        if (trunk->has_stateful_modules()) {
+            throw std::out_of_range(
+                std::string("The beginning of the simulation cannot be shared ") +
+                std::string("when one or more modules keeps information from ") +
+                std::string("its previous calls.\n"));
+        }
+
+        // Other modules that require an Euler ode_solver store their own
+        // history, which a member could not inherit from the trunk
+        if (trunk->requires_euler_ode_solver()) {
+            throw std::out_of_range(
+                std::string("The beginning of the simulation cannot be shared ") +
+                std::string("when one or more modules requires an Euler ode_solver.\n"));
+        }
+
+        trunk->precalculate_driver_modules();
+
+        // Find the step where each member must begin, or how to detect it
+        for (auto const& x : activation_times) {
+            if (parameters.count(x.first) == 0) {
+                throw std::out_of_range(
+                    std::string("\"") + x.first + std::string("\" was given ") +
+                    std::string("an activation time, but it is not one of the ") +
+                    std::string("parameters.\n"));
+            }
+        }
+
+        for (state_map const& member : member_values) {
+            size_t first_step = never;
+            state_map probed_values;
+
+            for (auto const& x : member) {
+                if (initial_values.count(x.first) > 0) {
+                    if (x.second != initial_values.at(x.first)) {
+                        first_step = 0;
+                    }
+                } else if (x.second == parameters.at(x.first)) {
+                    continue;
+                } else if (activation_times.count(x.first) > 0) {
+                    first_step = std::min(
+                        first_step,
+                        get_activation_step(drivers, activation_times.at(x.first)));
+                } else {
+                    probed_values[x.first] = x.second;
+                }
+            }
+
+            declared_steps.push_back(first_step);
+            probes.push_back(trunk->make_parameter_change_probe(probed_values));
+        }
+    }
+
+    std::vector<state_vector_map> run_ensemble()
+    {
+        if (trunk) {
+            return run_ensemble_from_trunk();
+        }
+
+        std::vector<state_vector_map> results;
+        member_reports.clear();
+        for (auto const& member : members) {
+            results.push_back(solver.integrate(member));
+            member_reports.push_back(solver.generate_integrate_report());
+        }
+        return results;
+    }
+
+    // Runs the ensemble while passing each output time point of each member
+    // to the corresponding observer rather than storing it
+    void run_ensemble(std::vector<output_observer*> const& observers)
+    {
+        if (observers.size() != members.size()) {
+            throw std::logic_error(
+                std::string("Thrown by biocro_ensemble::run_ensemble: there ") +
+                std::string("must be one output observer for each member.\n"));
+        }
+
+        member_reports.clear();
+        for (size_t m = 0; m < members.size(); ++m) {
+            solver.integrate(members[m], observers[m]);
+            member_reports.push_back(solver.generate_integrate_report());
+        }
+    }
+
+    std::string generate_report() const
+    {
+        std::string report;
+        if (!members.empty()) {
+            report += "\nSystem startup information (first member):\n" +
+                      members[0]->generate_startup_report();
+        }
+        if (trunk) {
+            report += "\n\nThe shared simulation (trunk) reports the following:\n" +
+                      trunk_solver.generate_integrate_report();
+        }
+        report += "\n\nThe ensemble ODE solver reports the following:\n";
+        for (size_t m = 0; m < member_reports.size(); ++m) {
+            report += std::string("Member ") + std::to_string(m) + std::string(": ") +
+                      member_reports[m];
+        }
+        return report + "\n";
+    }
+
+   private:
+    static constexpr size_t never = std::numeric_limits<size_t>::max();
+
+    std::vector<std::shared_ptr<dynamical_system>> members;
+    ensemble_member_solver solver;
+    std::vector<std::string> member_reports;
+
+    // For sharing the beginning of the simulation
+    std::shared_ptr<dynamical_system> trunk;
+    ensemble_member_solver trunk_solver;
+    bool const uses_euler;
+    double const step_size;
+    std::vector<size_t> declared_steps;
+    std::vector<parameter_change_probe> probes;
+    std::vector<size_t> first_steps;
+
+    /**
+     *  @brief Returns the first step that can be affected by a parameter with
+     *  the given activation time, or `never` if there is no such step.
+     *
+     *  The derivatives for a step are evaluated at times up to its end, so this
+     *  is the first step that ends at or after the activation time.
+     */
+    size_t get_activation_step(state_vector_map const& drivers, double activation_time) const
+    {
+        if (drivers.count("time") == 0) {
+            throw std::out_of_range(
+                std::string("Activation times can only be used when the ") +
+                std::string("drivers include `time`.\n"));
+        }
+
+        std::vector<double> const& time = drivers.at("time");
+        double const end_index = time.size() - 1.0;
+
+        // Linearly interpolate the time at a fractional time index
+        auto time_at = [&time](double index) {
+            size_t const i = static_cast<size_t>(index);
+            double const f = index - i;
+            return f == 0 ? time[i] : time[i] + f * (time[i + 1] - time[i]);
+        };
+
+        for (size_t k = 0;; ++k) {
+            // Each Euler step only uses the time at its beginning
+            double const index = uses_euler ? k : (k + 1) * step_size;
+            if (index - end_index > std::numeric_limits<double>::epsilon()) {
+                return never;
+            }
+            if (time_at(std::min(index, end_index)) >= activation_time) {
+                return k;
+            }
+        }
+    }
+
+    // Returns the time index at the beginning of a step
+    double get_step_time(size_t step) const
+    {
+        return uses_euler ? step : static_cast<double>(step) * step_size;
+    }
+
+    std::vector<state_vector_map> run_ensemble_from_trunk()
+    {
+        size_t const nmembers = members.size();
+        first_steps.assign(nmembers, size_t(never));
+        std::vector<std::vector<double>> first_states(nmembers);
+
+        // Members that begin at the first step do not need the trunk
+        size_t remaining = 0;
+        for (size_t m = 0; m < nmembers; ++m) {
+            if (declared_steps[m] == 0) {
+                first_steps[m] = 0;
+            } else {
+                ++remaining;
+            }
+        }
+
+        state_vector_map trunk_result;
+        if (remaining > 0) {
+            size_t last_step = never;
+            std::vector<double> last_state;
+
+            // Called after each derivative calculation of the trunk; the trunk
+            // is ended once every member has begun
+            auto check_members = [&](size_t step, std::vector<double> const& state) {
+                if (step != last_step) {
+                    last_step = step;
+                    last_state = state;
+                }
+
+                for (size_t m = 0; m < nmembers; ++m) {
+                    if (first_steps[m] != never) {
+                        continue;
+                    }
+
+                    bool const begins =
+                        step >= declared_steps[m] ||
+                        (!probes[m].new_values.empty() &&
+                         trunk->parameter_change_affects_outputs(probes[m]));
+
+                    if (begins) {
+                        first_steps[m] = step;
+                        first_states[m] = state;
+                        --remaining;
+                    }
+                }
+
+                return remaining > 0;
+            };
+
+            trunk_result = trunk_solver.integrate(trunk, nullptr, 0, check_members);
+
+            // If the trunk stopped early, the remaining members begin at its
+            // last step
+            if (remaining > 0 && !trunk_solver.get_completed()) {
+                for (size_t m = 0; m < nmembers; ++m) {
+                    if (first_steps[m] == never) {
+                        first_steps[m] = last_step == never ? 0 : last_step;
+                        first_states[m] = last_state;
+                    }
+                }
+            }
+        }
+
+        // Run the members that do not use the trunk for the whole simulation,
+        // beginning from the trunk's state at their first steps, and combine
+        // the trunk's output before each member's first step with the
+        // member's own output
+        std::vector<state_vector_map> results(nmembers);
+        member_reports.clear();
+        for (size_t m = 0; m < nmembers; ++m) {
+            if (first_steps[m] == never) {
+                results[m] = trunk_result;
+                results[m]["ncalls"].assign(results[m]["ncalls"].size(), 0.0);
+                member_reports.push_back(std::string("used the trunk for the whole simulation\n"));
+                continue;
+            }
+
+            if (first_steps[m] > 0) {
+                double const t = get_step_time(first_steps[m]);
+                if (t == std::floor(t)) {
+                    members[m]->update_all_quantities(first_states[m], static_cast<size_t>(t));
+                } else {
+                    members[m]->update_all_quantities(first_states[m], t);
+                }
+            }
+
+            state_vector_map const member_result = solver.integrate(members[m], nullptr, first_steps[m]);
+            member_reports.push_back(solver.generate_integrate_report());
+
+            size_t const nshared = std::min(first_steps[m], trunk_result.empty() ? 0 : trunk_result.begin()->second.size());
+
+            for (auto const& x : member_result) {
+                std::vector<double> column;
+                if (nshared > 0) {
+                    std::vector<double> const& shared = trunk_result.at(x.first);
+                    column.assign(shared.begin(), shared.begin() + nshared);
+                }
+                column.insert(column.end(), x.second.begin(), x.second.end());
+                results[m][x.first] = column;
+            }
+
+            double const ncalls = member_result.at("ncalls").empty() ? 0.0 : member_result.at("ncalls")[0];
+            results[m]["ncalls"].assign(results[m]["ncalls"].size(), ncalls);
+        }
+
+        return results;
+    }
+};
+
+#endif
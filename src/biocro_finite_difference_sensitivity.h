@@ -0,0 +1,129 @@
+#ifndef BIOCRO_FINITE_DIFFERENCE_SENSITIVITY_H
+#define BIOCRO_FINITE_DIFFERENCE_SENSITIVITY_H
+
+#include <vector>
+#include <string>
+#include <cmath>      // for std::abs
+#include <memory>     // for std::shared_ptr
+#include <stdexcept>  // for std::out_of_range
+#include "state_map.h"
+#include "dynamical_system.h"
+#include "ode_solver_library/finite_difference_sensitivity_solver.h"
+
+// Class that represents a BioCro simulation augmented with finite-difference
+// sensitivities of its outputs with respect to some of its parameters or
+// initial values
+class biocro_finite_difference_sensitivity
+{
+   public:
+    biocro_finite_difference_sensitivity(
+        // parameters passed to each dynamical_system constructor
+        state_map const& initial_values,
+        state_map const& parameters,
+        state_vector_map const& drivers,
+        string_vector const& direct_module_names,
+        string_vector const& differential_module_names,
+        // the quantities whose sensitivities should be calculated
+        string_vector const& sensitivity_names,
+        // the relative size of the perturbation used for each finite
+        // difference
+        double relative_step)
+        : base_system{new dynamical_system(initial_values, parameters, drivers,
+                                           direct_module_names,
+                                           differential_module_names)},
+          solver{get_perturbations(initial_values, parameters,
+                                   sensitivity_names, relative_step)}
+    {
+        string_vector const differential_names =
+            base_system->get_differential_quantity_names();
+
+        std::vector<double> const h =
+            get_perturbations(initial_values, parameters, sensitivity_names, relative_step);
+
+        for (size_t j = 0; j < sensitivity_names.size(); ++j) {
+            std::string const& name = sensitivity_names[j];
+            std::vector<double> s(differential_names.size(), 0.0);
+            state_map perturbed_parameters = parameters;
+
+            if (initial_values.count(name) > 0) {
+                // The initial state of the perturbed system is perturbed through
+                // its initial sensitivity
+                for (size_t k = 0; k < differential_names.size(); ++k) {
+                    if (differential_names[k] == name) {
+                        s[k] = 1.0;
+                    }
+                }
+            } else {
+                perturbed_parameters[name] += h[j];
+            }
+
+            perturbed_systems.push_back(std::shared_ptr<dynamical_system>(
+                new dynamical_system(initial_values, perturbed_parameters,
+                                     drivers, direct_module_names,
+                                     differential_module_names)));
+
+            initial_sensitivities.push_back(s);
+        }
+    }
+
+    state_vector_map run_simulation(std::vector<state_vector_map>& sensitivities)
+    {
+        return solver.integrate(base_system, perturbed_systems,
+                                initial_sensitivities, sensitivities);
+    }
+
+    std::string generate_report() const
+    {
+        return "\nSystem startup information:\n" +
+               base_system->generate_startup_report() +
+               "\n\nThe finite difference sensitivity solver reports the following:\n" +
+               solver.generate_integrate_report() +
+               "\n";
+    }
+
+   private:
+    std::shared_ptr<dynamical_system> base_system;
+    std::vector<std::shared_ptr<dynamical_system>> perturbed_systems;
+    std::vector<std::vector<double>> initial_sensitivities;
+    finite_difference_sensitivity_solver solver;
+
+    static std::vector<double> get_perturbations(
+        state_map const& initial_values,
+        state_map const& parameters,
+        string_vector const& sensitivity_names,
+        double relative_step)
+    {
+        if (!(relative_step > 0)) {
+            throw std::out_of_range(
+                std::string("The relative step used to calculate ") +
+                std::string("sensitivities must be positive.\n"));
+        }
+
+        std::vector<double> h;
+        for (std::string const& name : sensitivity_names) {
+            double value;
+            if (initial_values.count(name) > 0) {
+                value = initial_values.at(name);
+            } else if (parameters.count(name) > 0) {
+                if (name == "timestep") {
+                    throw std::out_of_range(
+                        std::string("Sensitivities with respect to the ") +
+                        std::string("timestep cannot be calculated.\n"));
+                }
+                value = parameters.at(name);
+            } else {
+                throw std::out_of_range(
+                    std::string("\"") + name + std::string("\" was given ") +
+                    std::string("as a sensitivity name, but it is not one of ") +
+                    std::string("the initial values or parameters.\n"));
+            }
+
+            // Scale the perturbation with the magnitude of the quantity,
+            // falling back to an absolute step for quantities that are zero
+            h.push_back(value == 0.0 ? relative_step : relative_step * std::abs(value));
+        }
+        return h;
+    }
+};
+
+#endif
@@ -0,0 +1,233 @@
+#include <cmath>      // for std::isfinite
+#include <limits>     // for std::numeric_limits
+#include <algorithm>  // for std::min, std::copy
+#include <memory>     // for std::unique_ptr
+#include <stdexcept>  // for std::out_of_range
+#include "biocro_global_sensitivity.h"
+#include "biocro_simulation.h"
+#include "utils/sampling_designs.h"
+#include "utils/thread_pool.h"
+
+namespace
+{
+double const failed = std::numeric_limits<double>::quiet_NaN();
+
+// The number of base points in each batch, per thread
+size_t const batch_points_per_thread = 64;
+}  // namespace
+
+biocro_global_sensitivity::biocro_global_sensitivity(
+    state_map const& initial_values,
+    state_map const& parameters,
+    state_vector_map const& drivers,
+    string_vector const& direct_module_names,
+    string_vector const& differential_module_names,
+    std::vector<parameter_range> const& ranges,
+    std::vector<output_reduction> const& outputs,
+    std::string const& design,
+    size_t nsamples,
+    unsigned seed,
+    std::string const& ode_solver_name,
+    double output_step_size,
+    double adaptive_rel_error_tol,
+    double adaptive_abs_error_tol,
+    int adaptive_max_steps)
+    : initial_values{initial_values},
+      parameters{parameters},
+      drivers{drivers},
+      direct_module_names{direct_module_names},
+      differential_module_names{differential_module_names},
+      ranges{ranges},
+      outputs{outputs},
+      design{design},
+      nsamples{nsamples},
+      seed{seed},
+      ode_solver_name{ode_solver_name},
+      output_step_size{output_step_size},
+      adaptive_rel_error_tol{adaptive_rel_error_tol},
+      adaptive_abs_error_tol{adaptive_abs_error_tol},
+      adaptive_max_steps{adaptive_max_steps},
+      accumulator{ranges.size(), outputs.size()}
+{
+    if (ranges.empty() || outputs.empty()) {
+        throw std::out_of_range(
+            std::string("A global sensitivity analysis requires at least one ") +
+            std::string("parameter range and at least one output.\n"));
+    }
+
+    if (design != "sobol" && design != "latin_hypercube") {
+        throw std::out_of_range(
+            std::string("\"") + design + std::string("\" was given as the ") +
+            std::string("sampling design, but it must be one of `sobol` or ") +
+            std::string("`latin_hypercube`.\n"));
+    }
+
+    if (nsamples < 2) {
+        throw std::out_of_range(
+            std::string("A global sensitivity analysis requires at least two ") +
+            std::string("samples.\n"));
+    }
+
+    for (parameter_range const& range : ranges) {
+        if (initial_values.count(range.name) > 0) {
+            is_initial_value.push_back(true);
+        } else if (parameters.count(range.name) > 0) {
+            is_initial_value.push_back(false);
+        } else {
+            throw std::out_of_range(
+                std::string("\"") + range.name + std::string("\" was given a ") +
+                std::string("range of values, but it is not one of the initial ") +
+                std::string("values or parameters.\n"));
+        }
+
+        if (!std::isfinite(range.lower) || !std::isfinite(range.upper) ||
+            !(range.lower < range.upper)) {
+            throw std::out_of_range(
+                std::string("The range of \"") + range.name + std::string("\" ") +
+                std::string("must have finite bounds with the lower bound less ") +
+                std::string("than the upper bound.\n"));
+        }
+    }
+
+    // Each output is reduced over the whole simulation
+    for (output_reduction& output : this->outputs) {
+        output.window = std::numeric_limits<double>::infinity();
+    }
+
+    // Run one simulation with the default values, so that any problems with
+    // the inputs, modules, outputs, or ode_solver are reported here rather
+    // than causing every sample to be skipped
+    output_aggregator aggregator(this->outputs);
+    biocro_simulation gro(initial_values, parameters, drivers,
+                          direct_module_names, differential_module_names,
+                          ode_solver_name, output_step_size,
+                          adaptive_rel_error_tol, adaptive_abs_error_tol,
+                          adaptive_max_steps);
+    gro.run_simulation(aggregator);
+}
+
+void biocro_global_sensitivity::run(size_t nthreads)
+{
+    if (nthreads < 1) {
+        throw std::out_of_range(
+            std::string("At least one thread must be used.\n"));
+    }
+    nthreads_used = nthreads;
+
+    size_t const nparams = ranges.size();
+    size_t const noutputs = outputs.size();
+    size_t const npoints = nparams + 2;  // A, B, and each AB_i
+
+    // Each base point has `nparams` coordinates for A followed by `nparams`
+    // coordinates for B
+    std::unique_ptr<sobol_sequence> sequence;
+    std::vector<std::vector<double>> hypercube;
+    if (design == "sobol") {
+        sequence.reset(new sobol_sequence(2 * nparams));
+    } else {
+        hypercube = latin_hypercube(nsamples, 2 * nparams, seed);
+    }
+
+    thread_pool pool(nthreads);
+    size_t const batch_size = batch_points_per_thread * nthreads;
+
+    for (size_t first = 0; first < nsamples; first += batch_size) {
+        size_t const nbase = std::min(batch_size, nsamples - first);
+
+        std::vector<std::vector<double>> base(nbase);
+        for (size_t b = 0; b < nbase; ++b) {
+            base[b] = sequence ? sequence->next() : hypercube[first + b];
+        }
+
+        std::vector<std::vector<double>> values(
+            nbase, std::vector<double>(npoints * noutputs));
+
+        pool.run(nbase * npoints, [&](size_t task, size_t /*worker*/) {
+            size_t const b = task / npoints;
+            size_t const p = task % npoints;
+
+            std::vector<double> const& a_and_b = base[b];
+            std::vector<double> point;
+            if (p == 1) {
+                point.assign(a_and_b.begin() + nparams, a_and_b.end());
+            } else {
+                point.assign(a_and_b.begin(), a_and_b.begin() + nparams);
+                if (p > 1) {
+                    point[p - 2] = a_and_b[nparams + p - 2];
+                }
+            }
+
+            std::vector<double> const result = simulate(point);
+            std::copy(result.begin(), result.end(), values[b].begin() + p * noutputs);
+        });
+
+        for (std::vector<double> const& sample : values) {
+            bool all_finite = true;
+            for (double v : sample) {
+                all_finite = all_finite && std::isfinite(v);
+            }
+
+            if (all_finite) {
+                accumulator.add(sample);
+            } else {
+                ++nskipped;
+            }
+        }
+    }
+}
+
+/**
+ *  @brief Runs one simulation at a point in the unit hypercube, returning the
+ *  value of each output, or NaN values if the simulation fails.
+ *
+ *  This function can be called from several threads at once.
+ */
+std::vector<double> biocro_global_sensitivity::simulate(std::vector<double> const& unit_point) const
+{
+    state_map iv = initial_values;
+    state_map p = parameters;
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        double const value = ranges[i].lower + unit_point[i] * (ranges[i].upper - ranges[i].lower);
+        (is_initial_value[i] ? iv : p)[ranges[i].name] = value;
+    }
+
+    std::vector<double> result(outputs.size(), failed);
+
+    try {
+        output_aggregator aggregator(outputs);
+        biocro_simulation gro(iv, p, drivers, direct_module_names,
+                              differential_module_names, ode_solver_name,
+                              output_step_size, adaptive_rel_error_tol,
+                              adaptive_abs_error_tol, adaptive_max_steps);
+
+        std::vector<state_vector_map> const tables = gro.run_simulation(aggregator);
+
+        for (size_t k = 0; k < outputs.size(); ++k) {
+            std::vector<double> const& column = tables[k].at(outputs[k].quantity);
+            if (!column.empty()) {
+                result[k] = column.back();
+            }
+        }
+    } catch (...) {
+        // The sample is skipped
+    }
+
+    return result;
+}
+
+std::string biocro_global_sensitivity::generate_report() const
+{
+    size_t const nparams = ranges.size();
+    return std::string("Global sensitivity analysis using the ") + design +
+           std::string(" design with ") + std::to_string(nparams) +
+           std::string(" parameters and ") + std::to_string(outputs.size()) +
+           std::string(" outputs:\n") +
+           std::to_string(nsamples) + std::string(" base samples required ") +
+           std::to_string(nsamples * (nparams + 2)) +
+           std::string(" simulations on ") + std::to_string(nthreads_used) +
+           std::string(" threads\n") +
+           std::to_string(nskipped) +
+           std::string(" base samples were skipped because a simulation failed ") +
+           std::string("or produced a non-finite output\n");
+}
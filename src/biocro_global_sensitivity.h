@@ -0,0 +1,115 @@
+#ifndef BIOCRO_GLOBAL_SENSITIVITY_H
+#define BIOCRO_GLOBAL_SENSITIVITY_H
+
+#include <vector>
+#include <string>
+#include "state_map.h"
+#include "output_aggregator.h"  // for output_reduction
+#include "utils/sobol_indices.h"
+
+/**
+ *  @brief Describes the range of values of one parameter or initial value in
+ *  a global sensitivity analysis; values are sampled uniformly between
+ *  `lower` and `upper`.
+ */
+struct parameter_range {
+    std::string name;
+    double lower;
+    double upper;
+};
+
+/**
+ *  @class biocro_global_sensitivity
+ *
+ *  @brief Estimates the first-order and total Sobol indices of some scalar
+ *  summaries of a BioCro simulation with respect to the values of some of its
+ *  parameters or initial values.
+ *
+ *  The samples follow the scheme of Saltelli et al. (2010): each of
+ *  `nsamples` base points supplies two independent points A and B in the
+ *  parameter space, and the model is evaluated at A, at B, and at each point
+ *  AB_i that equals A except for parameter i, which is taken from B. That is
+ *  `nsamples * (nparams + 2)` simulations in all. The base points come from
+ *  one of two designs:
+ *
+ *  - `sobol`: the first `nsamples` points of a Sobol sequence with
+ *    `2 * nparams` dimensions; powers of two give the most uniform coverage
+ *
+ *  - `latin_hypercube`: a Latin hypercube sample with `2 * nparams`
+ *    dimensions, generated from `seed`
+ *
+ *  Each scalar output is an `output_reduction` of one quantity over the whole
+ *  simulation, so only the reduced values are kept while a simulation runs.
+ *  The simulations are independent, so they are divided among `nthreads`
+ *  threads. They are run in batches of base points, and the outputs of each
+ *  batch are added to a `sobol_index_accumulator` in order, so the results do
+ *  not depend on the number of threads. A base point is skipped if any of its
+ *  simulations throws an exception or produces a non-finite output.
+ */
+class biocro_global_sensitivity
+{
+   public:
+    biocro_global_sensitivity(
+        // parameters passed to each dynamical_system constructor
+        state_map const& initial_values,
+        state_map const& parameters,
+        state_vector_map const& drivers,
+        string_vector const& direct_module_names,
+        string_vector const& differential_module_names,
+        // the sampled values and the scalar outputs
+        std::vector<parameter_range> const& ranges,
+        std::vector<output_reduction> const& outputs,
+        // settings for the sampling design
+        std::string const& design,
+        size_t nsamples,
+        unsigned seed,
+        // parameters passed to ode_solver_factory::create
+        std::string const& ode_solver_name,
+        double output_step_size,
+        double adaptive_rel_error_tol,
+        double adaptive_abs_error_tol,
+        int adaptive_max_steps);
+
+    void run(size_t nthreads);
+
+    // See `sobol_index_accumulator` for the layout of these values
+    std::vector<double> get_first_order_indices() const { return accumulator.get_first_order_indices(); }
+    std::vector<double> get_total_indices() const { return accumulator.get_total_indices(); }
+    std::vector<double> get_output_means() const { return accumulator.get_means(); }
+    std::vector<double> get_output_variances() const { return accumulator.get_variances(); }
+
+    size_t get_nsamples() const { return accumulator.get_nsamples(); }
+    size_t get_nskipped() const { return nskipped; }
+
+    std::string generate_report() const;
+
+   private:
+    state_map const initial_values;
+    state_map const parameters;
+    state_vector_map const drivers;
+    string_vector const direct_module_names;
+    string_vector const differential_module_names;
+
+    std::vector<parameter_range> const ranges;
+    std::vector<output_reduction> outputs;
+    std::string const design;
+    size_t const nsamples;
+    unsigned const seed;
+
+    std::string const ode_solver_name;
+    double const output_step_size;
+    double const adaptive_rel_error_tol;
+    double const adaptive_abs_error_tol;
+    int const adaptive_max_steps;
+
+    // Whether each sampled quantity is an initial value
+    std::vector<bool> is_initial_value;
+
+    sobol_index_accumulator accumulator;
+    size_t nskipped = 0;
+    size_t nthreads_used = 0;
+
+    std::vector<double> simulate(std::vector<double> const& unit_point) const;
+};
+
+#endif
@@ -5,6 +5,11 @@
 #include "state_map.h"
 #include "dynamical_system.h"
 #include "ode_solver.h"
+#include "output_aggregator.h"
+#include "output_observer.h"
+#include "lazy_simulation_result.h"
+#include "stopping_criteria.h"
+#include "solver_diagnostics.h"
 #include "ode_solver_library/ode_solver_factory.h"
 
 // Class that represents a BioCro simulation
@@ -23,7 +28,11 @@ class biocro_simulation
         double output_step_size,
         double adaptive_rel_error_tol,
         double adaptive_abs_error_tol,
-        int adaptive_max_steps)
+        int adaptive_max_steps,
+        // conditions that end the simulation early
+        std::vector<stopping_condition> const& stopping_conditions = {})
+        : stopping{stopping_conditions},
+          has_stopping_conditions{!stopping_conditions.empty()}
     {
         // Create the system
         sys = std::shared_ptr<dynamical_system>(
@@ -35,12 +44,59 @@ class biocro_simulation
         // Create the ode_solver that will be used to solve the system
         system_solver = ode_solver_factory::create(
             ode_solver_name, output_step_size, adaptive_rel_error_tol,
-            adaptive_abs_error_tol, adaptive_max_steps
+            adaptive_abs_error_tol, adaptive_max_steps,
+            sys->get_differential_quantity_names().size()
         );
     }
 
+    // Sets the number of threads used by implicit ode_solvers to estimate
+    // each Jacobian matrix
+    void set_jacobian_threads(int nthreads) {
+        system_solver->set_jacobian_threads(nthreads);
+    }
+
+    // Specifies the differential modules whose quantities are substepped by
+    // multirate ode_solvers
+    void set_fast_modules(string_vector const& fast_module_names) {
+        sys->set_fast_modules(fast_module_names);
+    }
+
+    // Specifies the direct modules that reuse their outputs when their inputs
+    // repeat
+    void set_cached_modules(string_vector const& cached_module_names) {
+        sys->set_cached_modules(cached_module_names);
+    }
+
     std::unordered_map<std::string, std::vector<double>> run_simulation() {
-        return system_solver->integrate(sys);
+        return system_solver->integrate(sys, nullptr, get_stopping_criteria());
+    }
+
+    // Runs the simulation while recording the ODE solver's steps in
+    // `diagnostics`
+    std::unordered_map<std::string, std::vector<double>> run_simulation(solver_diagnostics& diagnostics) {
+        return system_solver->integrate(sys, nullptr, get_stopping_criteria(), &diagnostics);
+    }
+
+    // Runs the simulation while reducing its outputs with `aggregator`, and
+    // returns the aggregator's tables rather than the full output
+    std::vector<state_vector_map> run_simulation(output_aggregator& aggregator) {
+        system_solver->integrate(sys, &aggregator, get_stopping_criteria());
+        return aggregator.get_results();
+    }
+
+    // Runs the simulation while passing each output time point to `observer`
+    // rather than storing it
+    void run_simulation(output_observer& observer) {
+        system_solver->integrate(sys, &observer, get_stopping_criteria());
+    }
+
+    // Runs the simulation while storing only the differential quantities at
+    // each output time point; the other outputs are calculated when they are
+    // requested from the result
+    std::shared_ptr<lazy_simulation_result> run_simulation_lazily(solver_diagnostics* diagnostics = nullptr) {
+        std::shared_ptr<lazy_simulation_result> result(new lazy_simulation_result(sys));
+        system_solver->integrate(sys, result.get(), get_stopping_criteria(), diagnostics);
+        return result;
     }
 
     std::string generate_report() const
@@ -55,12 +111,22 @@ class biocro_simulation
                   "\nThe dynamical system reports the following:\n" +
                       sys->generate_usage_report() +
                   "\n\n";
+        if (has_stopping_conditions) {
+            report += stopping.generate_report() + "\n";
+        }
         return report;
     }
 
    private:
     std::shared_ptr<dynamical_system> sys;
     std::unique_ptr<ode_solver> system_solver;
+    stopping_criteria stopping;
+    bool const has_stopping_conditions;
+
+    stopping_criteria* get_stopping_criteria()
+    {
+        return has_stopping_conditions ? &stopping : nullptr;
+    }
 };
 
 #endif
@@ -0,0 +1,174 @@
+#include <cmath>      // for std::abs, std::isfinite, std::log, std::sqrt
+#include <limits>     // for std::numeric_limits
+#include <algorithm>  // for std::find, std::stable_sort
+#include <numeric>    // for std::iota
+#include <stdexcept>  // for std::out_of_range
+#include "calibration_objective.h"
+
+namespace
+{
+double const not_matched = std::numeric_limits<double>::quiet_NaN();
+}
+
+calibration_objective::calibration_objective(
+    std::vector<observation> const& observations,
+    std::string const& loss_name)
+    : observations{observations},
+      order(observations.size()),
+      quantity_indices(observations.size()),
+      predictions(observations.size(), not_matched)
+{
+    if (loss_name == "squared") {
+        loss = loss_type::squared;
+    } else if (loss_name == "absolute") {
+        loss = loss_type::absolute;
+    } else if (loss_name == "gaussian") {
+        loss = loss_type::gaussian;
+    } else {
+        throw std::out_of_range(
+            std::string("\"") + loss_name + std::string("\" was given as ") +
+            std::string("the loss, but it must be one of `squared`, ") +
+            std::string("`absolute`, or `gaussian`.\n"));
+    }
+
+    for (size_t k = 0; k < observations.size(); ++k) {
+        observation const& obs = observations[k];
+
+        if (!std::isfinite(obs.time) || !std::isfinite(obs.value)) {
+            throw std::out_of_range(
+                std::string("The time and value of observation ") +
+                std::to_string(k + 1) + std::string(" (\"") + obs.quantity +
+                std::string("\") must be finite.\n"));
+        }
+
+        bool const weight_ok = loss == loss_type::gaussian
+                                   ? obs.weight > 0
+                                   : obs.weight >= 0;
+
+        if (!weight_ok || !std::isfinite(obs.weight)) {
+            throw std::out_of_range(
+                std::string("The weight of observation ") +
+                std::to_string(k + 1) + std::string(" (\"") + obs.quantity +
+                std::string("\") must be finite and ") +
+                std::string(loss == loss_type::gaussian ? "positive" : "non-negative") +
+                std::string(".\n"));
+        }
+
+        auto it = std::find(quantity_names.begin(), quantity_names.end(), obs.quantity);
+        quantity_indices[k] = it - quantity_names.begin();
+        if (it == quantity_names.end()) {
+            quantity_names.push_back(obs.quantity);
+        }
+    }
+
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&observations](size_t a, size_t b) {
+        return observations[a].time < observations[b].time;
+    });
+}
+
+/**
+ *  @brief Gets pointers to the `time` quantity and to each observed quantity in
+ *  the system's internally stored quantity map, and clears any predictions
+ *  from a previous simulation.
+ */
+void calibration_objective::attach(dynamical_system const& sys)
+{
+    string_vector const output_names = sys.get_output_quantity_names();
+
+    if (std::find(output_names.begin(), output_names.end(), "time") == output_names.end()) {
+        throw std::out_of_range(
+            std::string("A calibration objective requires a `time` driver.\n"));
+    }
+
+    for (std::string const& name : quantity_names) {
+        if (std::find(output_names.begin(), output_names.end(), name) == output_names.end()) {
+            throw std::out_of_range(
+                std::string("\"") + name + std::string("\" was given as an ") +
+                std::string("observed quantity, but it is not an output of ") +
+                std::string("the system.\n"));
+        }
+    }
+
+    time_ptr = sys.get_quantity_access_ptrs({"time"})[0];
+    quantity_ptrs = sys.get_quantity_access_ptrs(quantity_names);
+
+    next = 0;
+    has_previous = false;
+    previous_values.assign(quantity_names.size(), 0.0);
+    predictions.assign(observations.size(), not_matched);
+}
+
+void calibration_objective::record()
+{
+    double const time = *time_ptr;
+
+    // Match every observation up to the current time
+    while (next < order.size() && observations[order[next]].time <= time) {
+        size_t const k = order[next];
+        size_t const q = quantity_indices[k];
+        double const obs_time = observations[k].time;
+
+        if (obs_time == time) {
+            predictions[k] = *quantity_ptrs[q];
+        } else if (has_previous && obs_time > previous_time) {
+            double const f = (obs_time - previous_time) / (time - previous_time);
+            predictions[k] = previous_values[q] + f * (*quantity_ptrs[q] - previous_values[q]);
+        }
+
+        ++next;
+    }
+
+    has_previous = true;
+    previous_time = time;
+    for (size_t q = 0; q < quantity_ptrs.size(); ++q) {
+        previous_values[q] = *quantity_ptrs[q];
+    }
+}
+
+std::vector<double> calibration_objective::get_residuals() const
+{
+    std::vector<double> residuals(observations.size());
+    for (size_t k = 0; k < observations.size(); ++k) {
+        residuals[k] = predictions[k] - observations[k].value;
+    }
+    return residuals;
+}
+
+std::vector<double> calibration_objective::get_weighted_residuals() const
+{
+    std::vector<double> residuals = get_residuals();
+    for (size_t k = 0; k < observations.size(); ++k) {
+        residuals[k] *= std::sqrt(observations[k].weight);
+    }
+    return residuals;
+}
+
+double calibration_objective::get_objective() const
+{
+    double constexpr log_two_pi = 1.8378770664093453;
+
+    double objective = 0.0;
+    for (size_t k = 0; k < observations.size(); ++k) {
+        double const r = predictions[k] - observations[k].value;
+        double const w = observations[k].weight;
+
+        if (!std::isfinite(r)) {
+            return std::numeric_limits<double>::infinity();
+        }
+
+        switch (loss) {
+            case loss_type::squared:
+                objective += w * r * r;
+                break;
+            case loss_type::absolute:
+                objective += w * std::abs(r);
+                break;
+            case loss_type::gaussian:
+                objective += 0.5 * (w * r * r - std::log(w) + log_two_pi);
+                break;
+        }
+    }
+
+    return objective;
+}
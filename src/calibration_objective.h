@@ -0,0 +1,103 @@
+#ifndef CALIBRATION_OBJECTIVE_H
+#define CALIBRATION_OBJECTIVE_H
+
+#include <vector>
+#include <string>
+#include "state_map.h"  // for string_vector
+#include "dynamical_system.h"
+#include "output_observer.h"
+
+/**
+ *  @brief Describes one observed value of an output quantity.
+ *
+ *  `time` is expressed in the same units as the `time` driver, and `weight`
+ *  sets the contribution of this observation to the objective; see
+ *  `calibration_objective`.
+ */
+struct observation {
+    double time;
+    std::string quantity;
+    double value;
+    double weight;
+};
+
+/**
+ *  @class calibration_objective
+ *
+ *  @brief Compares the outputs of a simulation to a set of observations while
+ *  the simulation runs, so that a calibration loop does not need to store or
+ *  return the full simulation output.
+ *
+ *  Each observation is matched to the simulated value of its quantity at its
+ *  time. When an observation falls between two output time points, the
+ *  simulated value is interpolated linearly between them. Only the values of
+ *  the observed quantities at the most recent output time point are kept.
+ *
+ *  The residual of an observation is the simulated value minus the observed
+ *  value, and its weighted residual is the residual multiplied by the square
+ *  root of its weight. The objective is calculated from the residuals
+ *  according to the `loss`, which must be one of the following:
+ *
+ *  - `squared`: the weighted sum of squared residuals
+ *
+ *  - `absolute`: the weighted sum of absolute residuals
+ *
+ *  - `gaussian`: the negative log-likelihood of the observations, assuming
+ *    they have independent normal errors whose variances are the reciprocals
+ *    of their weights
+ *
+ *  An observation whose time is not reached by the simulation, for example
+ *  because the simulation ended early, cannot be matched; its residual is NaN
+ *  and the objective is infinite.
+ */
+class calibration_objective : public output_observer
+{
+   public:
+    calibration_objective(
+        std::vector<observation> const& observations,
+        std::string const& loss);
+
+    void attach(dynamical_system const& sys) override;
+
+    void record() override;
+
+    double get_objective() const;
+
+    std::vector<double> get_predictions() const { return predictions; }
+
+    std::vector<double> get_residuals() const;
+
+    std::vector<double> get_weighted_residuals() const;
+
+   private:
+    enum class loss_type { squared,
+                           absolute,
+                           gaussian };
+
+    std::vector<observation> const observations;
+    loss_type loss;
+
+    // The indices of the observations in order of increasing time, and the
+    // position of the next one to be matched
+    std::vector<size_t> order;
+    size_t next = 0;
+
+    // The distinct observed quantities and the index of each observation's
+    // quantity in this list
+    string_vector quantity_names;
+    std::vector<size_t> quantity_indices;
+
+    // Pointers to the system's `time` and observed quantities
+    const double* time_ptr = nullptr;
+    std::vector<const double*> quantity_ptrs;
+
+    // Values at the previous output time point
+    bool has_previous = false;
+    double previous_time = 0.0;
+    std::vector<double> previous_values;
+
+    // The simulated value for each observation, in the original order
+    std::vector<double> predictions;
+};
+
+#endif
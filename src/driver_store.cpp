@@ -0,0 +1,144 @@
+#include <cstdint>    // for uint64_t
+#include <cstring>    // for std::memcmp, std::memcpy
+#include <algorithm>  // for std::find
+#include <deque>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>  // for boost::hash_combine
+#include "driver_store.h"
+
+namespace
+{
+// The live stores, indexed by their hashes
+std::mutex registry_mutex;
+std::unordered_multimap<size_t, std::weak_ptr<driver_store const>> registry;
+
+// The most recently attached stores, from newest to oldest
+std::deque<std::shared_ptr<driver_store const>> recent_stores;
+
+// Hashes the names and values of the drivers; values are hashed by their bit
+// patterns so that tables compare equal if and only if their hashes were
+// calculated from the same bits
+size_t hash_drivers(state_vector_map const& drivers)
+{
+    size_t seed = 0;
+    for (std::string const& name : keys(drivers)) {
+        boost::hash_combine(seed, name);
+        for (double const& value : drivers.at(name)) {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            boost::hash_combine(seed, bits);
+        }
+    }
+    return seed;
+}
+
+bool have_same_contents(state_vector_map const& a, state_vector_map const& b)
+{
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (auto const& x : a) {
+        auto const other = b.find(x.first);
+        if (other == b.end() || other->second.size() != x.second.size()) {
+            return false;
+        }
+        if (!x.second.empty() &&
+            std::memcmp(x.second.data(), other->second.data(), x.second.size() * sizeof(double)) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+}  // namespace
+
+/**
+ *  @brief Returns a store whose contents are identical to `drivers`, making a
+ *  new one only if no such store is alive
+ *
+ *  The store becomes the newest of the recently attached stores, and the
+ *  oldest one is dropped from that list if it has grown too long.
+ */
+std::shared_ptr<driver_store const> driver_store::attach(state_vector_map const& drivers)
+{
+    size_t const hash = hash_drivers(drivers);
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    std::shared_ptr<driver_store const> store;
+    auto const candidates = registry.equal_range(hash);
+    for (auto it = candidates.first; it != candidates.second;) {
+        std::shared_ptr<driver_store const> candidate = it->second.lock();
+        if (!candidate) {
+            // Forget stores that are no longer used
+            it = registry.erase(it);
+            continue;
+        }
+        if (!store && have_same_contents(candidate->columns, drivers)) {
+            store = candidate;
+        }
+        ++it;
+    }
+
+    if (!store) {
+        store = std::shared_ptr<driver_store const>(new driver_store(drivers, hash));
+        registry.emplace(hash, store);
+    }
+
+    auto const previous = std::find(recent_stores.begin(), recent_stores.end(), store);
+    if (previous != recent_stores.end()) {
+        recent_stores.erase(previous);
+    }
+    recent_stores.push_front(store);
+    if (recent_stores.size() > max_recent_stores) {
+        recent_stores.pop_back();
+    }
+
+    return store;
+}
+
+/**
+ *  @brief Returns the derived columns identified by `key`, calling `calculate`
+ *  to make them if they haven't been made before
+ *
+ *  Other threads that ask for derived columns from the same store wait while
+ *  `calculate` runs, so the columns are only calculated once. When the store
+ *  already holds `max_derived_columns` sets, the oldest one is forgotten.
+ */
+std::shared_ptr<state_vector_map const> driver_store::get_derived_columns(
+    std::string const& key,
+    std::function<state_vector_map()> const& calculate) const
+{
+    std::lock_guard<std::mutex> lock(derived_mutex);
+
+    auto const existing = derived_columns.find(key);
+    if (existing != derived_columns.end()) {
+        return existing->second;
+    }
+
+    auto const columns = std::make_shared<state_vector_map const>(calculate());
+
+    if (derived_keys.size() >= max_derived_columns) {
+        derived_columns.erase(derived_keys.front());
+        derived_keys.pop_front();
+    }
+
+    derived_columns[key] = columns;
+    derived_keys.push_back(key);
+    return columns;
+}
+
+/**
+ *  @brief Returns the number of stores that are alive
+ */
+size_t driver_store::get_nstores()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+
+    size_t n = 0;
+    for (auto const& x : registry) {
+        if (!x.second.expired()) {
+            ++n;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,77 @@
+#ifndef DRIVER_STORE_H
+#define DRIVER_STORE_H
+
+#include <cstddef>     // for size_t
+#include <deque>
+#include <functional>  // for std::function
+#include <map>
+#include <memory>      // for std::shared_ptr
+#include <mutex>
+#include <string>
+#include "state_map.h"  // for state_vector_map
+
+/**
+ *  @class driver_store
+ *
+ *  @brief An immutable table of driver values that can be shared by all the
+ *  simulations in a process that use the same drivers.
+ *
+ *  Stores are only obtained through `attach`, which looks for a live store
+ *  whose contents are identical to the supplied drivers. Candidates are found
+ *  using a hash of the driver names and values, and a match is confirmed by
+ *  comparing the full tables, so two different tables are never confused. If
+ *  no store matches, a new one is made. In this way, an ensemble whose members
+ *  use the same weather data keeps a single copy of it, no matter how many
+ *  members there are.
+ *
+ *  Each store is kept alive by the simulations that have attached to it and,
+ *  so that separate simulations run one after another can share a store, by
+ *  a list of the `max_recent_stores` most recently attached stores. A store
+ *  is released once the last simulation using it has been destroyed and it
+ *  has dropped off that list.
+ *
+ *  A store can also hold columns that are derived from its drivers, such as
+ *  the outputs of modules whose inputs are all drivers or parameters. Derived
+ *  columns are identified by a key that should describe how they were
+ *  calculated; they are calculated by the first simulation that asks for them
+ *  and then shared with any others that use the same key. At most
+ *  `max_derived_columns` sets are kept. When another is made, the oldest one
+ *  is forgotten, although simulations that already use it keep their copy.
+ */
+class driver_store
+{
+   public:
+    static std::shared_ptr<driver_store const> attach(state_vector_map const& drivers);
+
+    driver_store(driver_store const&) = delete;
+    driver_store& operator=(driver_store const&) = delete;
+
+    state_vector_map const& get_columns() const { return columns; }
+
+    size_t get_hash() const { return hash; }
+
+    std::shared_ptr<state_vector_map const> get_derived_columns(
+        std::string const& key,
+        std::function<state_vector_map()> const& calculate) const;
+
+    static size_t get_nstores();
+
+    // The number of sets of derived columns kept by each store
+    static constexpr size_t max_derived_columns = 16;
+
+    // The number of recently attached stores that are kept alive
+    static constexpr size_t max_recent_stores = 4;
+
+   private:
+    driver_store(state_vector_map const& drivers, size_t hash)
+        : columns{drivers}, hash{hash} {}
+
+    state_vector_map const columns;
+    size_t const hash;
+
+    mutable std::mutex derived_mutex;
+    mutable std::map<std::string, std::shared_ptr<state_vector_map const>> derived_columns;
+    mutable std::deque<std::string> derived_keys;  // the keys, from oldest to newest
+};
+
+#endif
@@ -1,6 +1,9 @@
 #include "dynamical_system.h"
 #include "validate_dynamical_system.h"
-#include "utils/module_dependency_utilities.h"  // for get_evaluation_order
+#include <algorithm>  // for std::find, std::all_of
+#include <set>
+#include <cstdio>     // for std::snprintf
+#include "utils/module_dependency_utilities.h"  // for get_evaluation_order, get_upstream_modules
 
 dynamical_system::dynamical_system(
     state_map const& init_values,
@@ -8,30 +11,15 @@ dynamical_system::dynamical_system(
     state_vector_map const& drivers,
     string_vector const& dir_module_names,
     string_vector const& differential_module_names)
-    : initial_values{init_values},
+    : startup_message{validate_inputs(
+          init_values, params, drivers, dir_module_names, differential_module_names)},
+      initial_values{init_values},
       parameters{params},
-      drivers{drivers},
+      driver_table{driver_store::attach(drivers)},
+      drivers{driver_table->get_columns()},
       direct_module_names{},  // put modules in suitable order before filling
       differential_module_names{differential_module_names}
 {
-    startup_message = string("");
-
-    // Make sure the inputs can form a valid system
-    bool valid = validate_dynamical_system_inputs(
-        startup_message,
-        init_values,
-        params,
-        drivers,
-        dir_module_names,
-        differential_module_names);
-
-    if (!valid) {
-        throw std::logic_error(
-            string("Thrown by dynamical_system::dynamical_system: the ") +
-            string("supplied inputs cannot form a valid dynamical system\n\n") +
-            startup_message);
-    }
-
     try {
         direct_module_names = get_evaluation_order(dir_module_names);
     } catch (boost::exception_detail::clone_impl<boost::exception_detail::error_info_injector<boost::not_a_dag>> const& e) {
@@ -50,6 +38,92 @@ dynamical_system::dynamical_system(
     // quantities in the "initial values" input.
     differential_quantity_derivatives = init_values;
 
+    // Make the modules and the pointers that connect them to the quantities
+    initialize_modules_and_pointers(keys(init_values));
+}
+
+/**
+ *  @brief Makes sure the inputs can form a valid system, returning the startup
+ *  message that describes them
+ *
+ *  This is called before the drivers are attached to a `driver_store`, so
+ *  invalid inputs never create or keep alive a store.
+ */
+string dynamical_system::validate_inputs(
+    state_map const& init_values,
+    state_map const& params,
+    state_vector_map const& drivers,
+    string_vector const& dir_module_names,
+    string_vector const& differential_module_names)
+{
+    string message;
+
+    bool valid = validate_dynamical_system_inputs(
+        message,
+        init_values,
+        params,
+        drivers,
+        dir_module_names,
+        differential_module_names);
+
+    if (!valid) {
+        throw std::logic_error(
+            string("Thrown by dynamical_system::dynamical_system: the ") +
+            string("supplied inputs cannot form a valid dynamical system\n\n") +
+            message);
+    }
+
+    return message;
+}
+
+/**
+ *  @brief Makes an independent copy of a dynamical_system
+ *
+ *  The copy has its own quantity maps, which start with the same values as the
+ *  original's, and its own modules, which are bound to the copy's maps. The
+ *  inputs were already validated and the direct modules already ordered when
+ *  the original was constructed, so copying is much cheaper than constructing
+ *  a new system. Because the copy shares no mutable data with the original, the
+ *  two can calculate derivatives at the same time from different threads. The
+ *  drivers and any precalculated module outputs never change, so they are
+ *  shared rather than copied.
+ *
+ *  The differential quantities are kept in the original's order, so state
+ *  vectors can be passed between the two. The copy's counts of derivative
+ *  calculations and Jacobian matrices start at zero.
+ *
+ *  Any information a module keeps between calls is not copied; such modules
+ *  begin from their initial state in the copy. These are the modules that
+ *  require an Euler ode_solver, which never calculates a Jacobian matrix, so
+ *  copies are only made of systems where this makes no difference.
+ */
+dynamical_system::dynamical_system(dynamical_system const& other)
+    : startup_message{other.startup_message},
+      initial_values{other.initial_values},
+      parameters{other.parameters},
+      driver_table{other.driver_table},
+      drivers{driver_table->get_columns()},
+      direct_module_names{other.direct_module_names},
+      differential_module_names{other.differential_module_names},
+      all_quantities{other.all_quantities},
+      differential_quantity_derivatives{other.differential_quantity_derivatives}
+{
+    initialize_modules_and_pointers(other.get_differential_quantity_names());
+    set_fast_modules(other.fast_module_names);
+    set_cached_modules(other.cached_module_names);
+    use_precalculated_columns(other.precalculated_module_names, other.precalculated_columns);
+}
+
+/**
+ *  @brief Instantiates the modules and finds the pointers that are used to
+ *  update the quantity maps; the maps and module names must already be defined
+ *
+ *  @param[in] differential_quantity_names the names of the differential
+ *         quantities, in the order used for state vectors
+ */
+void dynamical_system::initialize_modules_and_pointers(
+    string_vector const& differential_quantity_names)
+{
     // Instantiate the modules. Differential modules should not modify the main
     // quantity map since their output represents derivatives of quantity values
     // rather than actual quantity values, but direct modules should
@@ -64,17 +138,37 @@ dynamical_system::dynamical_system(
         all_quantities,
         &differential_quantity_derivatives);
 
+    // Count the switching functions, which only depends on the modules, and
+    // find the direct modules that must be run to evaluate them
+    string_vector switching_module_names;
+    for (size_t i = 0; i < direct_modules.size(); ++i) {
+        size_t const n = direct_modules[i]->get_switching_functions().size();
+        nswitches += n;
+        if (n > 0) {
+            switching_module_names.push_back(direct_module_names[i]);
+        }
+    }
+    for (size_t i = 0; i < differential_modules.size(); ++i) {
+        size_t const n = differential_modules[i]->get_switching_functions().size();
+        nswitches += n;
+        if (n > 0) {
+            switching_module_names.push_back(differential_module_names[i]);
+        }
+    }
+
+    switching_direct_module_indices = get_upstream_direct_module_indices(
+        string_set_to_string_vector(find_unique_module_inputs({switching_module_names})));
+
     // Make lists of subsets of the quantities that comprise the state:
     // - the direct quantities, i.e., the quantities whose instantaneous values
     //   are calculated by direct modules
-    // - the differential quantities, i.e., the quantities whose derivatives are
-    //   calculated by differential modules
     // - the drivers
+    // The differential quantities, i.e., the quantities whose derivatives are
+    // calculated by differential modules, have already been listed.
     string_vector direct_quantity_names =
         string_set_to_string_vector(
             find_unique_module_outputs({direct_module_names}));
 
-    string_vector differential_quantity_names = keys(init_values);
     string_vector driver_quantity_names = keys(drivers);
 
     // Get vectors of "pointer pairs," i.e., a std::pair of pointers that point
@@ -93,7 +187,7 @@ dynamical_system::dynamical_system(
         drivers);
 
     // Get a pointer to the timestep
-    if (params.find("timestep") == params.end()) {
+    if (parameters.find("timestep") == parameters.end()) {
         throw std::runtime_error(
             string("The quantity 'timestep' was not defined in the ") +
             string("parameters state_map."));
@@ -101,6 +195,459 @@ dynamical_system::dynamical_system(
     timestep_ptr = &(all_quantities.at("timestep"));
 }
 
+/**
+ *  @brief Makes the named direct modules reuse their outputs when their inputs
+ *  repeat
+ *
+ *  Each named module stores its outputs for its most recent distinct sets of
+ *  input values; see `module_output_cache`. This only saves time when a module
+ *  is expensive and its inputs often repeat exactly, for example when an
+ *  adaptive ode_solver rejects many steps or when the outputs of a system are
+ *  recalculated at each stored time point. Otherwise, the lookups only add to
+ *  the cost of the module, so no module uses a cache unless it is named here.
+ *  The number of reused outputs is included in the usage report.
+ *
+ *  A module that keeps state between calls cannot reuse its outputs, since
+ *  they do not depend on its inputs alone. An empty list of names turns off
+ *  the caches of all the modules.
+ *
+ *  @param[in] cached_module_names the names of the direct modules that should
+ *         reuse their outputs
+ */
+void dynamical_system::set_cached_modules(string_vector const& cached_module_names)
+{
+    for (auto const& m : direct_modules) {
+        m->set_output_cache(nullptr);
+    }
+
+    for (string const& name : cached_module_names) {
+        size_t const i = static_cast<size_t>(
+            std::find(direct_module_names.begin(), direct_module_names.end(), name) -
+            direct_module_names.begin());
+
+        if (i == direct_module_names.size()) {
+            throw std::logic_error(
+                string("Thrown by dynamical_system::set_cached_modules: '") +
+                name + string("' is not one of the system's direct modules"));
+        }
+
+        if (direct_modules[i]->keeps_state()) {
+            throw std::logic_error(
+                string("Thrown by dynamical_system::set_cached_modules: the '") +
+                name + string("' module keeps state between calls, so its ") +
+                string("outputs cannot be reused"));
+        }
+
+        direct_modules[i]->set_output_cache(std::unique_ptr<module_output_cache>(
+            new module_output_cache(
+                get_ip(all_quantities, string_set_to_string_vector(find_unique_module_inputs({{name}}))),
+                get_op(&all_quantities, string_set_to_string_vector(find_unique_module_outputs({{name}}))))));
+    }
+
+    this->cached_module_names = cached_module_names;
+}
+
+/**
+ *  @brief Divides the differential quantities into fast and slow partitions
+ *
+ *  The fast quantities are the outputs of the named differential modules, and
+ *  the other differential quantities are slow. The direct modules that must be
+ *  run to calculate the fast derivatives are found from the module dependency
+ *  graph; these are the modules that are run by `calculate_fast_derivative`.
+ *  A multirate ode_solver gains the most when they are much cheaper to run
+ *  than the full list of modules.
+ *
+ *  Since the fast derivatives are calculated without running the other
+ *  differential modules, none of those modules may also calculate a
+ *  derivative of a fast quantity. An empty list of names means that all the
+ *  quantities are slow.
+ *
+ *  @param[in] fast_module_names the names of the differential modules that
+ *         calculate the derivatives of the fast quantities
+ */
+void dynamical_system::set_fast_modules(string_vector const& fast_module_names)
+{
+    auto position = [](string_vector const& names, string const& name) {
+        return static_cast<size_t>(std::find(names.begin(), names.end(), name) - names.begin());
+    };
+
+    auto contains = [&position](string_vector const& names, string const& name) {
+        return position(names, name) < names.size();
+    };
+
+    // Find the fast differential modules
+    vector<size_t> differential_indices;
+    for (string const& name : fast_module_names) {
+        if (!contains(differential_module_names, name)) {
+            throw std::logic_error(
+                string("Thrown by dynamical_system::set_fast_modules: '") +
+                name + string("' is not one of the system's differential modules"));
+        }
+        differential_indices.push_back(position(differential_module_names, name));
+    }
+
+    // Find the fast quantities and make sure no slow module changes them
+    string_vector const fast_quantities =
+        string_set_to_string_vector(find_unique_module_outputs({fast_module_names}));
+
+    for (string const& name : differential_module_names) {
+        if (contains(fast_module_names, name)) {
+            continue;
+        }
+        for (string const& q : string_set_to_string_vector(find_unique_module_outputs({{name}}))) {
+            if (contains(fast_quantities, q)) {
+                throw std::logic_error(
+                    string("Thrown by dynamical_system::set_fast_modules: the ") +
+                    string("slow differential module '") + name +
+                    string("' calculates a derivative of the fast quantity '") +
+                    q + string("', so it must also be listed as a fast module"));
+            }
+        }
+    }
+
+    // Find the direct modules that the fast modules depend on
+    string_vector const fast_direct_names = get_upstream_modules(
+        direct_module_names,
+        string_set_to_string_vector(find_unique_module_inputs({fast_module_names})));
+
+    vector<size_t> direct_indices;
+    for (string const& name : fast_direct_names) {
+        direct_indices.push_back(position(direct_module_names, name));
+    }
+
+    // Find the fast quantities in the state vector and their derivatives
+    vector<size_t> quantity_indices;
+    vector<double*> derivative_ptrs;
+    for (size_t i = 0; i < differential_quantity_ptr_pairs.size(); ++i) {
+        for (string const& q : fast_quantities) {
+            if (differential_quantity_ptr_pairs[i].first == &all_quantities.at(q)) {
+                quantity_indices.push_back(i);
+                derivative_ptrs.push_back(&differential_quantity_derivatives.at(q));
+            }
+        }
+    }
+
+    this->fast_module_names = fast_module_names;
+    fast_direct_module_indices = direct_indices;
+    fast_differential_module_indices = differential_indices;
+    fast_quantity_indices = quantity_indices;
+    fast_derivative_ptrs = derivative_ptrs;
+}
+
+/**
+ *  @brief Returns the positions of the direct modules that must be run to
+ *  calculate a set of quantities, in their evaluation order
+ *
+ *  These are the modules that calculate any of the quantities, along with the
+ *  modules that calculate their inputs, and so on. The list is empty when all
+ *  the quantities are drivers, parameters, or differential quantities.
+ */
+vector<size_t> dynamical_system::get_upstream_direct_module_indices(
+    string_vector const& quantity_names) const
+{
+    string_vector const upstream_names =
+        get_upstream_modules(direct_module_names, quantity_names);
+
+    vector<size_t> indices;
+    for (string const& name : upstream_names) {
+        indices.push_back(
+            std::find(direct_module_names.begin(), direct_module_names.end(), name) -
+            direct_module_names.begin());
+    }
+    return indices;
+}
+
+/**
+ *  @brief Prepares to check whether new values for some parameters would change
+ *  the system's outputs or derivatives
+ *
+ *  The affected direct modules are those with one of the parameters as an
+ *  input, along with the modules that use their outputs, and so on. If none of
+ *  their outputs change, the derivatives can only change through differential
+ *  modules that use one of the parameters directly, so only those differential
+ *  modules need to be checked.
+ *
+ *  @param[in] new_values new values for some of the system's parameters
+ */
+parameter_change_probe dynamical_system::make_parameter_change_probe(
+    state_map const& new_values)
+{
+    parameter_change_probe probe;
+
+    string_set affected;
+    for (auto const& x : new_values) {
+        if (parameters.count(x.first) == 0) {
+            throw std::out_of_range(
+                string("Thrown by dynamical_system::make_parameter_change_probe: '") +
+                x.first + string("' is not one of the system's parameters"));
+        }
+        probe.new_values.push_back({&all_quantities.at(x.first), x.second});
+        affected.insert(x.first);
+    }
+
+    auto uses_affected_quantity = [&affected](string const& module_name) {
+        for (string const& q : find_unique_module_inputs({{module_name}})) {
+            if (affected.count(q) > 0) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // Direct modules are listed in their evaluation order, so a single pass
+    // finds every module that is affected directly or indirectly
+    for (size_t i = 0; i < direct_module_names.size(); ++i) {
+        if (uses_affected_quantity(direct_module_names[i])) {
+            probe.direct_module_indices.push_back(i);
+            for (string const& q : find_unique_module_outputs({{direct_module_names[i]}})) {
+                affected.insert(q);
+                probe.direct_output_ptrs.push_back(&all_quantities.at(q));
+            }
+        }
+    }
+
+    for (size_t i = 0; i < differential_module_names.size(); ++i) {
+        string_set const inputs = find_unique_module_inputs({{differential_module_names[i]}});
+        for (auto const& x : new_values) {
+            if (inputs.count(x.first) > 0) {
+                probe.differential_module_indices.push_back(i);
+                break;
+            }
+        }
+    }
+
+    return probe;
+}
+
+/**
+ *  @brief Determines whether the parameter values described by a probe would
+ *  change any output quantity or derivative at the most recently updated state
+ *  and time
+ *
+ *  The affected modules are run with the new parameter values and their
+ *  results are compared to the current ones. Afterwards the parameters, the
+ *  quantities calculated by the affected modules, and the derivatives are
+ *  returned to their previous values. The outputs are compared exactly, so
+ *  this should not be used with modules that keep information between calls
+ *  (see `has_stateful_modules`): the extra calls would change their state, and
+ *  their outputs could differ even when the parameter change has no effect.
+ *
+ *  @param[in] probe a probe made by this system's `make_parameter_change_probe`
+ *
+ *  @return true if any output quantity or derivative would change
+ */
+bool dynamical_system::parameter_change_affects_outputs(parameter_change_probe const& probe)
+{
+    vector<double> saved_parameters;
+    for (auto const& x : probe.new_values) {
+        saved_parameters.push_back(*x.first);
+    }
+
+    vector<double> saved_outputs;
+    for (double const* p : probe.direct_output_ptrs) {
+        saved_outputs.push_back(*p);
+    }
+
+    vector<double> saved_derivatives;
+    for (auto const& x : differential_quantity_derivatives) {
+        saved_derivatives.push_back(x.second);
+    }
+
+    auto set_parameters = [&probe, &saved_parameters](bool use_new_values) {
+        for (size_t i = 0; i < probe.new_values.size(); ++i) {
+            *probe.new_values[i].first =
+                use_new_values ? probe.new_values[i].second : saved_parameters[i];
+        }
+    };
+
+    // The contributions of the affected differential modules to the
+    // derivatives
+    auto affected_derivatives = [this, &probe]() {
+        for (auto& x : differential_quantity_derivatives) {
+            x.second = 0.0;
+        }
+        for (size_t i : probe.differential_module_indices) {
+            differential_modules[i]->run();
+        }
+        vector<double> derivs;
+        for (auto const& x : differential_quantity_derivatives) {
+            derivs.push_back(x.second);
+        }
+        return derivs;
+    };
+
+    bool changed = false;
+
+    set_parameters(true);
+    for (size_t i : probe.direct_module_indices) {
+        direct_modules[i]->run();
+    }
+    for (size_t k = 0; k < saved_outputs.size() && !changed; ++k) {
+        changed = *probe.direct_output_ptrs[k] != saved_outputs[k];
+    }
+
+    if (!changed && !probe.differential_module_indices.empty()) {
+        vector<double> const new_derivatives = affected_derivatives();
+        set_parameters(false);
+        changed = affected_derivatives() != new_derivatives;
+    }
+
+    // Return the system to its previous state
+    set_parameters(false);
+    for (size_t k = 0; k < saved_outputs.size(); ++k) {
+        *probe.direct_output_ptrs[k] = saved_outputs[k];
+    }
+    size_t i = 0;
+    for (auto& x : differential_quantity_derivatives) {
+        x.second = saved_derivatives[i++];
+    }
+
+    return changed;
+}
+
+/**
+ *  @brief Calculates the outputs of the direct modules that only depend on the
+ *  drivers and parameters at every time point
+ *
+ *  A direct module qualifies if each of its inputs is a driver, a parameter,
+ *  or an output of another qualifying module; solar position calculations are
+ *  a typical example. Their outputs are stored as derived columns of the
+ *  system's `driver_store`, keyed by the module names and the values of the
+ *  parameters they use, so systems that share drivers and those parameters,
+ *  such as the members of an ensemble, only calculate them once.
+ *
+ *  Afterwards, `update_all_quantities` copies the stored outputs instead of
+ *  running the qualifying modules whenever the time is an integer index. At
+ *  other times the drivers are interpolated and the modules are run as usual,
+ *  so the results are the same as without precalculation.
+ */
+void dynamical_system::precalculate_driver_modules()
+{
+    // Find the qualifying modules, in evaluation order, and the parameters
+    // they use
+    std::set<string> known_quantities;
+    for (string const& name : keys(drivers)) {
+        known_quantities.insert(name);
+    }
+
+    string_vector module_names;
+    std::set<string> parameter_names;
+    for (string const& module_name : direct_module_names) {
+        string_vector const inputs =
+            string_set_to_string_vector(find_unique_module_inputs({{module_name}}));
+
+        bool const qualifies = std::all_of(inputs.begin(), inputs.end(), [&](string const& q) {
+            return known_quantities.count(q) > 0 || parameters.count(q) > 0;
+        });
+
+        if (qualifies) {
+            module_names.push_back(module_name);
+            for (string const& q : inputs) {
+                if (parameters.count(q) > 0) {
+                    parameter_names.insert(q);
+                }
+            }
+            for (string const& q : string_set_to_string_vector(find_unique_module_outputs({{module_name}}))) {
+                known_quantities.insert(q);
+            }
+        }
+    }
+
+    if (module_names.empty()) {
+        return;
+    }
+
+    // Identify the calculation by the modules and the parameter values, which
+    // are written in hexadecimal so that they are exact
+    string key;
+    for (string const& name : module_names) {
+        key += name + string(";");
+    }
+    for (string const& name : parameter_names) {
+        char value[32];
+        std::snprintf(value, sizeof(value), "%a", parameters.at(name));
+        key += name + string("=") + string(value) + string(";");
+    }
+
+    auto calculate = [this, &module_names]() {
+        string_vector const output_names =
+            string_set_to_string_vector(find_unique_module_outputs({module_names}));
+
+        vector<size_t> module_indices;
+        for (string const& name : module_names) {
+            module_indices.push_back(
+                std::find(direct_module_names.begin(), direct_module_names.end(), name) -
+                direct_module_names.begin());
+        }
+
+        size_t const ntimes = get_ntimes();
+        state_vector_map columns;
+        for (string const& name : output_names) {
+            columns[name].resize(ntimes);
+        }
+
+        for (size_t i = 0; i < ntimes; ++i) {
+            update_drivers(i);
+            for (size_t m : module_indices) {
+                direct_modules[m]->run();
+            }
+            for (string const& name : output_names) {
+                columns[name][i] = all_quantities.at(name);
+            }
+        }
+
+        // Return the quantities to the first time point
+        update_drivers(size_t(0));
+        run_module_list(direct_modules);
+
+        return columns;
+    };
+
+    use_precalculated_columns(module_names, driver_table->get_derived_columns(key, calculate));
+}
+
+/**
+ *  @brief Uses stored outputs in place of the named direct modules at integer
+ *  time indices; see `precalculate_driver_modules`
+ */
+void dynamical_system::use_precalculated_columns(
+    string_vector const& module_names,
+    std::shared_ptr<state_vector_map const> columns)
+{
+    precalculated_module_names = module_names;
+    precalculated_columns = columns;
+    calculated_direct_module_indices.clear();
+    precalculated_quantity_ptr_pairs.clear();
+
+    if (!columns) {
+        return;
+    }
+
+    for (size_t i = 0; i < direct_module_names.size(); ++i) {
+        if (std::find(module_names.begin(), module_names.end(), direct_module_names[i]) == module_names.end()) {
+            calculated_direct_module_indices.push_back(i);
+        }
+    }
+
+    precalculated_quantity_ptr_pairs = get_pointer_pairs(
+        keys(*columns),
+        all_quantities,
+        *columns);
+}
+
+/**
+ *  @brief Returns any modules that keep information between calls to the
+ *         state they had when they were created
+ */
+void dynamical_system::clear_module_states()
+{
+    for (module_vector const* modules : {&direct_modules, &differential_modules}) {
+        for (auto const& m : *modules) {
+            m->clear_state();
+        }
+    }
+}
+
 /**
  *  @brief Resets all internally stored quantities back to their original values
  */
@@ -108,6 +655,7 @@ void dynamical_system::reset()
 {
     update_drivers(size_t(0));  // t = 0
     for (auto const& x : initial_values) all_quantities[x.first] = x.second;
+    clear_module_states();
     run_module_list(direct_modules);
 }
 
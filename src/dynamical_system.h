@@ -5,7 +5,11 @@
 #include <string>
 #include <memory>       // For std::shared_ptr
 #include <utility>      // For std::pair
+#include <functional>   // For std::function
+#include <cmath>        // For std::floor
+#include <algorithm>    // For std::find
 #include "state_map.h"  // For state_map, state_vector_map, string_vector, etc
+#include "driver_store.h"
 #include "modules.h"    // For module_vector
 #include "validate_dynamical_system.h"
 #include "dynamical_system_helper_functions.h"
@@ -14,6 +18,21 @@ using std::pair;
 using std::string;
 using std::vector;
 
+/**
+ *  @brief Describes a change to the values of some parameters of a
+ *  `dynamical_system`, along with the modules that are affected by it; see
+ *  `dynamical_system::make_parameter_change_probe`.
+ *
+ *  A probe contains pointers into the quantity map of the system that made it,
+ *  so it can only be used with that system.
+ */
+struct parameter_change_probe {
+    vector<pair<double*, double>> new_values;
+    vector<size_t> direct_module_indices;
+    vector<double*> direct_output_ptrs;
+    vector<size_t> differential_module_indices;
+};
+
 /**
  *  @class dynamical_system
  *
@@ -94,6 +113,31 @@ using std::vector;
  *    differential quantities given values for the time and the differential
  *    quantities
  *
+ *  - `set_fast_modules` divides the differential quantities into a fast
+ *    partition, whose derivatives are calculated by the named differential
+ *    modules, and a slow partition containing the rest; afterwards,
+ *    `calculate_fast_derivative` calculates the derivatives of the fast
+ *    quantities while running only the modules they depend on, which a
+ *    multirate solver can use to take short steps for the fast quantities
+ *
+ *  - `set_cached_modules` makes the named direct modules store their recent
+ *    outputs and reuse them when their inputs repeat, which can save time
+ *    when an expensive module is often called with identical inputs
+ *
+ *  - `get_switching_functions` evaluates the switching functions declared by
+ *    the modules given values for the time and the differential quantities;
+ *    an adaptive solver can use them to locate discontinuities
+ *
+ *  - `get_driver_quantity_names` returns the names of the drivers, which are
+ *    kept in a `driver_store` that is shared with any other systems that use
+ *    the same drivers
+ *
+ *  - `precalculate_driver_modules` calculates the outputs of the direct
+ *    modules whose inputs are all drivers or parameters at every time point
+ *    in advance and stores them with the drivers, where they can be shared by
+ *    other systems that use the same drivers and parameters; afterwards those
+ *    modules are only run at non-integer time indices
+ *
  *  - `get_output_quantity_names` returns the names of all quantities that are
  *    expected to change throughout a simulation, i.e., the drivers, direct
  *    quantities, and differential quantities (but not the parameters)
@@ -105,6 +149,28 @@ using std::vector;
  *    input values of time and the differential quantities; this function
  *    modifies `all_quantities` but has no return value
  *
+ *  - `get_upstream_direct_module_indices` finds the direct modules that must be
+ *    run to calculate a set of quantities, and `update_selected_quantities`
+ *    updates the drivers and differential quantities but only runs those
+ *    modules; together they can recalculate a few outputs at a stored time
+ *    point without running every direct module
+ *
+ *  - `get_time_index` returns the time index from the most recent update
+ *
+ *  - `make_parameter_change_probe` describes a change to some parameter values,
+ *    and `parameter_change_affects_outputs` determines whether that change
+ *    would alter any output quantity or derivative at the current state and
+ *    time without permanently changing the system; together they can find when
+ *    a simulation with different parameter values first diverges from this one
+ *
+ *  - the copy constructor makes an independent system with the same
+ *    quantities and modules; copies can calculate derivatives on separate
+ *    threads, e.g. for the columns of a Jacobian matrix
+ *
+ *  - `clear_module_states` returns any modules that keep information between
+ *    calls to the state they had when they were created, so that a sequence of
+ *    calls gives the same outputs each time it is repeated
+ *
  *  - `reset` returns all quantities to their initial values, as if the
  *    `dynamical_system` object had just been created; this may be helpful if an
  *    object is to be reused for multiple simulations; this function
@@ -146,6 +212,10 @@ class dynamical_system
         string_vector const& dir_module_names,
         string_vector const& differential_module_names);
 
+    // For evaluating derivatives on more than one thread
+    dynamical_system(dynamical_system const& other);
+    dynamical_system& operator=(dynamical_system const&) = delete;
+
     // For integrating via an ode_solver
     size_t get_ntimes() const
     {
@@ -161,6 +231,14 @@ class dynamical_system
                check_euler_requirement(differential_modules);
     }
 
+    /// Check whether any of the modules keeps information from its previous
+    /// calls, so that its outputs depend on the order of the calculations.
+    bool has_stateful_modules() const
+    {
+        return check_state_requirement(direct_modules) ||
+               check_state_requirement(differential_modules);
+    }
+
     template <typename vector_type>
     void get_differential_quantities(vector_type& x) const;
 
@@ -171,29 +249,130 @@ class dynamical_system
     template <typename vector_type, typename time_type>
     void calculate_derivative(const vector_type& x, vector_type& dxdt, const time_type& t);
 
+    // For recalculating a subset of the outputs at a stored time point
+    vector<size_t> get_upstream_direct_module_indices(string_vector const& quantity_names) const;
+
+    template <typename vector_type, typename time_type>
+    void update_selected_quantities(
+        const vector_type& x,
+        const time_type& t,
+        vector<size_t> const& module_indices);
+
+    double get_time_index() const { return time_index; }
+
+    // For finding when different parameter values would first change the
+    // simulation
+    parameter_change_probe make_parameter_change_probe(state_map const& new_values);
+
+    bool parameter_change_affects_outputs(parameter_change_probe const& probe);
+
+    // For reusing the outputs of expensive direct modules
+    void set_cached_modules(string_vector const& cached_module_names);
+
+    // For multirate integration
+    void set_fast_modules(string_vector const& fast_module_names);
+
+    vector<size_t> const& get_fast_quantity_indices() const { return fast_quantity_indices; }
+
+    template <typename vector_type, typename time_type>
+    void calculate_fast_derivative(const vector_type& x, vector_type& dxdt, const time_type& t);
+
+    // For sharing calculations that only depend on the drivers
+    void precalculate_driver_modules();
+
+    string_vector get_precalculated_module_names() const { return precalculated_module_names; }
+
+    // For locating discontinuities
+    bool has_switching_functions() const { return nswitches > 0; }
+
+    template <typename vector_type, typename time_type>
+    void get_switching_functions(const vector_type& x, const time_type& t, vector<double>& g);
+
     // For returning the results of a calculation
     vector<const double*> get_quantity_access_ptrs(string_vector quantity_names) const;
     string_vector get_differential_quantity_names() const { return keys(initial_values); }
+    string_vector get_driver_quantity_names() const { return keys(drivers); }
     string_vector get_output_quantity_names() const;
 
+    // For counting the Jacobian matrices requested and estimated by implicit
+    // ode_solvers; these differ when a matrix is reused for more than one step
+    void count_jacobian_request() { ++njacobian_requests; }
+    void count_jacobian_evaluation() { ++njacobians; }
+
+    // For including derivatives that were calculated by copies of this system
+    void count_derivative_calls(int n) { ncalls += n; }
+
     // For generating reports to the user
     int get_ncalls() const { return ncalls; }
-    void reset_ncalls() { ncalls = 0; }
+    int get_njacobians() const { return njacobians; }
+    int get_njacobian_requests() const { return njacobian_requests; }
+    int get_nfast_calls() const { return nfast_calls; }
+    void reset_ncalls()
+    {
+        ncalls = 0;
+        njacobians = 0;
+        njacobian_requests = 0;
+        nfast_calls = 0;
+    }
     string generate_startup_report() const { return startup_message; }
 
     string generate_usage_report() const
     {
-        return std::to_string(ncalls) + string(" derivatives were calculated");
+        string const jacobian_info = njacobians == 0 ? string("") :
+            string(", including ") + std::to_string(njacobians) +
+            string(" Jacobian matrix estimates") +
+            (njacobian_requests > njacobians ?
+                 string(" that were reused for ") +
+                     std::to_string(njacobian_requests - njacobians) +
+                     string(" additional step attempts") :
+                 string(""));
+
+        string const fast_info = nfast_calls == 0 ? string("") :
+            string(", and the derivatives of the fast quantities were calculated ") +
+            std::to_string(nfast_calls) + string(" more times");
+
+        string cache_info;
+        for (size_t i = 0; i < direct_modules.size(); ++i) {
+            module_output_cache const* cache = direct_modules[i]->get_output_cache();
+            if (cache && cache->get_ncalls() > 0) {
+                cache_info += string("\nThe ") + direct_module_names[i] +
+                              string(" module reused stored outputs for ") +
+                              std::to_string(cache->get_nhits()) + string(" of its ") +
+                              std::to_string(cache->get_ncalls()) + string(" calls (") +
+                              std::to_string(static_cast<int>(100.0 * cache->get_nhits() / cache->get_ncalls() + 0.5)) +
+                              string("%%)");
+            }
+        }
+
+        return std::to_string(ncalls) + string(" derivatives were calculated") + jacobian_info + fast_info + cache_info;
     }
 
+    // For returning modules that keep state between calls to the state they
+    // had when they were created
+    void clear_module_states();
+
     // For fitting via nlopt
     void reset();
 
    private:
+    // Checks whether the constructor inputs can form a valid system, returning
+    // the startup message or throwing an exception
+    static string validate_inputs(
+        state_map const& init_values,
+        state_map const& params,
+        state_vector_map const& drivers,
+        string_vector const& dir_module_names,
+        string_vector const& differential_module_names);
+
+    // The startup message is made first, so the drivers are only attached to a
+    // shared store once the inputs have been validated
+    string startup_message;
+
     // For storing the constructor inputs
     const state_map initial_values;
     const state_map parameters;
-    const state_vector_map drivers;
+    std::shared_ptr<driver_store const> const driver_table;
+    state_vector_map const& drivers;  // the columns of `driver_table`
     string_vector direct_module_names;  // These may be re-ordered in the constructor.
     const string_vector differential_module_names;
 
@@ -205,11 +384,46 @@ class dynamical_system
     module_vector direct_modules;
     module_vector differential_modules;
 
+    // The total number of switching functions declared by the modules, and
+    // the positions of the direct modules that calculate their inputs
+    size_t nswitches = 0;
+    vector<size_t> switching_direct_module_indices;
+
+    // The fast partition for multirate integration: the names of its
+    // differential modules, the positions of its modules in the module lists,
+    // the positions of its quantities in state vectors, and pointers to their
+    // derivatives
+    string_vector fast_module_names;
+    vector<size_t> fast_direct_module_indices;
+    vector<size_t> fast_differential_module_indices;
+    vector<size_t> fast_quantity_indices;
+    vector<double*> fast_derivative_ptrs;
+
+    // The direct modules that reuse their outputs when their inputs repeat
+    string_vector cached_module_names;
+
+    // The direct modules whose outputs have been precalculated at each time
+    // point, the positions of the other direct modules in the module list,
+    // and the precalculated outputs
+    string_vector precalculated_module_names;
+    vector<size_t> calculated_direct_module_indices;
+    std::shared_ptr<state_vector_map const> precalculated_columns;
+    vector<pair<double*, const vector<double>*>> precalculated_quantity_ptr_pairs;
+
+    // The time index used for the most recent update
+    double time_index = 0.0;
+
     // Pointers to quantity values defined during construction
     double* timestep_ptr;
     vector<pair<double*, const double*>> differential_quantity_ptr_pairs;
     vector<pair<double*, const vector<double>*>> driver_quantity_ptr_pairs;
 
+    // For constructing and copying
+    void initialize_modules_and_pointers(string_vector const& differential_quantity_names);
+    void use_precalculated_columns(
+        string_vector const& module_names,
+        std::shared_ptr<state_vector_map const> columns);
+
     // For calculating derivatives
     void update_drivers(double time_indx);
 
@@ -224,7 +438,9 @@ class dynamical_system
 
     // For generating reports to the user
     int ncalls = 0;
-    string startup_message;
+    int njacobians = 0;
+    int njacobian_requests = 0;
+    int nfast_calls = 0;
 };
 
 /**
@@ -262,7 +478,76 @@ void dynamical_system::update_all_quantities(
 {
     update_drivers(t);
     update_differential_quantities(x);
-    run_module_list(direct_modules);
+    time_index = t;
+
+    // Precalculated outputs are only available at integer time indices
+    double const time_indx = t;
+    if (!precalculated_columns || time_indx != std::floor(time_indx)) {
+        run_module_list(direct_modules);
+        return;
+    }
+
+    size_t const i = time_indx;
+    for (auto const& p : precalculated_quantity_ptr_pairs) {
+        *(p.first) = (*(p.second))[i];
+    }
+    for (size_t m : calculated_direct_module_indices) {
+        direct_modules[m]->run();
+    }
+}
+
+/**
+ *  @brief Updates the drivers and differential quantities in the internally
+ *         stored map based on supplied values for the differential quantities
+ *         and the time, but only runs the direct modules with the supplied
+ *         indices
+ *
+ *  The indices should be found with `get_upstream_direct_module_indices`, so
+ *  that the modules are run in their evaluation order and every quantity they
+ *  require has been updated. Quantities calculated by the other direct modules
+ *  keep their values from the last update. At integer time indices, the
+ *  outputs of any precalculated modules are copied as they are by
+ *  `update_all_quantities`.
+ *
+ *  @param[in] x an object containing new values for the differential
+ *         quantities
+ *
+ *  @param[in] t the time
+ *
+ *  @param[in] module_indices the positions of the direct modules to run
+ */
+template <typename vector_type, typename time_type>
+void dynamical_system::update_selected_quantities(
+    const vector_type& x,
+    const time_type& t,
+    vector<size_t> const& module_indices)
+{
+    update_drivers(t);
+    update_differential_quantities(x);
+    time_index = t;
+
+    double const time_indx = t;
+    bool const use_precalculated =
+        precalculated_columns && time_indx == std::floor(time_indx);
+
+    if (use_precalculated) {
+        size_t const i = time_indx;
+        for (auto const& p : precalculated_quantity_ptr_pairs) {
+            *(p.first) = (*(p.second))[i];
+        }
+    }
+
+    for (size_t m : module_indices) {
+        bool const is_precalculated =
+            use_precalculated &&
+            std::find(calculated_direct_module_indices.begin(),
+                      calculated_direct_module_indices.end(),
+                      m) == calculated_direct_module_indices.end();
+
+        if (!is_precalculated) {
+            direct_modules[m]->run();
+        }
+    }
 }
 
 /**
@@ -285,6 +570,82 @@ void dynamical_system::calculate_derivative(const vector_type& x, vector_type& d
     run_differential_modules(dxdt);
 }
 
+/**
+ *  @brief Calculates derivatives for the fast differential quantities based on
+ *         supplied values for all the differential quantities and the time
+ *
+ *  Only the fast differential modules and the direct modules they depend on
+ *  are run, so quantities calculated by the other direct modules keep the
+ *  values from the last full update. Elements of `dxdt` that correspond to
+ *  slow quantities are not modified. See `set_fast_modules` for more
+ *  information.
+ *
+ *  @param[in] x values of all the differential quantities
+ *
+ *  @param[out] dxdt derivatives of the fast differential quantities calculated
+ *         using x and t
+ *
+ *  @param[in] t the time
+ */
+template <typename vector_type, typename time_type>
+void dynamical_system::calculate_fast_derivative(const vector_type& x, vector_type& dxdt, const time_type& t)
+{
+    ++nfast_calls;
+    update_drivers(t);
+    update_differential_quantities(x);
+
+    for (size_t i : fast_direct_module_indices) {
+        direct_modules[i]->run();
+    }
+
+    for (double* p : fast_derivative_ptrs) {
+        *p = 0.0;
+    }
+
+    for (size_t i : fast_differential_module_indices) {
+        differential_modules[i]->run();
+    }
+
+    for (size_t k = 0; k < fast_quantity_indices.size(); ++k) {
+        dxdt[fast_quantity_indices[k]] = *(fast_derivative_ptrs[k]) * (*timestep_ptr);
+    }
+}
+
+/**
+ *  @brief Evaluates the switching functions of all the modules based on
+ *         supplied values for the differential quantities and the time
+ *
+ *  The direct modules' switching functions are listed first, followed by the
+ *  differential modules'; the order is the same for every call, so the values
+ *  from two calls can be compared element by element. See
+ *  `module_base::get_switching_functions()` for more information.
+ *
+ *  Only the direct modules that the switching functions depend on are run, so
+ *  the other direct quantities keep their values from the last update.
+ *
+ *  @param[in] x values of the differential quantities
+ *
+ *  @param[in] t the time
+ *
+ *  @param[out] g the values of the switching functions
+ */
+template <typename vector_type, typename time_type>
+void dynamical_system::get_switching_functions(
+    const vector_type& x,
+    const time_type& t,
+    vector<double>& g)
+{
+    update_selected_quantities(x, t, switching_direct_module_indices);
+
+    g.clear();
+    for (module_vector const* modules : {&direct_modules, &differential_modules}) {
+        for (auto const& m : *modules) {
+            vector<double> const values = m->get_switching_functions();
+            g.insert(g.end(), values.begin(), values.end());
+        }
+    }
+}
+
 /**
  *  @brief Updates values of the drivers in the internally stored quantity map
  *         to match their values in the internally stored drivers table at time
@@ -347,7 +708,14 @@ void dynamical_system::run_differential_modules(vector_type& dxdt)
 
  *  @param[in,out] message additional text will be appended to this string
  *
+ *  @param[in] should_stop an optional function that is called with each stored
+ *             state and time; if it returns true, an `integration_stopped`
+ *             object is thrown to end the integration after that point
+ *
  */
+struct integration_stopped {
+};
+
 template <typename vector_type>
 struct push_back_state_and_time {
    private:
@@ -358,6 +726,7 @@ struct push_back_state_and_time {
     double threshold = 0;
     double threshold_increment = 0.02;
     string& msg;
+    std::function<bool(vector_type const&, double)> should_stop;
 
    public:
     // Constructor
@@ -365,11 +734,13 @@ struct push_back_state_and_time {
         vector<vector_type>& states,
         vector<double>& times,
         double maximum_time,
-        string& message)
+        string& message,
+        std::function<bool(vector_type const&, double)> should_stop = nullptr)
         : states(states),
           times(times),
           max_time(maximum_time),
-          msg(message) {}
+          msg(message),
+          should_stop(should_stop) {}
 
     // Operation
     void operator()(vector_type const& x, double t)
@@ -389,6 +760,10 @@ struct push_back_state_and_time {
         // Store the new values
         states.push_back(x);
         times.push_back(t);
+
+        if (should_stop && should_stop(x, t)) {
+            throw integration_stopped{};
+        }
     }
 };
 
@@ -422,7 +797,9 @@ state_vector_map get_results_from_system(
     vector<const double*> output_param_ptrs =
         sys->get_quantity_access_ptrs(output_param_names);
 
-    // Store the data
+    // Store the data, starting any modules that keep state between calls from
+    // their initial state so the results only depend on the stored points
+    sys->clear_module_states();
     for (size_t i = 0; i < x_vec.size(); ++i) {
         sys->update_all_quantities(x_vec[i], times[i]);
         for (size_t j = 0; j < output_param_names.size(); ++j) {
@@ -1,7 +1,81 @@
 #ifndef DYNAMICAL_SYSTEM_CALLER_H
 #define DYNAMICAL_SYSTEM_CALLER_H
 
+#include <algorithm>  // for std::equal
+#include <memory>     // for std::shared_ptr
+#include <vector>
 #include "numerical_jacobian.h"
+#include "parallel_jacobian.h"
+
+/**
+ * @class jacobian_cache
+ *
+ * @brief Stores the most recently estimated Jacobian matrix and time
+ * derivative so that an implicit stepper can use them for more than one step
+ * attempt.
+ *
+ * A stepper retries a rejected step from the same point with a smaller step
+ * size, so a request at the point where the stored matrix was estimated can
+ * reuse it exactly. A request at any other point always estimates a new
+ * matrix, since the Rosenbrock coefficients assume an exact one.
+ */
+class jacobian_cache
+{
+   public:
+    template <typename state_type, typename time_type>
+    bool needs_refresh(state_type const& x, time_type const& t) const
+    {
+        return !(valid && is_at(x, t, x_jacobian, t_jacobian));
+    }
+
+    template <typename state_type, typename jacobi_type, typename time_type>
+    void store(state_type const& x, time_type const& t, jacobi_type const& jacobi, state_type const& dfdt)
+    {
+        size_t const n = x.size();
+        assign(x, x_jacobian);
+        t_jacobian = t;
+        assign(dfdt, stored_dfdt);
+        stored_jacobi.resize(n * n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                stored_jacobi[i * n + j] = jacobi(i, j);
+            }
+        }
+        valid = true;
+    }
+
+    template <typename state_type, typename jacobi_type>
+    void retrieve(jacobi_type& jacobi, state_type& dfdt) const
+    {
+        size_t const n = stored_dfdt.size();
+        for (size_t i = 0; i < n; ++i) {
+            dfdt[i] = stored_dfdt[i];
+            for (size_t j = 0; j < n; ++j) {
+                jacobi(i, j) = stored_jacobi[i * n + j];
+            }
+        }
+    }
+
+   private:
+    bool valid = false;
+    std::vector<double> x_jacobian;
+    double t_jacobian = 0.0;
+    std::vector<double> stored_jacobi;
+    std::vector<double> stored_dfdt;
+
+    template <typename state_type>
+    static void assign(state_type const& x, std::vector<double>& destination)
+    {
+        destination.assign(x.begin(), x.end());
+    }
+
+    template <typename state_type, typename time_type>
+    static bool is_at(state_type const& x, time_type const& t, std::vector<double> const& x_stored, double t_stored)
+    {
+        return t == t_stored && x.size() == x_stored.size() &&
+               std::equal(x.begin(), x.end(), x_stored.begin());
+    }
+};
 
 /**
  * @class dynamical_system_pointer_wrapper
@@ -12,8 +86,11 @@
 class dynamical_system_pointer_wrapper
 {
    public:
-    dynamical_system_pointer_wrapper(std::shared_ptr<dynamical_system> sys)
-        : sys(sys)
+    dynamical_system_pointer_wrapper(
+        std::shared_ptr<dynamical_system> sys,
+        std::shared_ptr<jacobian_cache> cache,
+        std::shared_ptr<parallel_jacobian_calculator> parallel_calculator)
+        : sys(sys), cache(cache), parallel_calculator(parallel_calculator)
     {
     }
 
@@ -26,13 +103,34 @@ class dynamical_system_pointer_wrapper
     template <typename state_type, typename jacobi_type, typename time_type>
     void operator()(state_type const& x, jacobi_type& jacobi, time_type const& t, state_type& dfdt)
     {
-        calculate_jacobian_and_time_derivative(sys, sys->get_ntimes() - 1.0, x, t, jacobi, dfdt);
+        sys->count_jacobian_request();
+        if (cache->needs_refresh(x, t)) {
+            sys->count_jacobian_evaluation();
+            if (parallel_calculator) {
+                parallel_calculator->calculate(x, t, jacobi, dfdt);
+            } else {
+                calculate_jacobian_and_time_derivative(sys, sys->get_ntimes() - 1.0, x, t, jacobi, dfdt);
+            }
+            cache->store(x, t, jacobi, dfdt);
+        } else {
+            cache->retrieve(jacobi, dfdt);
+        }
     }
 
     size_t get_ntimes() const { return sys->get_ntimes(); }
 
+    bool has_switching_functions() const { return sys->has_switching_functions(); }
+
+    template <typename state_type, typename time_type>
+    void get_switching_functions(state_type const& x, time_type const& t, std::vector<double>& g)
+    {
+        sys->get_switching_functions(x, t, g);
+    }
+
    private:
     std::shared_ptr<dynamical_system> sys;
+    std::shared_ptr<jacobian_cache> cache;
+    std::shared_ptr<parallel_jacobian_calculator> parallel_calculator;  // null for serial calculations
 };
 
 /**
@@ -40,15 +138,20 @@ class dynamical_system_pointer_wrapper
  *
  * @brief This is a simple class that allows us to use the same object as an
  * input to `boost::numeric::odeint::integrate_const` with either an explicit or
- * implicit stepper.
+ * implicit stepper. All copies of a caller share the same `jacobian_cache`.
+ *
+ * When `jacobian_threads` is larger than one, the columns of each Jacobian
+ * matrix are calculated on that many threads by a
+ * `parallel_jacobian_calculator`.
  */
 class dynamical_system_caller : public dynamical_system_pointer_wrapper
 {
    public:
-    dynamical_system_caller(std::shared_ptr<dynamical_system> sys)
-        : dynamical_system_pointer_wrapper(sys),
-          first(dynamical_system_pointer_wrapper(sys)),
-          second(dynamical_system_pointer_wrapper(sys))
+    dynamical_system_caller(std::shared_ptr<dynamical_system> sys, size_t jacobian_threads = 1)
+        : dynamical_system_caller(
+              sys,
+              std::make_shared<jacobian_cache>(),
+              jacobian_threads > 1 ? std::make_shared<parallel_jacobian_calculator>(sys, jacobian_threads) : nullptr)
     {
     }
 
@@ -57,6 +160,17 @@ class dynamical_system_caller : public dynamical_system_pointer_wrapper
     typedef first_type second_type;
     first_type first;
     second_type second;
+
+   private:
+    dynamical_system_caller(
+        std::shared_ptr<dynamical_system> sys,
+        std::shared_ptr<jacobian_cache> cache,
+        std::shared_ptr<parallel_jacobian_calculator> parallel_calculator)
+        : dynamical_system_pointer_wrapper(sys, cache, parallel_calculator),
+          first(dynamical_system_pointer_wrapper(sys, cache, parallel_calculator)),
+          second(dynamical_system_pointer_wrapper(sys, cache, parallel_calculator))
+    {
+    }
 };
 
 #endif
@@ -13,3 +13,14 @@ bool check_euler_requirement(module_vector const& modules_to_check)
 
     return num_requiring_euler > 0;
 }
+
+bool check_state_requirement(module_vector const& modules_to_check)
+{
+    int num_keeping_state{0};
+
+    for (auto const& x : modules_to_check) {
+        num_keeping_state += x->keeps_state();
+    }
+
+    return num_keeping_state > 0;
+}
@@ -78,4 +78,6 @@ std::vector<const value_type*> get_const_pointers(
 
 bool check_euler_requirement(module_vector const& modules_to_check);
 
+bool check_state_requirement(module_vector const& modules_to_check);
+
 #endif
@@ -0,0 +1,95 @@
+#include <cmath>      // for std::floor
+#include <algorithm>  // for std::find, std::copy
+#include <stdexcept>  // for std::logic_error, std::out_of_range
+#include "lazy_simulation_result.h"
+
+lazy_simulation_result::lazy_simulation_result(std::shared_ptr<dynamical_system> sys)
+    : sys{sys},
+      quantity_names{sys->get_output_quantity_names()},
+      nstates{sys->get_differential_quantity_names().size()}
+{
+}
+
+/**
+ *  @brief Clears any points stored from a previous simulation; the system must
+ *  be the one that was passed to the constructor.
+ */
+void lazy_simulation_result::attach(dynamical_system const& sys)
+{
+    if (&sys != this->sys.get()) {
+        throw std::logic_error(
+            std::string("Thrown by lazy_simulation_result::attach: a lazy ") +
+            std::string("result can only record the system it was made for.\n"));
+    }
+
+    time_indices.clear();
+    states.clear();
+}
+
+void lazy_simulation_result::record()
+{
+    std::vector<double> x;
+    sys->get_differential_quantities(x);
+
+    time_indices.push_back(sys->get_time_index());
+    states.insert(states.end(), x.begin(), x.end());
+}
+
+std::vector<double> lazy_simulation_result::get_column(std::string const& quantity_name)
+{
+    return get_columns({quantity_name}).at(quantity_name);
+}
+
+/**
+ *  @brief Calculates the values of several output quantities at every stored
+ *  time point, running the direct modules they require only once per point.
+ */
+state_vector_map lazy_simulation_result::get_columns(string_vector const& names)
+{
+    for (std::string const& name : names) {
+        if (std::find(quantity_names.begin(), quantity_names.end(), name) == quantity_names.end()) {
+            throw std::out_of_range(
+                std::string("\"") + name + std::string("\" was requested ") +
+                std::string("from a lazy simulation result, but it is not an ") +
+                std::string("output of the system.\n"));
+        }
+    }
+
+    std::vector<size_t> const module_indices =
+        sys->get_upstream_direct_module_indices(names);
+
+    std::vector<const double*> const ptrs = sys->get_quantity_access_ptrs(names);
+
+    std::vector<std::vector<double>> columns(names.size(), std::vector<double>(size()));
+    std::vector<double> x(nstates);
+
+    // Start any modules that keep state between calls from their initial
+    // state, so a column does not depend on which columns were calculated
+    // before it
+    sys->clear_module_states();
+
+    for (size_t i = 0; i < size(); ++i) {
+        std::copy(states.begin() + i * nstates,
+                  states.begin() + (i + 1) * nstates,
+                  x.begin());
+
+        // Integer time indices are passed as integers so the drivers are not
+        // interpolated, which also avoids reading past the last driver value
+        double const t = time_indices[i];
+        if (t == std::floor(t)) {
+            sys->update_selected_quantities(x, static_cast<size_t>(t), module_indices);
+        } else {
+            sys->update_selected_quantities(x, t, module_indices);
+        }
+
+        for (size_t j = 0; j < names.size(); ++j) {
+            columns[j][i] = *ptrs[j];
+        }
+    }
+
+    state_vector_map result;
+    for (size_t j = 0; j < names.size(); ++j) {
+        result[names[j]] = columns[j];
+    }
+    return result;
+}
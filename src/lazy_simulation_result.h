@@ -0,0 +1,65 @@
+#ifndef LAZY_SIMULATION_RESULT_H
+#define LAZY_SIMULATION_RESULT_H
+
+#include <vector>
+#include <string>
+#include <memory>       // for std::shared_ptr
+#include "state_map.h"  // for state_vector_map, string_vector
+#include "dynamical_system.h"
+#include "output_observer.h"
+
+/**
+ *  @class lazy_simulation_result
+ *
+ *  @brief Stores only the time index and the values of the differential
+ *  quantities at each output time point of a simulation, and calculates the
+ *  other output quantities when they are requested.
+ *
+ *  This class is an `output_observer`, so it can be passed to any ODE solver.
+ *  It keeps a pointer to the solved system, which also keeps the drivers
+ *  alive. When an output column is requested, the system's drivers and
+ *  differential quantities are updated at each stored time point and only the
+ *  direct modules required by that column are run; see
+ *  `dynamical_system::update_selected_quantities`. The memory used by a
+ *  result is therefore roughly that of the differential quantities alone,
+ *  rather than that of every output quantity.
+ *
+ *  Before each set of columns is calculated, any modules that keep
+ *  information between calls are returned to their initial state, and the
+ *  stored points are visited in order. The direct modules that a column
+ *  requires therefore see the same sequence of inputs each time, so the
+ *  values of a column do not depend on which columns were requested before
+ *  it. The ODE solvers that recalculate their outputs after integrating do
+ *  the same, so lazy columns match the normal outputs of those solvers.
+ */
+class lazy_simulation_result : public output_observer
+{
+   public:
+    lazy_simulation_result(std::shared_ptr<dynamical_system> sys);
+
+    void attach(dynamical_system const& sys) override;
+
+    void record() override;
+
+    size_t size() const { return time_indices.size(); }
+
+    string_vector get_quantity_names() const { return quantity_names; }
+
+    int get_ncalls() const { return sys->get_ncalls(); }
+
+    std::vector<double> get_column(std::string const& quantity_name);
+
+    state_vector_map get_columns(string_vector const& quantity_names);
+
+   private:
+    std::shared_ptr<dynamical_system> sys;
+    string_vector quantity_names;
+    size_t nstates = 0;
+
+    // The time index of each output point and the values of the differential
+    // quantities, stored one point after another
+    std::vector<double> time_indices;
+    std::vector<double> states;
+};
+
+#endif
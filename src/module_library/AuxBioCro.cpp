@@ -138,55 +138,25 @@ double absorbed_shortwave_from_incident_ppfd(
            (1 - leaf_transmittance);  // J / m^2 / s
 }
 
+namespace
+{
 /**
- *  @brief Computes an n-layered light profile from the direct light, diffuse
- *  light, leaf area index, solar zenith angle, and other parameters.
- *
- *  @param [in] ambient_ppfd_beam Photosynthetically active photon flux density
- *              (PPFD) for beam light passing through a surface perpendicular
- *              to the beam direction at the top of the canopy; this represents
- *              direct sunlight for a plant in a field
- *              (micromol / (m^2 beam) / s)
- *
- *  @param [in] ambient_ppfd_diffuse Photosynthetically active photon flux
- *              density (PPFD) for diffuse light at the top of the canopy; this
- *              represents diffuse light scattered out of the solar beam by the
- *              Earth's atmosphere for a plant in a field; as a diffuse flux
- *              density, this represents the flux through any surface
- *              (micromol / m^2 / s)
- *
- *  @param [in] lai Leaf area index (LAI) of the entire canopy, which represents
- *              the leaf area per unit of ground area (dimensionless from m^2
- *              leaf / m^2 ground)
- *
- *  @param [in] nlayers Integer number of layers in the canopy
- *
- *  @param [in] cosine_zenith_angle Cosine of the solar zenith angle
- *              (dimensionless)
- *
- *  @param [in] kd Extinction coefficient for diffuse light (dimensionless)
- *
- *  @param [in] chil Ratio of average projected areas of canopy elements on
- *              horizontal surfaces; for a spherical leaf distribution,
- *              `chil = 0`; for a vertical leaf distribution, `chil = 1`; for a
- *              horizontal leaf distribution, `chil` approaches infinity
- *              (dimensionless from m^2 / m^2)
- *
- *  @param [in] absorptivity The leaf absorptivity on a quantum basis
- *              (dimensionless from mol / mol)
- *
- *  @param [in] heightf Leaf area density, i.e., LAI per height of canopy (m^-1
- *              from m^2 leaf / m^2 ground / m height)
- *
- *  @return An n-layered light profile representing quantities within
- *          the canopy, including several photon flux densities and
- *          the relative fractions of shaded and sunlit leaves
+ *  @brief Computes a light profile at a set of depths in the canopy; this is
+ *  the common part of `sunML` and `sunML_at_depths`.
+ *
+ *  Each layer represents `layer_lais[i]` of leaf area centered on a depth of
+ *  `cumulative_lais[i]`. If `layer_lais` is a null pointer, each layer instead
+ *  represents the leaves at a single depth, so its sunlit fraction and average
+ *  incident PPFD are the values at that depth rather than averages over a
+ *  layer of finite thickness.
  */
-Light_profile sunML(
+Light_profile canopy_light_profile(
     double ambient_ppfd_beam,     // micromol / (m^2 beam) / s
     double ambient_ppfd_diffuse,  // micromol / m^2 / s
     double lai,                   // dimensionless from m^2 / m^2
     int nlayers,                  // dimensionless
+    double const* cumulative_lais, // dimensionless from m^2 / m^2
+    double const* layer_lais,      // dimensionless from m^2 / m^2
     double cosine_zenith_angle,   // dimensionless
     double kd,                    // dimensionless
     double chil,                  // dimensionless from m^2 / m^2
@@ -198,9 +168,6 @@ Light_profile sunML(
     double leaf_reflectance       // dimensionless
 )
 {
-    if (nlayers < 1 || nlayers > MAXLAY) {
-        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
-    }
     if (cosine_zenith_angle > 1 || cosine_zenith_angle < -1) {
         throw std::out_of_range("cosine_zenith_angle must be between -1 and 1.");
     }
@@ -229,8 +196,6 @@ Light_profile sunML(
     double k1 = chil + 1.744 * pow((chil + 1.182), -0.733);
     double k = k0 / k1;  // dimensionless
 
-    double lai_per_layer = lai / nlayers;
-
     // Calculate the ambient direct PPFD through a surface parallel to the ground
     const double ambient_ppfd_beam_ground = ambient_ppfd_beam * cosine_zenith_angle;  // micromol / (m^2 ground) / s
 
@@ -239,9 +204,11 @@ Light_profile sunML(
 
     Light_profile light_profile;
     for (int i = 0; i < nlayers; ++i) {
-        // Get the cumulative LAI for this layer, which represents the total
-        // leaf area above this layer
-        const double cumulative_lai = lai_per_layer * (i + 0.5);
+        // Get the leaf area represented by this layer and the cumulative LAI
+        // at its center, which represents the total leaf area above it
+        const bool is_point = layer_lais == nullptr;
+        const double lai_per_layer = is_point ? 0.0 : layer_lais[i];
+        const double cumulative_lai = cumulative_lais[i];
 
         // Calculate the amount of PPFD scattered out of the direct beam using
         // Equations 15.6 and 15.1 from Campbell & Norman (1998), following
@@ -259,18 +226,26 @@ Light_profile sunML(
             ambient_ppfd_diffuse * exp(-kd * cumulative_lai) + scattered_ppfd;  // micromol / m^2 / s
 
         // Calculate the fraction of sunlit and shaded leaves in this canopy
-        // layer using Equation 15.21.
+        // layer using Equation 15.21, or, when the layer represents a single
+        // depth in the canopy, using the probability that a leaf at that depth
+        // is sunlit (Equation 15.19).
         const double Ls = (1 - exp(-k * lai_per_layer)) * exp(-k * cumulative_lai) / k;  // dimensionless
-        double sunlit_fraction = Ls / lai_per_layer;                                     // dimensionless
-        double shaded_fraction = 1 - sunlit_fraction;                                    // dimensionless
+        double sunlit_fraction = is_point ? exp(-k * cumulative_lai)
+                                          : Ls / lai_per_layer;  // dimensionless
+        double shaded_fraction = 1 - sunlit_fraction;            // dimensionless
 
         // Calculate an "average" incident PPFD for the sunlit and shaded leaves
         // that doesn't seem to be based on a formula from Campbell & Norman
         // (1998). It's interpreted as a flux density through a unit of leaf
-        // area, but that may not be correct.
+        // area, but that may not be correct. Since it's proportional to the
+        // leaf area in the layer, it's replaced by the mean PPFD for sunlit
+        // and shaded leaves when the layer represents a single depth.
         double average_ppfd =
-            (sunlit_fraction * (ambient_ppfd_beam_leaf + diffuse_ppfd) + shaded_fraction * diffuse_ppfd) *
-            (1 - exp(-k * lai_per_layer)) / k;  // micromol / (m^2 leaf) / s
+            sunlit_fraction * (ambient_ppfd_beam_leaf + diffuse_ppfd) + shaded_fraction * diffuse_ppfd;  // micromol / (m^2 leaf) / s
+
+        if (!is_point) {
+            average_ppfd = average_ppfd * (1 - exp(-k * lai_per_layer)) / k;  // micromol / (m^2 leaf) / s
+        }
 
         // For values of cosine_zenith_angle close to or less than 0, in place
         // of the calculations above, we want to use the limits of the above
@@ -320,6 +295,188 @@ Light_profile sunML(
     }
     return light_profile;
 }
+}  // namespace
+
+/**
+ *  @brief Computes an n-layered light profile from the direct light, diffuse
+ *  light, leaf area index, solar zenith angle, and other parameters.
+ *
+ *  @param [in] ambient_ppfd_beam Photosynthetically active photon flux density
+ *              (PPFD) for beam light passing through a surface perpendicular
+ *              to the beam direction at the top of the canopy; this represents
+ *              direct sunlight for a plant in a field
+ *              (micromol / (m^2 beam) / s)
+ *
+ *  @param [in] ambient_ppfd_diffuse Photosynthetically active photon flux
+ *              density (PPFD) for diffuse light at the top of the canopy; this
+ *              represents diffuse light scattered out of the solar beam by the
+ *              Earth's atmosphere for a plant in a field; as a diffuse flux
+ *              density, this represents the flux through any surface
+ *              (micromol / m^2 / s)
+ *
+ *  @param [in] lai Leaf area index (LAI) of the entire canopy, which represents
+ *              the leaf area per unit of ground area (dimensionless from m^2
+ *              leaf / m^2 ground)
+ *
+ *  @param [in] nlayers Integer number of layers in the canopy
+ *
+ *  @param [in] cosine_zenith_angle Cosine of the solar zenith angle
+ *              (dimensionless)
+ *
+ *  @param [in] kd Extinction coefficient for diffuse light (dimensionless)
+ *
+ *  @param [in] chil Ratio of average projected areas of canopy elements on
+ *              horizontal surfaces; for a spherical leaf distribution,
+ *              `chil = 0`; for a vertical leaf distribution, `chil = 1`; for a
+ *              horizontal leaf distribution, `chil` approaches infinity
+ *              (dimensionless from m^2 / m^2)
+ *
+ *  @param [in] absorptivity The leaf absorptivity on a quantum basis
+ *              (dimensionless from mol / mol)
+ *
+ *  @param [in] heightf Leaf area density, i.e., LAI per height of canopy (m^-1
+ *              from m^2 leaf / m^2 ground / m height)
+ *
+ *  @return An n-layered light profile representing quantities within
+ *          the canopy, including several photon flux densities and
+ *          the relative fractions of shaded and sunlit leaves
+ */
+Light_profile sunML(
+    double ambient_ppfd_beam,     // micromol / (m^2 beam) / s
+    double ambient_ppfd_diffuse,  // micromol / m^2 / s
+    double lai,                   // dimensionless from m^2 / m^2
+    int nlayers,                  // dimensionless
+    double cosine_zenith_angle,   // dimensionless
+    double kd,                    // dimensionless
+    double chil,                  // dimensionless from m^2 / m^2
+    double absorptivity,          // dimensionless from mol / mol
+    double heightf,               // m^-1 from m^2 leaf / m^2 ground / m height
+    double par_energy_content,    // J / micromol
+    double par_energy_fraction,   // dimensionless
+    double leaf_transmittance,    // dimensionless
+    double leaf_reflectance       // dimensionless
+)
+{
+    if (nlayers < 1 || nlayers > MAXLAY) {
+        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
+    }
+
+    double lai_per_layer = lai / nlayers;
+
+    double cumulative_lai[MAXLAY];
+    double layer_lai[MAXLAY];
+    for (int i = 0; i < nlayers; ++i) {
+        cumulative_lai[i] = lai_per_layer * (i + 0.5);
+        layer_lai[i] = lai_per_layer;
+    }
+
+    return canopy_light_profile(
+        ambient_ppfd_beam, ambient_ppfd_diffuse, lai, nlayers, cumulative_lai,
+        layer_lai, cosine_zenith_angle, kd, chil, absorptivity, heightf,
+        par_energy_content, par_energy_fraction, leaf_transmittance,
+        leaf_reflectance);
+}
+
+/**
+ *  @brief Computes a light profile at arbitrary depths in the canopy, such as
+ *  the nodes of a quadrature rule.
+ *
+ *  The arguments are the same as for `sunML`, except that layer `i` represents
+ *  the leaves at a cumulative LAI of `lai * relative_depths[i]` rather than an
+ *  equally sized slice of the canopy. Its sunlit fraction is the probability
+ *  that a leaf at that depth is sunlit, and its average incident PPFD is the
+ *  mean PPFD for sunlit and shaded leaves at that depth. Together with the
+ *  depths and weights from `gauss_legendre_canopy_nodes`, a few layers
+ *  represent the whole canopy accurately.
+ */
+Light_profile sunML_at_depths(
+    double ambient_ppfd_beam,       // micromol / (m^2 beam) / s
+    double ambient_ppfd_diffuse,    // micromol / m^2 / s
+    double lai,                     // dimensionless from m^2 / m^2
+    int nlayers,                    // dimensionless
+    double const* relative_depths,  // dimensionless
+    double cosine_zenith_angle,     // dimensionless
+    double kd,                      // dimensionless
+    double chil,                    // dimensionless from m^2 / m^2
+    double absorptivity,            // dimensionless from mol / mol
+    double heightf,                 // m^-1 from m^2 leaf / m^2 ground / m height
+    double par_energy_content,      // J / micromol
+    double par_energy_fraction,     // dimensionless
+    double leaf_transmittance,      // dimensionless
+    double leaf_reflectance         // dimensionless
+)
+{
+    if (nlayers < 1 || nlayers > MAXLAY) {
+        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
+    }
+
+    double cumulative_lai[MAXLAY];
+    for (int i = 0; i < nlayers; ++i) {
+        cumulative_lai[i] = lai * relative_depths[i];
+    }
+
+    return canopy_light_profile(
+        ambient_ppfd_beam, ambient_ppfd_diffuse, lai, nlayers, cumulative_lai,
+        nullptr, cosine_zenith_angle, kd, chil, absorptivity, heightf,
+        par_energy_content, par_energy_fraction, leaf_transmittance,
+        leaf_reflectance);
+}
+
+/**
+ *  @brief Determines the depths and weights of the Gauss-Legendre quadrature
+ *  rule with `nlayers` nodes, expressed as fractions of the canopy's total LAI.
+ *
+ *  Integrals over the canopy, such as the canopy assimilation rate, can be
+ *  approximated by evaluating the integrand at the depths `lai *
+ *  relative_depths[i]` and summing the values weighted by `lai *
+ *  relative_weights[i]`. The rule is exact for polynomials of degree `2 *
+ *  nlayers - 1`, so it converges much faster than the midpoint rule used by
+ *  `sunML` for the smooth, exponentially decaying profiles found in a canopy.
+ *
+ *  The nodes are found by Newton's method, starting from the usual asymptotic
+ *  approximation of the roots of the Legendre polynomial.
+ */
+void gauss_legendre_canopy_nodes(
+    int nlayers,
+    double* relative_depths,  // dimensionless
+    double* relative_weights  // dimensionless
+)
+{
+    if (nlayers < 1 || nlayers > MAXLAY) {
+        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
+    }
+
+    for (int i = 0; i < (nlayers + 1) / 2; ++i) {
+        // Find the i-th root of the Legendre polynomial of degree `nlayers`,
+        // counting down from 1
+        double x = cos(math_constants::pi * (i + 0.75) / (nlayers + 0.5));
+        double dp = 0;
+        for (int iteration = 0; iteration < 100; ++iteration) {
+            // Evaluate the polynomial using its recurrence relation
+            double p0 = 1.0;
+            double p1 = x;
+            for (int j = 2; j <= nlayers; ++j) {
+                double const p2 = ((2 * j - 1) * x * p1 - (j - 1) * p0) / j;
+                p0 = p1;
+                p1 = p2;
+            }
+            dp = nlayers * (x * p1 - p0) / (x * x - 1);
+            double const dx = p1 / dp;
+            x -= dx;
+            if (std::abs(dx) < 1e-15) {
+                break;
+            }
+        }
+
+        // Map the interval [-1, 1] onto relative depths in [0, 1], where a
+        // depth of 0 represents the top of the canopy
+        double const weight = 1.0 / ((1 - x * x) * dp * dp);
+        relative_depths[i] = 0.5 * (1 - x);
+        relative_depths[nlayers - 1 - i] = 0.5 * (1 + x);
+        relative_weights[i] = weight;
+        relative_weights[nlayers - 1 - i] = weight;
+    }
+}
 
 
 /* Additional Functions needed for EvapoTrans */
@@ -464,6 +621,50 @@ void LNprof(double LeafN, double LAI, int nlayers, double kpLN, double* leafN_pr
     }
 }
 
+/**
+ * @brief Versions of the `RHprof`, `WINDprof`, and `LNprof` profile functions
+ * that evaluate each profile at arbitrary depths in the canopy rather than at
+ * the boundaries of equally sized layers.
+ *
+ * Here `relative_depths[i]` is the cumulative LAI above layer `i`, expressed as
+ * a fraction of the canopy's total LAI, so `x = relative_depths[i]` in the
+ * notation of `RHprof`.
+ */
+void RHprof_at_depths(double RH, int nlayers, double const* relative_depths,
+                      double* relative_humidity_profile)
+{
+    if (RH > 1 || RH < 0) {
+        throw std::out_of_range("RH must be between 0 and 1.");
+    }
+    if (nlayers < 1 || nlayers > MAXLAY) {
+        throw std::out_of_range("nlayers must be at least 1 but no more than MAXLAY.");
+    }
+
+    const double kh = 1 - RH;
+
+    for (int i = 0; i < nlayers; ++i) {
+        relative_humidity_profile[i] = RH * exp(kh * relative_depths[i]);
+    }
+}
+
+void WINDprof_at_depths(double WindSpeed, double LAI, int nlayers,
+                        double const* relative_depths, double* wind_speed_profile)
+{
+    constexpr double k = 0.7;
+
+    for (int i = 0; i < nlayers; ++i) {
+        wind_speed_profile[i] = WindSpeed * exp(-k * LAI * relative_depths[i]);
+    }
+}
+
+void LNprof_at_depths(double LeafN, double LAI, int nlayers, double kpLN,
+                      double const* relative_depths, double* leafN_profile)
+{
+    for (int i = 0; i < nlayers; ++i) {
+        leafN_profile[i] = LeafN * exp(-kpLN * LAI * relative_depths[i]);
+    }
+}
+
 /**
  *  @brief Determines the density of dry air from the air temperature.
  *
@@ -193,6 +193,7 @@ double leaf_boundary_layer_conductance_thornley(
 );
 
 void LNprof(double LeafN, double LAI, int nlayers, double kpLN, double* leafNla);
+void LNprof_at_depths(double LeafN, double LAI, int nlayers, double kpLN, double const* relative_depths, double* leafNla);
 
 /**
  *  @brief Calculates the exponential term of the Arrhenius equation.
@@ -2,6 +2,7 @@
 #define BIOCRO_H
 
 #include "AuxBioCro.h"
+#include "leaf_warm_start.h"  // for canopy_warm_start
 
 struct Light_model {
 	double direct_irradiance_fraction;
@@ -18,7 +19,8 @@ struct Can_Str CanAC(
     double StomataWS, double specific_heat_of_air, double atmospheric_pressure,
     int water_stress_approach, double absorptivity_par,
     double par_energy_content, double par_energy_fraction,
-    double leaf_transmittance, double leaf_reflectance, double minimum_gbw);
+    double leaf_transmittance, double leaf_reflectance, double minimum_gbw,
+    canopy_warm_start* warm_start = nullptr);
 
 struct Can_Str c3CanAC(
     double LAI, double cosine_zenith_angle, double solarR, double Temp,
@@ -31,7 +33,8 @@ struct Can_Str c3CanAC(
     double electrons_per_carboxylation, double electrons_per_oxygenation,
     double absorptivity_par, double par_energy_content,
     double par_energy_fraction, double leaf_transmittance,
-    double leaf_reflectance, double minimum_gbw, double WindSpeedHeight);
+    double leaf_reflectance, double minimum_gbw, double WindSpeedHeight,
+    canopy_warm_start* warm_start = nullptr);
 
 double resp(double comp, double mrc, double temp);
 
@@ -57,6 +60,8 @@ struct soilML_str soilML(double precipit, double transp, double *cws, double soi
 
 void RHprof(double RH, int nlayers, double* relative_humidity_profile);
 void WINDprof(double WindSpeed, double LAI, int nlayers, double* wind_speed_profile);
+void RHprof_at_depths(double RH, int nlayers, double const* relative_depths, double* relative_humidity_profile);
+void WINDprof_at_depths(double WindSpeed, double LAI, int nlayers, double const* relative_depths, double* wind_speed_profile);
 
 double absorbed_shortwave_from_incident_ppfd(
     double incident_ppfd,        // micromol / m^2 / s
@@ -81,6 +86,29 @@ struct Light_profile sunML(
     double leaf_reflectance       // dimensionless
 );
 
+struct Light_profile sunML_at_depths(
+    double ambient_ppfd_beam,       // micromol / (m^2 beam) / s
+    double ambient_ppfd_diffuse,    // micromol / m^2 / s
+    double lai,                     // dimensionless from m^2 / m^2
+    int nlayers,                    // dimensionless
+    double const* relative_depths,  // dimensionless
+    double cosine_zenith_angle,     // dimensionless
+    double kd,                      // dimensionless
+    double chil,                    // dimensionless from m^2 / m^2
+    double absorptivity,            // dimensionless from mol / mol
+    double heightf,                 // m^-1 from m^2 leaf / m^2 ground / m height
+    double par_energy_content,      // J / micromol
+    double par_energy_fraction,     // dimensionless
+    double leaf_transmittance,      // dimensionless
+    double leaf_reflectance         // dimensionless
+);
+
+void gauss_legendre_canopy_nodes(
+    int nlayers,
+    double* relative_depths,  // dimensionless
+    double* relative_weights  // dimensionless
+);
+
 struct Light_model lightME(double cosine_zenith_angle, double atmospheric_pressure);
 
 struct FL_str FmLcFun(double Lig, double Nit);
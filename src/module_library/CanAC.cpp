@@ -39,8 +39,8 @@ struct Can_Str CanAC(
     double par_energy_fraction,   // dimensionless
     double leaf_transmittance,    // dimensionless
     double leaf_reflectance,      // dimensionless
-    double minimum_gbw            // mol / m^2 / s
-)
+    double minimum_gbw,           // mol / m^2 / s
+    canopy_warm_start* warm_start)
 {
     struct Light_model light_model = lightME(cosine_zenith_angle, atmospheric_pressure);
 
@@ -74,6 +74,14 @@ struct Can_Str CanAC(
     double CanopyPr = 0.0;            // mmol / m^2 / s
     double canopy_conductance = 0.0;  // mmol / m^2 / s
 
+    // Seeds for the iterative leaf solvers. When no warm-start state is
+    // supplied, a fresh set of seeds is used, so every solve starts cold.
+    canopy_warm_start cold_start;
+    canopy_warm_start& seeds = warm_start ? *warm_start : cold_start;
+    if (seeds.size() != static_cast<size_t>(2 * nlayers)) {
+        seeds.assign(2 * nlayers, leaf_warm_start());
+    }
+
     for (int i = 0; i < nlayers; ++i) {
         // Calculations that are the same for sunlit and shaded leaves
         int current_layer = nlayers - 1 - i;
@@ -107,12 +115,14 @@ struct Can_Str CanAC(
         double j_dir = light_profile.sunlit_absorbed_shortwave[current_layer];  // J / m^2 / s
         double pLeafsun = light_profile.sunlit_fraction[current_layer];         // dimensionless. Fraction of LAI that is sunlit.
         double Leafsun = LAIc * pLeafsun;                                       // dimensionless
+        leaf_warm_start& sunlit_seeds = seeds[2 * current_layer];
 
         double direct_stomatal_conductance =
             c4photoC(
                 i_dir, temperature, relative_humidity, vmax1, Alpha, Kparm,
                 theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, water_stress_approach, upperT, lowerT)
+                atmospheric_pressure, water_stress_approach, upperT, lowerT,
+                &sunlit_seeds.ci_at_air_temperature)
                 .Gs;  // mmol / m^2 / s
 
         struct ET_Str et_direct =
@@ -127,7 +137,8 @@ struct Can_Str CanAC(
             c4photoC(
                 i_dir, leaf_temperature_dir, relative_humidity, vmax1, Alpha,
                 Kparm, theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, water_stress_approach, upperT, lowerT);
+                atmospheric_pressure, water_stress_approach, upperT, lowerT,
+                &sunlit_seeds.ci_at_leaf_temperature);
 
         // Calculations for shaded leaves. First, estimate stomatal conductance
         // by assuming the leaf has the same temperature as the air. Then, use
@@ -138,12 +149,14 @@ struct Can_Str CanAC(
         double j_diff = light_profile.shaded_absorbed_shortwave[current_layer];  // J / m^2 / s
         double pLeafshade = light_profile.shaded_fraction[current_layer];        // dimensionless. Fraction of LAI that is shaded.
         double Leafshade = LAIc * pLeafshade;                                    // dimensionless
+        leaf_warm_start& shaded_seeds = seeds[2 * current_layer + 1];
 
         double diffuse_stomatal_conductance =
             c4photoC(
                 i_diff, temperature, relative_humidity, vmax1, Alpha, Kparm,
                 theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, water_stress_approach, upperT, lowerT)
+                atmospheric_pressure, water_stress_approach, upperT, lowerT,
+                &shaded_seeds.ci_at_air_temperature)
                 .Gs;  // mmol / m^2 / s
 
         struct ET_Str et_diffuse =
@@ -158,7 +171,8 @@ struct Can_Str CanAC(
             c4photoC(
                 i_diff, leaf_temperature_diff, relative_humidity, vmax1, Alpha,
                 Kparm, theta, beta, Rd, b0, b1, Gs_min, StomataWS, Catm,
-                atmospheric_pressure, water_stress_approach, upperT, lowerT);
+                atmospheric_pressure, water_stress_approach, upperT, lowerT,
+                &shaded_seeds.ci_at_leaf_temperature);
 
         // Combine sunlit and shaded leaves
         CanopyA += Leafsun * direct_photo.Assim + Leafshade * diffuse_photo.Assim;             // micromol / m^2 / s
@@ -41,8 +41,8 @@ struct Can_Str c3CanAC(
     double leaf_transmittance,           // dimensionless
     double leaf_reflectance,             // dimensionless
     double minimum_gbw,                  // mol / m^2 / s
-    double WindSpeedHeight               // m
-)
+    double WindSpeedHeight,              // m
+    canopy_warm_start* warm_start)
 {
     struct Light_model light_model = lightME(cosine_zenith_angle, atmospheric_pressure);
 
@@ -74,6 +74,14 @@ struct Can_Str c3CanAC(
     double CanopyPr = 0.0;            // mmol / m^2 / s
     double canopy_conductance = 0.0;  // mmol / m^2 / s
 
+    // Seeds for the iterative leaf solvers. When no warm-start state is
+    // supplied, a fresh set of seeds is used, so every solve starts cold.
+    canopy_warm_start cold_start;
+    canopy_warm_start& seeds = warm_start ? *warm_start : cold_start;
+    if (seeds.size() != static_cast<size_t>(2 * nlayers)) {
+        seeds.assign(2 * nlayers, leaf_warm_start());
+    }
+
     for (int i = 0; i < nlayers; ++i) {
         // Calculations that are the same for sunlit and shaded leaves
         int current_layer = nlayers - 1 - i;
@@ -99,13 +107,15 @@ struct Can_Str c3CanAC(
         double i_dir = light_profile.sunlit_incident_ppfd[current_layer];  // micromole / m^2 / s
         double pLeafsun = light_profile.sunlit_fraction[current_layer];    // dimensionless
         double Leafsun = LAIc * pLeafsun;                                  // dimensionless
+        leaf_warm_start& sunlit_seeds = seeds[2 * current_layer];
 
         double direct_stomatal_conductance =
             c3photoC(
                 i_dir, air_temperature, relative_humidity, vmax1, Jmax,
                 tpu_rate_max, Rd, b0, b1, Gs_min, Catm, atmospheric_pressure,
                 o2, theta, StomataWS, water_stress_approach,
-                electrons_per_carboxylation, electrons_per_oxygenation)
+                electrons_per_carboxylation, electrons_per_oxygenation,
+                &sunlit_seeds.ci_at_air_temperature)
                 .Gs;  // mmol / m^2 / s
 
         struct ET_Str et_direct =
@@ -121,7 +131,8 @@ struct Can_Str c3CanAC(
                 i_dir, leaf_temperature_dir, relative_humidity, vmax1, Jmax,
                 tpu_rate_max, Rd, b0, b1, Gs_min, Catm, atmospheric_pressure,
                 o2, theta, StomataWS, water_stress_approach,
-                electrons_per_carboxylation, electrons_per_oxygenation);
+                electrons_per_carboxylation, electrons_per_oxygenation,
+                &sunlit_seeds.ci_at_leaf_temperature);
 
         // Calculations for shaded leaves. First, estimate stomatal conductance
         // by assuming the leaf has the same temperature as the air. Then, use
@@ -131,13 +142,15 @@ struct Can_Str c3CanAC(
         double i_diff = light_profile.shaded_incident_ppfd[current_layer];  // micromole / m^2 /s
         double pLeafshade = light_profile.shaded_fraction[current_layer];   // dimensionless
         double Leafshade = LAIc * pLeafshade;                               // dimensionless
+        leaf_warm_start& shaded_seeds = seeds[2 * current_layer + 1];
 
         double diffuse_stomatal_conductance =
             c3photoC(
                 i_diff, air_temperature, relative_humidity, vmax1, Jmax,
                 tpu_rate_max, Rd, b0, b1, Gs_min, Catm, atmospheric_pressure,
                 o2, theta, StomataWS, water_stress_approach,
-                electrons_per_carboxylation, electrons_per_oxygenation)
+                electrons_per_carboxylation, electrons_per_oxygenation,
+                &shaded_seeds.ci_at_air_temperature)
                 .Gs;  // mmol / m^2 / s
 
         struct ET_Str et_diffuse =
@@ -154,7 +167,7 @@ struct Can_Str c3CanAC(
                 Jmax, tpu_rate_max, Rd, b0, b1, Gs_min, Catm,
                 atmospheric_pressure, o2, theta, StomataWS,
                 water_stress_approach, electrons_per_carboxylation,
-                electrons_per_oxygenation);
+                electrons_per_oxygenation, &shaded_seeds.ci_at_leaf_temperature);
 
         // Combine sunlit and shaded leaves
         CanopyA += Leafsun * direct_photo.Assim + Leafshade * diffuse_photo.Assim;             // micromol / m^2 / s
@@ -68,7 +68,7 @@ void c3_canopy::do_operation() const
         water_stress_approach, electrons_per_carboxylation,
         electrons_per_oxygenation, absorptivity_par, par_energy_content,
         par_energy_fraction, leaf_transmittance, leaf_reflectance, minimum_gbw,
-        windspeed_height);
+        windspeed_height, use_warm_start ? &warm_start : nullptr);
 
     // Update the output quantity list
     update(canopy_assimilation_rate_op, can_result.Assim);   // Mg / ha / hr.
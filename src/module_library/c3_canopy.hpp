@@ -3,14 +3,16 @@
 
 #include "../modules.h"
 #include "../state_map.h"
+#include "leaf_warm_start.h"  // for canopy_warm_start
 
 class c3_canopy : public direct_module
 {
    public:
     c3_canopy(
         state_map const& input_quantities,
-        state_map* output_quantities)
-        : direct_module(),
+        state_map* output_quantities,
+        bool use_warm_start = false)
+        : direct_module(use_warm_start),
 
           // Get references to input quantities
           lai{get_input(input_quantities, "lai")},
@@ -56,12 +58,16 @@ class c3_canopy : public direct_module
           // Get pointers to output quantities
           canopy_assimilation_rate_op{get_op(output_quantities, "canopy_assimilation_rate")},
           canopy_transpiration_rate_op{get_op(output_quantities, "canopy_transpiration_rate")},
-          GrossAssim_op{get_op(output_quantities, "GrossAssim")}
+          GrossAssim_op{get_op(output_quantities, "GrossAssim")},
+
+          use_warm_start{use_warm_start}
     {
     }
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "c3_canopy"; }
+    bool keeps_state() const override { return use_warm_start; }
+    void clear_state() const override { warm_start.clear(); }
 
    private:
     // References to input quantities
@@ -110,6 +116,11 @@ class c3_canopy : public direct_module
     double* canopy_transpiration_rate_op;
     double* GrossAssim_op;
 
+    // Converged values from the previous call, used to warm-start the
+    // iterative leaf solvers in each layer when `use_warm_start` is true
+    bool const use_warm_start;
+    canopy_warm_start mutable warm_start;
+
     // Main operation
     void do_operation() const;
 };
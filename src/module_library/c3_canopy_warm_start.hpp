@@ -0,0 +1,46 @@
+#ifndef C3_CANOPY_WARM_START_H
+#define C3_CANOPY_WARM_START_H
+
+#include "../state_map.h"
+#include "c3_canopy.hpp"
+
+/**
+ * @class c3_canopy_warm_start
+ *
+ * @brief Identical to `c3_canopy`, except that the intercellular CO2 solve for
+ * each leaf class and layer starts from its converged value in the previous
+ * call rather than from the usual initial guess.
+ *
+ * The solves use the same convergence test either way, so the results agree
+ * with `c3_canopy` to within the solver tolerance. However, they depend on the
+ * order in which this module is called; see `canopy_warm_start` for details.
+ * For this reason, it requires an Euler ode_solver.
+ */
+class c3_canopy_warm_start : public c3_canopy
+{
+   public:
+    c3_canopy_warm_start(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : c3_canopy(
+              input_quantities,
+              output_quantities,
+              true)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "c3_canopy_warm_start"; }
+};
+
+string_vector c3_canopy_warm_start::get_inputs()
+{
+    return c3_canopy::get_inputs();
+}
+
+string_vector c3_canopy_warm_start::get_outputs()
+{
+    return c3_canopy::get_outputs();
+}
+
+#endif
@@ -44,7 +44,8 @@ struct c3_str c3photoC(
     double StomWS,
     int water_stress_approach,
     double electrons_per_carboxylation,
-    double electrons_per_oxygenation)
+    double electrons_per_oxygenation,
+    solver_seed* ci_seed)  // Pa
 {
     // Assign units to the input quantities. The parameters can be renamed and
     // this section can be removed when call functions that call c3photoC() are
@@ -94,7 +95,7 @@ struct c3_str c3photoC(
 
     const quantity<pressure> Ca_pa = Ca * 1e-6 * atmospheric_pressure;  // Pa.
 
-    quantity<pressure> Ci_pa = 0.0 * pascal;
+    quantity<pressure> Ci_pa = ((ci_seed && ci_seed->valid) ? ci_seed->value : 0.0) * pascal;
     quantity<flux> Vc;
     quantity<flux> Tol = 0.01 * 1e-6 * mole / square_meter / second;
     quantity<flux> Gs;
@@ -187,11 +188,17 @@ struct c3_str c3photoC(
         ++iterCounter;
     }
 
+    if (ci_seed) {
+        ci_seed->valid = true;
+        ci_seed->value = Ci_pa.value();  // Pa
+    }
+
     struct c3_str result;
     result.Assim = co2_assimilation_rate.value() * 1e6;                      // micromole / m^2 / s.
     result.Gs = Gs.value() * 1e3;                                            // mmol / m^2 / s.
     result.Ci = Ci.value() * 1e6;                                            // micromole / mol.
     result.GrossAssim = (co2_assimilation_rate.value() + Rd.value()) * 1e6;  // micromole / m^2 / s.
+    result.iterations = iterCounter < max_iter ? iterCounter + 1 : max_iter;
     return result;
 }
 
@@ -1,5 +1,8 @@
 #ifndef C3PHOTO_H
 #define C3PHOTO_H
+
+#include "leaf_warm_start.h"  // for solver_seed
+
 /*
  *  /src/c4photo.h by Fernando Ezequiel Miguez  Copyright (C) 2007-2010
  *
@@ -10,12 +13,13 @@ struct c3_str {
     double Gs;
     double Ci;
     double GrossAssim;
-
+    int iterations;
 };
 
 struct c3_str c3photoC(double Qp, double Tleaf, double RH, double Vcmax0, double Jmax0, double tpu_rate_max,
         double Rd0, double bb0, double bb1, double Gs_min, double Ca, double AP, double O2, double theta,
-        double StomWS,int water_stress_approach, double electrons_per_carboxylation, double electrons_per_oxygenation);
+        double StomWS,int water_stress_approach, double electrons_per_carboxylation, double electrons_per_oxygenation,
+        solver_seed* ci_seed = nullptr);
 
 struct c3_str c3photoCdb(double Qp, double Tleaf, double RH, double Vcmax0, double Jmax0, double tpu_rate_max,
         double Rd0, double bb0, double bb1, double Gs_min, double Ca, double AP, double O2, double theta,
@@ -11,8 +11,9 @@ class c4_canopy : public direct_module
    public:
     c4_canopy(
         state_map const& input_quantities,
-        state_map* output_quantities)
-        : direct_module(),
+        state_map* output_quantities,
+        bool use_warm_start = false)
+        : direct_module(use_warm_start),
 
           // Get pointers to input quantities
           nileafn(get_input(input_quantities, "nileafn")),
@@ -67,12 +68,16 @@ class c4_canopy : public direct_module
           canopy_assimilation_rate_op(get_op(output_quantities, "canopy_assimilation_rate")),
           canopy_transpiration_rate_op(get_op(output_quantities, "canopy_transpiration_rate")),
           canopy_conductance_op(get_op(output_quantities, "canopy_conductance")),
-          GrossAssim_op(get_op(output_quantities, "GrossAssim"))
+          GrossAssim_op(get_op(output_quantities, "GrossAssim")),
+
+          use_warm_start(use_warm_start)
     {
     }
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "c4_canopy"; }
+    bool keeps_state() const override { return use_warm_start; }
+    void clear_state() const override { warm_start.clear(); }
 
    private:
     // References to input quantities
@@ -130,6 +135,11 @@ class c4_canopy : public direct_module
     double* canopy_conductance_op;
     double* GrossAssim_op;
 
+    // Converged values from the previous call, used to warm-start the
+    // iterative leaf solvers in each layer when `use_warm_start` is true
+    bool const use_warm_start;
+    canopy_warm_start mutable warm_start;
+
     // Main operation
     void do_operation() const;
 };
@@ -220,7 +230,8 @@ void c4_canopy::do_operation() const
         kpLN, lnfun, upperT, lowerT, nitroP, leafwidth, et_equation, StomataWS,
         specific_heat_of_air, atmospheric_pressure, water_stress_approach,
         absorptivity_par, par_energy_content, par_energy_fraction,
-        leaf_transmittance, leaf_reflectance, minimum_gbw);
+        leaf_transmittance, leaf_reflectance, minimum_gbw,
+        use_warm_start ? &warm_start : nullptr);
 
     // Update the parameter list
     update(canopy_assimilation_rate_op, can_result.Assim);   // Mg / ha / hr.
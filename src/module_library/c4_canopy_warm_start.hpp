@@ -0,0 +1,46 @@
+#ifndef C4_CANOPY_WARM_START_H
+#define C4_CANOPY_WARM_START_H
+
+#include "../state_map.h"
+#include "c4_canopy.hpp"
+
+/**
+ * @class c4_canopy_warm_start
+ *
+ * @brief Identical to `c4_canopy`, except that the intercellular CO2 solve for
+ * each leaf class and layer starts from its converged value in the previous
+ * call rather than from the usual initial guess.
+ *
+ * The solves use the same convergence test either way, so the results agree
+ * with `c4_canopy` to within the solver tolerance. However, they depend on the
+ * order in which this module is called; see `canopy_warm_start` for details.
+ * For this reason, it requires an Euler ode_solver.
+ */
+class c4_canopy_warm_start : public c4_canopy
+{
+   public:
+    c4_canopy_warm_start(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : c4_canopy(
+              input_quantities,
+              output_quantities,
+              true)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "c4_canopy_warm_start"; }
+};
+
+string_vector c4_canopy_warm_start::get_inputs()
+{
+    return c4_canopy::get_inputs();
+}
+
+string_vector c4_canopy_warm_start::get_outputs()
+{
+    return c4_canopy::get_outputs();
+}
+
+#endif
@@ -29,13 +29,14 @@ struct c4_str c4photoC(double Qp,  // micromole / m^2 / s
                        double atmospheric_pressure,  // Pa
                        int water_stress_approach,
                        double upperT,
-                       double lowerT)
+                       double lowerT,
+                       solver_seed* ci_seed)  // Pa
 {
 
     constexpr double k_Q10 = 2;  // dimensionless. Increase in a reaction rate per temperature increase of 10 degrees Celsius.
 
     double Csurface = Ca * 1e-6 * atmospheric_pressure;  // Pa
-    double InterCellularCO2 = Csurface * 0.4;  // Pa. Use an initial guess.
+    double InterCellularCO2 = (ci_seed && ci_seed->valid) ? ci_seed->value : Csurface * 0.4;  // Pa. Use an initial guess.
     double kT = kparm * pow(k_Q10, (leaf_temperature - 25.0) / 10.0);  // dimensionless
 
     // Collatz 1992. Appendix B. Equation set 5B.
@@ -60,11 +61,14 @@ struct c4_str c4photoC(double Qp,  // micromole / m^2 / s
     double M = M1 < M2 ? M1 : M2; // Use the smallest root.
 
     double Assim, Gs;
+    int iterations = 0;
     {
         double OldAssim = 0.0, Tol = 0.1, diff;
         unsigned int iterCounter = 0;
         unsigned int constexpr max_iterations = 50;
         do {
+            ++iterations;
+
             // Collatz 1992. Appendix B. Equation 3B.
             double kT_IC_P = kT * InterCellularCO2 / atmospheric_pressure * 1e6;  // micromole / m^2 / s
             double a = M * kT_IC_P;
@@ -99,13 +103,19 @@ struct c4_str c4photoC(double Qp,  // micromole / m^2 / s
             //Rprintf("Counter %i; Ci %f; Assim %f; Gs %f; leaf_temperature %f\n", iterCounter, InterCellularCO2 / atmospheric_pressure * 1e6, Assim, Gs, leaf_temperature);
     }
 
+    if (ci_seed) {
+        ci_seed->valid = true;
+        ci_seed->value = InterCellularCO2;  // Pa
+    }
+
     double Ci = InterCellularCO2 / atmospheric_pressure * 1e6;  // micromole / mol
 
     struct c4_str result {
             .Assim = Assim,           // micromole / m^2 /s
             .Gs = Gs,                 // mmol / m^2 / s
             .Ci = Ci,                 // micromole / mol
-            .GrossAssim = Assim + RT  // micromole / m^2 / s
+            .GrossAssim = Assim + RT,  // micromole / m^2 / s
+            .iterations = iterations
     };
 
     return result;
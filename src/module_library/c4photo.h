@@ -1,5 +1,8 @@
 #ifndef C4PHOTO_H
 #define C4PHOTO_H
+
+#include "leaf_warm_start.h"  // for solver_seed
+
 /*
  *  /src/c4photo.h by Fernando Ezequiel Miguez  Copyright (C) 2007-2008
  *
@@ -10,12 +13,14 @@ struct c4_str {
     double Gs;
     double Ci;
     double GrossAssim;
+    int iterations;
 };
 
 struct c4_str c4photoC(double Qp, double Tl, double RH, double vmax, double alpha,
         double kparm, double theta, double beta, double Rd, double bb0, double bb1,
         double Gs_min, double StomaWS, double Ca, double atmospheric_pressure,
-        int water_stress_approach, double upperT, double lowerT);
+        int water_stress_approach, double upperT, double lowerT,
+        solver_seed* ci_seed = nullptr);
 
 #endif
 
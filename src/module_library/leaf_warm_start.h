@@ -0,0 +1,57 @@
+#ifndef LEAF_WARM_START_H
+#define LEAF_WARM_START_H
+
+#include <vector>
+
+/**
+ * @brief A starting guess for one of the iterative leaf-level solvers, along
+ * with a flag indicating whether it has been set.
+ *
+ * A solver that receives a pointer to a `solver_seed` starts its iteration
+ * from `value` when `valid` is true, and stores its final value there before
+ * returning so that the next call can start from it. Passing a null pointer
+ * gives the usual cold start.
+ *
+ * A seeded solve uses the same convergence test as a cold start, so the two
+ * agree to within the tolerance of the solver.
+ */
+struct solver_seed {
+    bool valid = false;
+    double value = 0.0;
+};
+
+/**
+ * @brief Warm-start state for one leaf "slot" (one leaf class in one canopy
+ * layer), with one seed for each of the intercellular CO2 solves made by
+ * `CanAC()` and `c3CanAC()` for a leaf.
+ *
+ * The leaf temperature loops in `EvapoTrans2()` and `c3EvapoTrans()` are not
+ * seeded. Their transpiration rates are calculated from the next-to-last
+ * iterate, and the `c3EvapoTrans()` iteration is not a contraction under all
+ * conditions, so a warm start would change their results by more than their
+ * tolerance.
+ */
+struct leaf_warm_start {
+    solver_seed ci_at_air_temperature;   // Pa
+    solver_seed ci_at_leaf_temperature;  // Pa
+};
+
+/**
+ * @brief Warm-start state for all the leaf slots in a canopy; sunlit and
+ * shaded leaves in layer `i` are stored at indices `2 * i` and `2 * i + 1`.
+ *
+ * Warm-starting is off unless it is requested. The `c4_canopy` and
+ * `c3_canopy` modules always start cold; the `c4_canopy_warm_start` and
+ * `c3_canopy_warm_start` modules keep this state between calls. The results of
+ * a warm-started module depend on its previous calls, so the extra calls made
+ * when finding a Jacobian, recording outputs, or probing the effects of a
+ * parameter change can shift its outputs by up to the solver tolerance.
+ *
+ * Finite-difference Jacobians and sensitivities divide such shifts by a tiny
+ * perturbation, so they would be meaningless. For this reason, the
+ * warm-started modules require an Euler ode_solver, and sensitivity runs
+ * refuse any system with a module that keeps state.
+ */
+using canopy_warm_start = std::vector<leaf_warm_start>;
+
+#endif
@@ -1,5 +1,6 @@
 #include <algorithm>  // for std::transform
 #include <cctype>     // for std::tolower
+#include <stdexcept>  // for std::runtime_error
 #include "module_wrapper_factory.h"
 
 // Include all the header files that define the modules.
@@ -13,6 +14,8 @@
 #include "parameter_calculator.hpp"
 #include "c3_canopy.hpp"
 #include "c4_canopy.hpp"
+#include "c3_canopy_warm_start.hpp"
+#include "c4_canopy_warm_start.hpp"
 #include "stomata_water_stress_linear.hpp"
 #include "stomata_water_stress_exponential.hpp"
 #include "stomata_water_stress_linear_aba_response.hpp"
@@ -82,6 +85,7 @@
 #include "leaf_gbw_nikolov.h"
 #include "example_model_mass_gain.h"
 #include "example_model_partitioning.h"
+#include "response_surface_emulator.h"
 
 /**
  * @brief A function that returns a unique_ptr to a module_wrapper_base object.
@@ -97,6 +101,13 @@ std::unique_ptr<module_wrapper_base> module_wrapper_factory::create(std::string
     try {
         return module_wrapper_factory::module_wrapper_creators.at(module_name)();
     } catch (std::out_of_range const&) {
+        std::lock_guard<std::mutex> lock(emulator_mutex);
+        auto const emulator = emulators.find(module_name);
+        if (emulator != emulators.end()) {
+            return std::unique_ptr<module_wrapper_base>(
+                new response_surface_emulator_wrapper(module_name, emulator->second));
+        }
+
         std::string message = std::string("\"") + module_name +
                        std::string("\"") +
                        std::string(" was given as a module name, ") +
@@ -119,6 +130,8 @@ module_wrapper_factory::module_wrapper_creator_map module_wrapper_factory::modul
      {"parameter_calculator",                                  &create_wrapper<parameter_calculator>},
      {"c3_canopy",                                             &create_wrapper<c3_canopy>},
      {"c4_canopy",                                             &create_wrapper<c4_canopy>},
+     {"c3_canopy_warm_start",                                  &create_wrapper<c3_canopy_warm_start>},
+     {"c4_canopy_warm_start",                                  &create_wrapper<c4_canopy_warm_start>},
      {"stomata_water_stress_linear",                           &create_wrapper<stomata_water_stress_linear>},
      {"stomata_water_stress_exponential",                      &create_wrapper<stomata_water_stress_exponential>},
      {"stomata_water_stress_linear_and_aba_response",          &create_wrapper<stomata_water_stress_linear_and_aba_response>},
@@ -165,6 +178,14 @@ module_wrapper_factory::module_wrapper_creator_map module_wrapper_factory::modul
      {"ten_layer_c3_canopy",                                   &create_wrapper<ten_layer_c3_canopy>},
      {"ten_layer_c4_canopy",                                   &create_wrapper<ten_layer_c4_canopy>},
      {"ten_layer_canopy_integrator",                           &create_wrapper<ten_layer_canopy_integrator>},
+     {"gauss_legendre_canopy_properties",                      &create_wrapper<gauss_legendre_canopy_properties>},
+     {"gauss_legendre_c3_canopy",                              &create_wrapper<gauss_legendre_c3_canopy>},
+     {"gauss_legendre_c4_canopy",                              &create_wrapper<gauss_legendre_c4_canopy>},
+     {"gauss_legendre_canopy_integrator",                      &create_wrapper<gauss_legendre_canopy_integrator>},
+     {"adaptive_canopy_properties",                            &create_wrapper<adaptive_canopy_properties>},
+     {"adaptive_c3_canopy",                                    &create_wrapper<adaptive_c3_canopy>},
+     {"adaptive_c4_canopy",                                    &create_wrapper<adaptive_c4_canopy>},
+     {"adaptive_canopy_integrator",                            &create_wrapper<adaptive_canopy_integrator>},
      {"magic_clock",                                           &create_wrapper<magic_clock>},
      {"poincare_clock",                                        &create_wrapper<poincare_clock>},
      {"phase_clock",                                           &create_wrapper<phase_clock>},
@@ -193,6 +214,29 @@ module_wrapper_factory::module_wrapper_creator_map module_wrapper_factory::modul
      {"example_model_partitioning",                            &create_wrapper<example_model_partitioning>},
 };
 
+/**
+ * @brief Makes an emulator that interpolates `table` available under the name
+ * `module_name`, replacing any emulator previously registered with that name.
+ * Modules that were already created from the old table continue to use it.
+ */
+void module_wrapper_factory::register_emulator(
+    std::string const& module_name,
+    std::shared_ptr<response_surface const> table)
+{
+    if (module_wrapper_creators.count(module_name) > 0) {
+        throw std::runtime_error(
+            std::string("\"") + module_name + std::string("\" is the name of ") +
+            std::string("a built-in module, so it cannot be used for an emulator.\n"));
+    }
+
+    std::lock_guard<std::mutex> lock(emulator_mutex);
+    emulators[module_name] = table;
+}
+
+std::mutex module_wrapper_factory::emulator_mutex;
+
+std::map<std::string, std::shared_ptr<response_surface const>> module_wrapper_factory::emulators;
+
 string_vector module_wrapper_factory::get_modules()
 {
     string_vector module_name_vector;
@@ -200,6 +244,13 @@ string_vector module_wrapper_factory::get_modules()
         module_name_vector.push_back(x.first);
     }
 
+    {
+        std::lock_guard<std::mutex> lock(emulator_mutex);
+        for (auto const& x : emulators) {
+            module_name_vector.push_back(x.first);
+        }
+    }
+
     auto case_insensitive_compare = [](std::string const& a, std::string const& b) {
         // Make a lowercase copy of a
         std::string al = a;
@@ -4,9 +4,12 @@
 #include <memory>  // for unique_ptr
 #include <string>
 #include <map>
+#include <mutex>
 #include <unordered_map>
 #include "../module_wrapper.h"
 
+class response_surface;
+
 class module_wrapper_factory
 {
    public:
@@ -14,10 +17,18 @@ class module_wrapper_factory
     static string_vector get_modules();
     static std::unordered_map<std::string, string_vector> get_all_quantities();
 
+    // For adding emulators that interpolate tables made at run time
+    static void register_emulator(
+        std::string const& module_name,
+        std::shared_ptr<response_surface const> table);
+
    private:
     using module_wrapper_creator = std::unique_ptr<module_wrapper_base> (*)();
     using module_wrapper_creator_map = std::map<std::string, module_wrapper_creator>;
     static module_wrapper_creator_map module_wrapper_creators;
+
+    static std::mutex emulator_mutex;
+    static std::map<std::string, std::shared_ptr<response_surface const>> emulators;
 };
 
 #endif
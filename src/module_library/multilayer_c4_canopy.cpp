@@ -1,21 +1,15 @@
 #include "multilayer_c4_canopy.h"
 
-int const ten_layer_c4_canopy::nlayers = 10;  // Set the number of layers
-
 string_vector ten_layer_c4_canopy::get_inputs()
 {
-    // Just call the parent class's input function with the appropriate number
-    // of layers
-    return ten_layer_c4_canopy_parent::generate_inputs(
-        ten_layer_c4_canopy::nlayers);
+    // Just call the parent class's input function
+    return ten_layer_c4_canopy_parent::generate_inputs();
 }
 
 string_vector ten_layer_c4_canopy::get_outputs()
 {
-    // Just call the parent class's output function with the appropriate number
-    // of layers
-    return ten_layer_c4_canopy_parent::generate_outputs(
-        ten_layer_c4_canopy::nlayers);
+    // Just call the parent class's output function
+    return ten_layer_c4_canopy_parent::generate_outputs();
 }
 
 void ten_layer_c4_canopy::do_operation() const
@@ -23,3 +17,33 @@ void ten_layer_c4_canopy::do_operation() const
     // Just call the parent class's run operation
     ten_layer_c4_canopy_parent::run();
 }
+
+string_vector gauss_legendre_c4_canopy::get_inputs()
+{
+    return gauss_legendre_c4_canopy_parent::generate_inputs();
+}
+
+string_vector gauss_legendre_c4_canopy::get_outputs()
+{
+    return gauss_legendre_c4_canopy_parent::generate_outputs();
+}
+
+void gauss_legendre_c4_canopy::do_operation() const
+{
+    gauss_legendre_c4_canopy_parent::run();
+}
+
+string_vector adaptive_c4_canopy::get_inputs()
+{
+    return adaptive_c4_canopy_parent::generate_inputs(true);
+}
+
+string_vector adaptive_c4_canopy::get_outputs()
+{
+    return adaptive_c4_canopy_parent::generate_outputs();
+}
+
+void adaptive_c4_canopy::do_operation() const
+{
+    adaptive_c4_canopy_parent::run();
+}
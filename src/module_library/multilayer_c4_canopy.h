@@ -10,7 +10,8 @@
 using ten_layer_c4_canopy_parent =
     multilayer_canopy_photosynthesis<
         ten_layer_canopy_properties,
-        c4_leaf_photosynthesis>;
+        c4_leaf_photosynthesis,
+        ten_layer_canopy_properties::nlayers>;
 
 /**
  * @class ten_layer_c4_canopy
@@ -38,7 +39,6 @@ class ten_layer_c4_canopy : public ten_layer_c4_canopy_parent
         state_map const& input_quantities,
         state_map* output_quantities)
         : ten_layer_c4_canopy_parent(
-              ten_layer_c4_canopy::nlayers,
               input_quantities,
               output_quantities)
     {
@@ -48,9 +48,85 @@ class ten_layer_c4_canopy : public ten_layer_c4_canopy_parent
     static std::string get_name() { return "ten_layer_c4_canopy"; }
 
    private:
-    // Number of layers
-    int static const nlayers;
+    // Main operation
+    void do_operation() const;
+};
+
+using gauss_legendre_c4_canopy_parent =
+    multilayer_canopy_photosynthesis<
+        gauss_legendre_canopy_properties,
+        c4_leaf_photosynthesis,
+        gauss_legendre_canopy_properties::nlayers>;
+
+/**
+ * @class gauss_legendre_c4_canopy
+ *
+ * @brief Represents a canopy whose layers are placed at the nodes of a
+ * Gauss-Legendre quadrature rule, where leaf-level photosynthesis is calculated
+ * using the Collatz et al. model for C4 photosynthesis; see the
+ * `c4_leaf_photosynthesis` class for more information about this model.
+ *
+ * This is a child class of `multilayer_canopy_photosynthesis` where the canopy
+ * module is set to the `gauss_legendre_canopy_properties` module, the leaf
+ * module is set to the `c4_leaf_photosynthesis` module, and the number of
+ * layers is the number of quadrature nodes used by the canopy module. Its
+ * outputs should be combined using the `gauss_legendre_canopy_integrator`
+ * module.
+ */
+class gauss_legendre_c4_canopy : public gauss_legendre_c4_canopy_parent
+{
+   public:
+    gauss_legendre_c4_canopy(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : gauss_legendre_c4_canopy_parent(
+              input_quantities,
+              output_quantities)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "gauss_legendre_c4_canopy"; }
 
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
+using adaptive_c4_canopy_parent =
+    multilayer_canopy_photosynthesis<
+        adaptive_canopy_properties,
+        c4_leaf_photosynthesis,
+        adaptive_canopy_properties::nlayers>;
+
+/**
+ * @class adaptive_c4_canopy
+ *
+ * @brief Represents a canopy whose number of layers is chosen by the
+ * `adaptive_canopy_properties` module each time it runs, where leaf-level
+ * photosynthesis is calculated using the Collatz et al. model for C4 photosynthesis.
+ *
+ * Leaf photosynthesis is only calculated for the active layers, and the outputs
+ * for the other layers are set to zero. Its outputs should be combined using
+ * the `adaptive_canopy_integrator` module.
+ */
+class adaptive_c4_canopy : public adaptive_c4_canopy_parent
+{
+   public:
+    adaptive_c4_canopy(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : adaptive_c4_canopy_parent(
+              input_quantities,
+              output_quantities,
+              true)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "adaptive_c4_canopy"; }
+
+   private:
     // Main operation
     void do_operation() const;
 };
@@ -4,7 +4,9 @@
 #include "../state_map.h"
 #include "../modules.h"
 #include "../state_map.h"
-#include "../constants.h"  // for molar_mass_of_water, molar_mass_of_glucose
+#include "../constants.h"                  // for molar_mass_of_water, molar_mass_of_glucose
+#include "BioCro.h"                        // for gauss_legendre_canopy_nodes
+#include "multilayer_canopy_properties.h"  // for gauss_legendre_canopy_properties, adaptive_canopy_properties
 
 /**
  * @class multilayer_canopy_integrator
@@ -14,6 +16,13 @@
  * canopy layer, weighted by the relative fractions of sunlit and shaded leaves
  * in each layer.
  *
+ * By default, each layer is assumed to contain an equal fraction of the
+ * canopy's leaf area. If the layers are placed at the nodes of a Gauss-Legendre
+ * quadrature rule, the values from each layer are instead weighted by the
+ * corresponding quadrature weights. If the number of active layers can change,
+ * it is read from the `nlayers_active` input quantity and only the active
+ * layers are included, using the weights of the rule with that many nodes.
+ *
  * For more information about how multilayer modules work in BioCro, see the
  * documentation for the `multilayer_canopy_properties` and
  * `multilayer_canopy_photosynthesis` modules.
@@ -24,11 +33,15 @@ class multilayer_canopy_integrator : public direct_module
     multilayer_canopy_integrator(
         int const& nlayers,
         state_map const& input_quantities,
-        state_map* output_quantities)
+        state_map* output_quantities,
+        bool use_gauss_legendre_nodes = false,
+        bool use_active_layer_count = false)
         : direct_module(),
 
-          // Store the number of layers
+          // Store the number of layers and their weights
           nlayers(nlayers),
+          use_gauss_legendre_nodes(use_gauss_legendre_nodes),
+          relative_weights_by_count(nlayers),
 
           // Get pointers to input quantities
           sunlit_fraction_ips{get_multilayer_ip(input_quantities, nlayers, "sunlit_fraction")},
@@ -43,6 +56,7 @@ class multilayer_canopy_integrator : public direct_module
           shaded_TransR_ips{get_multilayer_ip(input_quantities, nlayers, "shaded_TransR")},
 
           // Get references to input quantities
+          nlayers_active_ip{use_active_layer_count ? get_ip(input_quantities, "nlayers_active") : nullptr},
           lai{get_input(input_quantities, "lai")},
           growth_respiration_fraction{get_input(input_quantities, "growth_respiration_fraction")},
 
@@ -52,11 +66,20 @@ class multilayer_canopy_integrator : public direct_module
           canopy_conductance_op{get_op(output_quantities, "canopy_conductance")},
           GrossAssim_op{get_op(output_quantities, "GrossAssim")}
     {
+        if (use_gauss_legendre_nodes) {
+            for (int n = 1; n <= nlayers; ++n) {
+                std::vector<double> relative_depths(n);
+                relative_weights_by_count[n - 1].resize(n);
+                gauss_legendre_canopy_nodes(n, relative_depths.data(), relative_weights_by_count[n - 1].data());
+            }
+        }
     }
 
    private:
-    // Number of layers
+    // Number of layers and their weights
     int const nlayers;
+    bool const use_gauss_legendre_nodes;
+    std::vector<std::vector<double>> relative_weights_by_count;
 
     // Pointers to input quantities
     std::vector<double const*> const sunlit_fraction_ips;
@@ -70,6 +93,10 @@ class multilayer_canopy_integrator : public direct_module
     std::vector<double const*> const shaded_Gs_ips;
     std::vector<double const*> const shaded_TransR_ips;
 
+    // Pointer to the number of active layers, or nullptr if all layers are
+    // always active
+    double const* nlayers_active_ip;
+
     // References to input quantities
     double const& lai;
     double const& growth_respiration_fraction;
@@ -87,7 +114,7 @@ class multilayer_canopy_integrator : public direct_module
     void run() const;
 
    public:
-    static string_vector get_inputs(int nlayers);
+    static string_vector get_inputs(int nlayers, bool use_active_layer_count = false);
     static string_vector get_outputs(int nlayers);
 };
 
@@ -95,7 +122,7 @@ class multilayer_canopy_integrator : public direct_module
  * @brief Define all inputs required by the module, adding layer suffixes as
  * required
  */
-string_vector multilayer_canopy_integrator::get_inputs(int nlayers)
+string_vector multilayer_canopy_integrator::get_inputs(int nlayers, bool use_active_layer_count)
 {
     // Define the multilayer inputs
     string_vector multilayer_inputs = {
@@ -118,6 +145,10 @@ string_vector multilayer_canopy_integrator::get_inputs(int nlayers)
     all_inputs.push_back("lai");                          // dimensionless from m^2 / m^2
     all_inputs.push_back("growth_respiration_fraction");  // dimensionless
 
+    if (use_active_layer_count) {
+        all_inputs.push_back("nlayers_active");  // dimensionless
+    }
+
     return all_inputs;
 }
 
@@ -142,6 +173,8 @@ void multilayer_canopy_integrator::do_operation() const
 void multilayer_canopy_integrator::run() const
 {
     double const LAIc = lai / nlayers;
+    int const nlayers_active =
+        nlayers_active_ip ? static_cast<int>(*nlayers_active_ip) : nlayers;
     double canopy_assimilation_rate = 0;
     double canopy_transpiration_rate = 0;
     double canopy_conductance = 0;
@@ -149,9 +182,12 @@ void multilayer_canopy_integrator::run() const
 
     // Integrate assimilation, transpiration, and conductance throughout the
     // canopy
-    for (int i = 0; i < nlayers; ++i) {
-        double const sunlit_lai = *sunlit_fraction_ips[i] * LAIc;
-        double const shaded_lai = *shaded_fraction_ips[i] * LAIc;
+    for (int i = 0; i < nlayers_active; ++i) {
+        double const layer_lai = use_gauss_legendre_nodes
+                                     ? lai * relative_weights_by_count[nlayers_active - 1][i]
+                                     : LAIc;
+        double const sunlit_lai = *sunlit_fraction_ips[i] * layer_lai;
+        double const shaded_lai = *shaded_fraction_ips[i] * layer_lai;
 
         canopy_assimilation_rate += *sunlit_Assim_ips[i] * sunlit_lai +
                                     *shaded_Assim_ips[i] * shaded_lai;
@@ -255,4 +291,108 @@ void ten_layer_canopy_integrator::do_operation() const
     multilayer_canopy_integrator::run();
 }
 
+/////////////////////////////////////////////
+// GAUSS-LEGENDRE CANOPY INTEGRATOR MODULE //
+/////////////////////////////////////////////
+
+/**
+ * @class gauss_legendre_canopy_integrator
+ *
+ * @brief A child class of multilayer_canopy_integrator that uses the same
+ * Gauss-Legendre quadrature nodes as the `gauss_legendre_canopy_properties`
+ * module. Instances of this class can be created using the module factory,
+ * unlike the parent class `multilayer_canopy_integrator`.
+ */
+class gauss_legendre_canopy_integrator : public multilayer_canopy_integrator
+{
+   public:
+    gauss_legendre_canopy_integrator(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : multilayer_canopy_integrator(
+              gauss_legendre_canopy_properties::nlayers,
+              input_quantities,
+              output_quantities,
+              true)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "gauss_legendre_canopy_integrator"; }
+
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
+string_vector gauss_legendre_canopy_integrator::get_inputs()
+{
+    return multilayer_canopy_integrator::get_inputs(
+        gauss_legendre_canopy_properties::nlayers);
+}
+
+string_vector gauss_legendre_canopy_integrator::get_outputs()
+{
+    return multilayer_canopy_integrator::get_outputs(
+        gauss_legendre_canopy_properties::nlayers);
+}
+
+void gauss_legendre_canopy_integrator::do_operation() const
+{
+    multilayer_canopy_integrator::run();
+}
+
+///////////////////////////////////////
+// ADAPTIVE CANOPY INTEGRATOR MODULE //
+///////////////////////////////////////
+
+/**
+ * @class adaptive_canopy_integrator
+ *
+ * @brief A child class of multilayer_canopy_integrator that only includes the
+ * layers that are active according to the `adaptive_canopy_properties` module,
+ * weighting them by the matching Gauss-Legendre quadrature weights. Instances
+ * of this class can be created using the module factory, unlike the parent
+ * class `multilayer_canopy_integrator`.
+ */
+class adaptive_canopy_integrator : public multilayer_canopy_integrator
+{
+   public:
+    adaptive_canopy_integrator(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : multilayer_canopy_integrator(
+              adaptive_canopy_properties::nlayers,
+              input_quantities,
+              output_quantities,
+              true,
+              true)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "adaptive_canopy_integrator"; }
+
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
+string_vector adaptive_canopy_integrator::get_inputs()
+{
+    return multilayer_canopy_integrator::get_inputs(
+        adaptive_canopy_properties::nlayers, true);
+}
+
+string_vector adaptive_canopy_integrator::get_outputs()
+{
+    return multilayer_canopy_integrator::get_outputs(
+        adaptive_canopy_properties::nlayers);
+}
+
+void adaptive_canopy_integrator::do_operation() const
+{
+    multilayer_canopy_integrator::run();
+}
+
 #endif
@@ -2,6 +2,8 @@
 #define MULTILAYER_CANOPY_PHOTOSYNTHESIS_H
 
 #include <algorithm>  // for std::find
+#include <array>
+#include <memory>     // for std::unique_ptr
 #include "../modules.h"
 #include "../state_map.h"
 
@@ -102,7 +104,7 @@ string_vector get_other_leaf_inputs()
  *
  * ### Basic overview
  *
- * Two modules must be specified as template arguments:
+ * Two modules and a number of layers must be specified as template arguments:
  *
  *  - canopy properties module: a module that calculates properties for each
  *    canopy layer and leaf class
@@ -110,6 +112,9 @@ string_vector get_other_leaf_inputs()
  *  - leaf photosynthesis module: a module that determines assimilation values
  *    (among other values)
  *
+ *  - number of layers: the number of layers produced by the canopy properties
+ *    module
+ *
  * The canopy properties module must have the following public static methods:
  *
  *  - define_leaf_classes()
@@ -146,52 +151,84 @@ string_vector get_other_leaf_inputs()
  * base name (e.g. `incident_par`), a prefix that indicates the leaf class (e.g.
  * `sunlit_`), and a suffix that indicates the layer number (e.g. `_layer_0`).
  *
+ * A separate instance of the leaf photosynthesis module is used for each
+ * combination of leaf class and layer. The leaf modules in the library do not
+ * keep any state between calls, so this does not change the results; a leaf
+ * module that does keep state only sees the calls for its own leaf class and
+ * layer.
+ *
+ * The number of layers is a template argument, so the leaf modules and the
+ * blocks of pointers used to pass their inputs and outputs can be stored in
+ * arrays of fixed size, and the loop over layers can be unrolled by the
+ * compiler. All of the leaf modules read from the same map of input
+ * quantities, so the inputs that do not change with leaf class or layer are
+ * copied into it just once each time this module runs. The sources of the
+ * remaining inputs are stored in one contiguous block for each leaf class and
+ * layer, which are copied in turn before the corresponding leaf module runs.
+ *
+ * If `use_active_layer_count` is true, the number of layers that are actually
+ * evaluated is read from the `nlayers_active` input quantity each time the
+ * module runs, as for a canopy properties module whose number of layers
+ * changes with conditions in the canopy. Leaf outputs for the remaining layers
+ * are set to zero.
+ *
  * Note that this module has a non-standard constructor, so it cannot be created
  * using the module_wrapper_factory. Rather, it is expected that directly-usable
  * classes will be derived from this class.
  */
-template <typename canopy_module_type, typename leaf_module_type>
+template <typename canopy_module_type, typename leaf_module_type, int nlayers>
 class multilayer_canopy_photosynthesis : public direct_module
 {
    public:
     multilayer_canopy_photosynthesis(
-        const int& nlayers,
         state_map const& input_quantities,
-        state_map* output_quantities);
+        state_map* output_quantities,
+        bool use_active_layer_count = false);
 
    private:
-    // Number of layers
-    const int nlayers;
+    // Pointer to the number of active layers, or nullptr if all layers are
+    // always active
+    const double* nlayers_active_ip;
 
-    // Leaf photosynthesis module
+    // Quantities shared by all of the leaf modules
     state_map leaf_module_quantities;
     state_map leaf_module_output_map;
-    std::unique_ptr<module_base> leaf_module;
 
-    // Pointers to input parameters
-    std::vector<std::vector<std::pair<double*, const double*>>> leaf_input_ptr_pairs;
+    // Leaf photosynthesis modules, one for each layer of each leaf class
+    std::vector<std::array<std::unique_ptr<module_base>, nlayers>> leaf_modules;
 
-    // Pointers to output parameters
-    std::vector<std::vector<std::pair<double*, const double*>>> leaf_output_ptr_pairs;
+    // Pointers for passing inputs that do not change with leaf class or layer
+    std::vector<double*> constant_input_destinations;
+    std::vector<const double*> constant_input_sources;
+
+    // Pointers for passing inputs that change with leaf class or layer; the
+    // sources are stored in one block for each leaf class and layer
+    std::vector<double*> layered_input_destinations;
+    std::vector<const double*> layered_input_sources;
+
+    // Pointers for passing outputs; the destinations are stored in one block
+    // for each leaf class and layer
+    std::vector<const double*> leaf_output_sources;
+    std::vector<double*> leaf_output_destinations;
 
    protected:
-    static string_vector generate_inputs(int nlayers);
-    static string_vector generate_outputs(int nlayers);
+    static string_vector generate_inputs(bool use_active_layer_count = false);
+    static string_vector generate_outputs();
     void run() const;
 };
 
 /**
  * @brief Constructor for a multilayer canopy photosynthesis module, which
- * initializes the leaf module and prepares to pass inputs to it from the canopy
+ * initializes the leaf modules and prepares to pass inputs to it from the canopy
  * module.
  */
-template <typename canopy_module_type, typename leaf_module_type>
-multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::multilayer_canopy_photosynthesis(
-    const int& nlayers,
+template <typename canopy_module_type, typename leaf_module_type, int nlayers>
+multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type, nlayers>::multilayer_canopy_photosynthesis(
     state_map const& input_quantities,
-    state_map* output_quantities)
+    state_map* output_quantities,
+    bool use_active_layer_count)
     : direct_module(),
-      nlayers(nlayers)
+      nlayers_active_ip(use_active_layer_count ? get_ip(input_quantities, "nlayers_active") : nullptr)
 {
     // Define a lambda for making quantity maps from vectors of inputs and outputs
     auto make_quantity_map = [](string_vector input_names, string_vector output_names) -> state_map {
@@ -212,12 +249,6 @@ multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::multilay
 
     leaf_module_output_map = leaf_module_quantities;
 
-    // Create the leaf photosynthesis module
-    leaf_module =
-        std::unique_ptr<module_base>(new leaf_module_type(
-            leaf_module_quantities,
-            &leaf_module_output_map));
-
     // Find subsets of the leaf model's inputs
     string_vector multiclass_multilayer_leaf_inputs =
         MLCP::get_multiclass_multilayer_leaf_inputs<canopy_module_type, leaf_module_type>();
@@ -228,70 +259,66 @@ multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::multilay
     string_vector other_leaf_inputs =
         MLCP::get_other_leaf_inputs<canopy_module_type, leaf_module_type>();
 
-    // Create vectors of pointer pairs which will be used for passing inputs to
-    // and getting outputs from the leaf module
+    string_vector leaf_outputs = leaf_module_type::get_outputs();
+
+    // Get pointers to the quantities shared by all of the leaf modules
+    for (std::string const& name : other_leaf_inputs) {
+        constant_input_destinations.push_back(get_op(&leaf_module_quantities, name));
+        constant_input_sources.push_back(get_ip(input_quantities, name));
+    }
+
+    for (string_vector const& sv : {multiclass_multilayer_leaf_inputs, multilayer_leaf_inputs}) {
+        for (std::string const& name : sv) {
+            layered_input_destinations.push_back(get_op(&leaf_module_quantities, name));
+        }
+    }
+
+    for (std::string const& name : leaf_outputs) {
+        leaf_output_sources.push_back(get_ip(leaf_module_output_map, name));
+    }
+
+    // Create the leaf modules and the blocks of pointers for each leaf class
+    // and layer
     for (std::string const& class_name : canopy_module_type::define_leaf_classes()) {
+        leaf_modules.emplace_back();
+
         for (int i = 0; i < nlayers; ++i) {
-            // Get pointer pairs for the leaf module inputs and store them
-            std::vector<std::pair<double*, const double*>> input_ptr_pairs;
+            // Create a leaf photosynthesis module for this leaf class and layer
+            leaf_modules.back()[i] =
+                std::unique_ptr<module_base>(new leaf_module_type(
+                    leaf_module_quantities,
+                    &leaf_module_output_map));
 
+            // Get pointers to the sources of the layered inputs
             for (std::string const& name : multiclass_multilayer_leaf_inputs) {
-                std::string specific_name =
+                layered_input_sources.push_back(get_ip(
+                    input_quantities,
                     add_class_prefix_to_quantity_name(
                         class_name,
-                        add_layer_suffix_to_quantity_name(nlayers, i, name));
-
-                std::pair<double*, const double*> temporary(
-                    get_op(&leaf_module_quantities, name),
-                    get_ip(input_quantities, specific_name));
-
-                input_ptr_pairs.push_back(temporary);
+                        add_layer_suffix_to_quantity_name(nlayers, i, name))));
             }
 
             for (std::string const& name : multilayer_leaf_inputs) {
-                std::string specific_name =
-                    add_layer_suffix_to_quantity_name(nlayers, i, name);
-
-                std::pair<double*, const double*> temporary(
-                    get_op(&leaf_module_quantities, name),
-                    get_ip(input_quantities, specific_name));
-
-                input_ptr_pairs.push_back(temporary);
-            }
-
-            for (std::string const& name : other_leaf_inputs) {
-                std::pair<double*, const double*> temporary(
-                    get_op(&leaf_module_quantities, name),
-                    get_ip(input_quantities, name));
-
-                input_ptr_pairs.push_back(temporary);
+                layered_input_sources.push_back(get_ip(
+                    input_quantities,
+                    add_layer_suffix_to_quantity_name(nlayers, i, name)));
             }
 
-            leaf_input_ptr_pairs.push_back(input_ptr_pairs);
-
-            // Get pointer pairs to the leaf module outputs and store them
-            std::vector<std::pair<double*, const double*>> output_ptr_pairs;
-
-            for (std::string const& name : leaf_module_type::get_outputs()) {
-                std::string specific_name =
+            // Get pointers to the destinations of the leaf module outputs
+            for (std::string const& name : leaf_outputs) {
+                leaf_output_destinations.push_back(get_op(
+                    output_quantities,
                     add_class_prefix_to_quantity_name(
                         class_name,
-                        add_layer_suffix_to_quantity_name(nlayers, i, name));
-
-                std::pair<double*, const double*> temporary(
-                    get_op(output_quantities, specific_name),
-                    get_ip(leaf_module_output_map, name));
-
-                output_ptr_pairs.push_back(temporary);
+                        add_layer_suffix_to_quantity_name(nlayers, i, name))));
             }
-
-            leaf_output_ptr_pairs.push_back(output_ptr_pairs);
         }
     }
 }
 
-template <typename canopy_module_type, typename leaf_module_type>
-string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::generate_inputs(int nlayers)
+template <typename canopy_module_type, typename leaf_module_type, int nlayers>
+string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type, nlayers>::generate_inputs(
+    bool use_active_layer_count)
 {
     // Find subsets of the leaf model's inputs
     string_vector multiclass_multilayer_leaf_inputs =
@@ -318,11 +345,15 @@ string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_t
         inputs.push_back(name);
     }
 
+    if (use_active_layer_count) {
+        inputs.push_back("nlayers_active");  // dimensionless
+    }
+
     return inputs;
 }
 
-template <typename canopy_module_type, typename leaf_module_type>
-string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::generate_outputs(int nlayers)
+template <typename canopy_module_type, typename leaf_module_type, int nlayers>
+string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type, nlayers>::generate_outputs()
 {
     // Just add prefixes and suffixes to the leaf module outputs
     return generate_multilayer_quantity_names(
@@ -332,22 +363,49 @@ string_vector multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_t
             leaf_module_type::get_outputs()));
 }
 
-template <typename canopy_module_type, typename leaf_module_type>
-void multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type>::run() const
+template <typename canopy_module_type, typename leaf_module_type, int nlayers>
+void multilayer_canopy_photosynthesis<canopy_module_type, leaf_module_type, nlayers>::run() const
 {
-    // For each combination of leaf class and layer number:
-    for (size_t i = 0; i < leaf_input_ptr_pairs.size(); ++i) {
-        // Update the inputs to the leaf module
-        for (auto const& x : leaf_input_ptr_pairs[i]) {
-            *x.first = *x.second;
-        }
+    const int nlayers_active =
+        nlayers_active_ip ? static_cast<int>(*nlayers_active_ip) : nlayers;
+
+    const size_t n_constant = constant_input_sources.size();
+    const size_t n_layered = layered_input_destinations.size();
+    const size_t n_outputs = leaf_output_sources.size();
 
-        // Run the leaf module
-        leaf_module->run();
+    // Update the inputs that are the same for all leaf modules
+    for (size_t j = 0; j < n_constant; ++j) {
+        *constant_input_destinations[j] = *constant_input_sources[j];
+    }
+
+    const double* const* input_block = layered_input_sources.data();
+    double* const* output_block = leaf_output_destinations.data();
+
+    // For each combination of leaf class and layer number:
+    for (auto const& class_modules : leaf_modules) {
+        for (int i = 0; i < nlayers; ++i) {
+            if (i < nlayers_active) {
+                // Update the inputs to the leaf module
+                for (size_t j = 0; j < n_layered; ++j) {
+                    *layered_input_destinations[j] = *input_block[j];
+                }
+
+                // Run the leaf module
+                class_modules[i]->run();
+
+                // Update the outputs from the leaf module
+                for (size_t j = 0; j < n_outputs; ++j) {
+                    *output_block[j] = *leaf_output_sources[j];
+                }
+            } else {
+                // Clear the outputs for inactive layers
+                for (size_t j = 0; j < n_outputs; ++j) {
+                    *output_block[j] = 0.0;
+                }
+            }
 
-        // Update the outputs from the leaf module
-        for (auto const& x : leaf_output_ptr_pairs[i]) {
-            *x.first = *x.second;
+            input_block += n_layered;
+            output_block += n_outputs;
         }
     }
 }
@@ -1,6 +1,8 @@
+#include <algorithm>  // for std::max
+#include <cmath>      // for exp, acos, sqrt, tan, pow
 #include "multilayer_canopy_properties.h"
 #include "BioCro.h"     // for sunML, RHprof, WINDprof
-#include "AuxBioCro.h"  // for LNprof
+#include "AuxBioCro.h"  // for LNprof, MAXLAY
 
 /**
  * @brief Define all inputs required by the module
@@ -92,38 +94,70 @@ string_vector multilayer_canopy_properties::get_outputs(int nlayers)
 }
 
 void multilayer_canopy_properties::run() const
+{
+    multilayer_canopy_properties::run(nlayers, relative_depths.data());
+}
+
+/**
+ * @brief Calculates properties for the first `nlayers_active` layers, which are
+ * located at `layer_depths` when Gauss-Legendre nodes are used; the outputs for
+ * any other layers are set to zero
+ */
+void multilayer_canopy_properties::run(
+    int nlayers_active,
+    double const* layer_depths) const
 {
     // Calculate values of incident photosynthetically active photon flux
     // density (PPFD) and absorbed shortwave energy throughout the canopy. Note
     // that the `sunML` function expects input expects PPFD values, so we must
     // convert photosynthetically active radiation (PAR) to PPFD using the
     // energy content of light in the PAR band
-    struct Light_profile light_profile = sunML(
-        par_incident_direct / par_energy_content,   // micromol / (m^2 beam) / s
-        par_incident_diffuse / par_energy_content,  // micromol / m^2 / s
-        lai,
-        nlayers,
-        cosine_zenith_angle,
-        kd,
-        chil,
-        absorptivity_par,
-        heightf,
-        par_energy_content,
-        par_energy_fraction,
-        leaf_transmittance,
-        leaf_reflectance);
-
-    // Calculate relative humidity levels throughout the canopy
-    double relative_humidity_profile[nlayers];
-    RHprof(rh, nlayers, relative_humidity_profile);  // Modifies relative_humidity_profile
-
-    // Calculate windspeed throughout the canopy
-    double wind_speed_profile[nlayers];
-    WINDprof(windspeed, lai, nlayers, wind_speed_profile);  // Modifies wind_speed_profile
-
-    // Calculate leaf nitrogen throughout the canopy
-    double leafN_profile[nlayers];
-    LNprof(LeafN, lai, nlayers, kpLN, leafN_profile);  // Modifies leafN_profile
+    struct Light_profile light_profile = use_gauss_legendre_nodes
+        ? sunML_at_depths(
+              par_incident_direct / par_energy_content,   // micromol / (m^2 beam) / s
+              par_incident_diffuse / par_energy_content,  // micromol / m^2 / s
+              lai,
+              nlayers_active,
+              layer_depths,
+              cosine_zenith_angle,
+              kd,
+              chil,
+              absorptivity_par,
+              heightf,
+              par_energy_content,
+              par_energy_fraction,
+              leaf_transmittance,
+              leaf_reflectance)
+        : sunML(
+              par_incident_direct / par_energy_content,   // micromol / (m^2 beam) / s
+              par_incident_diffuse / par_energy_content,  // micromol / m^2 / s
+              lai,
+              nlayers,
+              cosine_zenith_angle,
+              kd,
+              chil,
+              absorptivity_par,
+              heightf,
+              par_energy_content,
+              par_energy_fraction,
+              leaf_transmittance,
+              leaf_reflectance);
+
+    // Calculate relative humidity levels, windspeed, and leaf nitrogen
+    // throughout the canopy
+    double relative_humidity_profile[MAXLAY];
+    double wind_speed_profile[MAXLAY];
+    double leafN_profile[MAXLAY];
+
+    if (use_gauss_legendre_nodes) {
+        RHprof_at_depths(rh, nlayers_active, layer_depths, relative_humidity_profile);
+        WINDprof_at_depths(windspeed, lai, nlayers_active, layer_depths, wind_speed_profile);
+        LNprof_at_depths(LeafN, lai, nlayers_active, kpLN, layer_depths, leafN_profile);
+    } else {
+        RHprof(rh, nlayers, relative_humidity_profile);          // Modifies relative_humidity_profile
+        WINDprof(windspeed, lai, nlayers, wind_speed_profile);  // Modifies wind_speed_profile
+        LNprof(LeafN, lai, nlayers, kpLN, leafN_profile);       // Modifies leafN_profile
+    }
 
     // Don't calculate anything based on the nitrogen profile
     if (lnfun != 0) {
@@ -131,7 +165,7 @@ void multilayer_canopy_properties::run() const
     }
 
     // Update layer-dependent outputs
-    for (int i = 0; i < nlayers; ++i) {
+    for (int i = 0; i < nlayers_active; ++i) {
         update(sunlit_fraction_ops[i], light_profile.sunlit_fraction[i]);
         update(sunlit_incident_ppfd_ops[i], light_profile.sunlit_incident_ppfd[i]);
         update(sunlit_absorbed_shortwave_ops[i], light_profile.sunlit_absorbed_shortwave[i]);
@@ -149,13 +183,32 @@ void multilayer_canopy_properties::run() const
         update(windspeed_ops[i], wind_speed_profile[i]);
         update(LeafN_ops[i], leafN_profile[i]);
     }
+
+    // Clear the outputs for any inactive layers
+    for (int i = nlayers_active; i < nlayers; ++i) {
+        for (std::vector<double*> const* ops : {&sunlit_fraction_ops,
+                                                 &sunlit_incident_ppfd_ops,
+                                                 &sunlit_absorbed_shortwave_ops,
+                                                 &shaded_fraction_ops,
+                                                 &shaded_incident_ppfd_ops,
+                                                 &shaded_absorbed_shortwave_ops,
+                                                 &average_incident_ppfd_ops,
+                                                 &average_absorbed_shortwave_ops,
+                                                 &incident_ppfd_scattered_ops,
+                                                 &height_ops,
+                                                 &rh_ops,
+                                                 &windspeed_ops,
+                                                 &LeafN_ops}) {
+            update((*ops)[i], 0.0);
+        }
+    }
 }
 
 ////////////////////////////////////////
 // TEN LAYER CANOPY PROPERTIES MODULE //
 ////////////////////////////////////////
 
-int const ten_layer_canopy_properties::nlayers = 10;
+constexpr int ten_layer_canopy_properties::nlayers;  // Storage for the value set in the header
 
 string_vector ten_layer_canopy_properties::get_inputs()
 {
@@ -188,3 +241,151 @@ void ten_layer_canopy_properties::do_operation() const
 {
     multilayer_canopy_properties::run();
 }
+
+/////////////////////////////////////////////
+// GAUSS-LEGENDRE CANOPY PROPERTIES MODULE //
+/////////////////////////////////////////////
+
+constexpr int gauss_legendre_canopy_properties::nlayers;  // Storage for the value set in the header
+
+string_vector gauss_legendre_canopy_properties::get_inputs()
+{
+    return multilayer_canopy_properties::get_inputs(gauss_legendre_canopy_properties::nlayers);
+}
+
+string_vector gauss_legendre_canopy_properties::define_leaf_classes()
+{
+    return multilayer_canopy_properties::define_leaf_classes();
+}
+
+string_vector gauss_legendre_canopy_properties::define_multiclass_multilayer_outputs()
+{
+    // Just call the parent class's multilayer output function
+    return multilayer_canopy_properties::define_multiclass_multilayer_outputs();
+}
+
+string_vector gauss_legendre_canopy_properties::define_pure_multilayer_outputs()
+{
+    // Just call the parent class's multilayer output function
+    return multilayer_canopy_properties::define_pure_multilayer_outputs();
+}
+
+string_vector gauss_legendre_canopy_properties::get_outputs()
+{
+    return multilayer_canopy_properties::get_outputs(gauss_legendre_canopy_properties::nlayers);
+}
+
+void gauss_legendre_canopy_properties::do_operation() const
+{
+    multilayer_canopy_properties::run();
+}
+
+///////////////////////////////////////
+// ADAPTIVE CANOPY PROPERTIES MODULE //
+///////////////////////////////////////
+
+constexpr int adaptive_canopy_properties::nlayers;  // Storage for the value set in the header
+
+adaptive_canopy_properties::adaptive_canopy_properties(
+    state_map const& input_quantities,
+    state_map* output_quantities)
+    : multilayer_canopy_properties(
+          adaptive_canopy_properties::nlayers,
+          input_quantities,
+          output_quantities,
+          true),
+
+      // Get the quadrature nodes for each possible number of layers
+      relative_depths_by_count(adaptive_canopy_properties::nlayers),
+      relative_weights_by_count(adaptive_canopy_properties::nlayers),
+
+      // Get references to input quantities
+      lai(get_input(input_quantities, "lai")),
+      cosine_zenith_angle(get_input(input_quantities, "cosine_zenith_angle")),
+      kd(get_input(input_quantities, "kd")),
+      chil(get_input(input_quantities, "chil")),
+      canopy_quadrature_tolerance(get_input(input_quantities, "canopy_quadrature_tolerance")),
+
+      // Get pointers to output quantities
+      nlayers_active_op(get_op(output_quantities, "nlayers_active"))
+{
+    for (int n = 1; n <= adaptive_canopy_properties::nlayers; ++n) {
+        relative_depths_by_count[n - 1].resize(n);
+        relative_weights_by_count[n - 1].resize(n);
+        gauss_legendre_canopy_nodes(
+            n,
+            relative_depths_by_count[n - 1].data(),
+            relative_weights_by_count[n - 1].data());
+    }
+}
+
+string_vector adaptive_canopy_properties::get_inputs()
+{
+    string_vector inputs = multilayer_canopy_properties::get_inputs(adaptive_canopy_properties::nlayers);
+    inputs.push_back("canopy_quadrature_tolerance");  // dimensionless
+    return inputs;
+}
+
+string_vector adaptive_canopy_properties::define_leaf_classes()
+{
+    return multilayer_canopy_properties::define_leaf_classes();
+}
+
+string_vector adaptive_canopy_properties::define_multiclass_multilayer_outputs()
+{
+    // Just call the parent class's multilayer output function
+    return multilayer_canopy_properties::define_multiclass_multilayer_outputs();
+}
+
+string_vector adaptive_canopy_properties::define_pure_multilayer_outputs()
+{
+    // Just call the parent class's multilayer output function
+    return multilayer_canopy_properties::define_pure_multilayer_outputs();
+}
+
+string_vector adaptive_canopy_properties::get_outputs()
+{
+    string_vector outputs = multilayer_canopy_properties::get_outputs(adaptive_canopy_properties::nlayers);
+    outputs.push_back("nlayers_active");  // dimensionless
+    return outputs;
+}
+
+void adaptive_canopy_properties::do_operation() const
+{
+    // Find the fastest rate of light extinction through the canopy, using the
+    // same extinction coefficient for direct light as `sunML`. When the sun is
+    // at or below the horizon, there is only diffuse light.
+    double k = kd;  // dimensionless
+    if (cosine_zenith_angle > 1E-10) {
+        double const zenith_angle = acos(cosine_zenith_angle);
+        double const k0 = sqrt(pow(chil, 2) + pow(tan(zenith_angle), 2));
+        double const k1 = chil + 1.744 * pow((chil + 1.182), -0.733);
+        k = std::max(k, k0 / k1);
+    }
+
+    // Find the smallest number of nodes that integrates `exp(-k * L)` from
+    // `L = 0` to `L = lai` with the required accuracy
+    double const a = k * lai;
+    double const exact = a > 0 ? (1 - exp(-a)) / a : 1.0;  // relative to lai
+
+    int nlayers_active = 1;
+    for (; nlayers_active < adaptive_canopy_properties::nlayers; ++nlayers_active) {
+        std::vector<double> const& depths = relative_depths_by_count[nlayers_active - 1];
+        std::vector<double> const& weights = relative_weights_by_count[nlayers_active - 1];
+
+        double approximation = 0.0;
+        for (int i = 0; i < nlayers_active; ++i) {
+            approximation += weights[i] * exp(-a * depths[i]);
+        }
+
+        if (std::abs(approximation - exact) <= canopy_quadrature_tolerance * exact) {
+            break;
+        }
+    }
+
+    update(nlayers_active_op, nlayers_active);
+
+    multilayer_canopy_properties::run(
+        nlayers_active,
+        relative_depths_by_count[nlayers_active - 1].data());
+}
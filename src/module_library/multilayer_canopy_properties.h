@@ -4,6 +4,7 @@
 #include "../state_map.h"
 #include "../modules.h"
 #include "../state_map.h"
+#include "BioCro.h"  // for gauss_legendre_canopy_nodes
 
 /**
  * @class multilayer_canopy_properties
@@ -46,6 +47,13 @@
  * these quantities to a leaf photosynthesis module that represents one leaf
  * type (e.g. sunlit leaves in layer 1).
  *
+ * By default, the canopy is divided into layers with equal leaf area, and
+ * quantities are calculated at the center of each layer. Alternatively, the
+ * layers can be placed at the nodes of a Gauss-Legendre quadrature rule in
+ * cumulative LAI; in this case, each layer represents the leaves at a single
+ * depth, and the `multilayer_canopy_integrator` must use the corresponding
+ * quadrature weights. See `gauss_legendre_canopy_nodes` for more details.
+ *
  * Note that this module has a non-standard constructor, so it cannot be created
  * using the module_wrapper_factory. Rather, it is expected that directly-usable
  * classes will be derived from this class.
@@ -56,11 +64,14 @@ class multilayer_canopy_properties : public direct_module
     multilayer_canopy_properties(
         int const& nlayers,
         state_map const& input_quantities,
-        state_map* output_quantities)
+        state_map* output_quantities,
+        bool use_gauss_legendre_nodes = false)
         : direct_module(),
 
-          // Store the number of layers
+          // Store the number of layers and their arrangement
           nlayers(nlayers),
+          use_gauss_legendre_nodes(use_gauss_legendre_nodes),
+          relative_depths(nlayers),
 
           // Get references to input quantities
           par_incident_direct(get_input(input_quantities, "par_incident_direct")),
@@ -96,11 +107,17 @@ class multilayer_canopy_properties : public direct_module
           windspeed_ops(get_multilayer_op(output_quantities, nlayers, "windspeed")),
           LeafN_ops(get_multilayer_op(output_quantities, nlayers, "LeafN"))
     {
+        if (use_gauss_legendre_nodes) {
+            std::vector<double> relative_weights(nlayers);
+            gauss_legendre_canopy_nodes(nlayers, relative_depths.data(), relative_weights.data());
+        }
     }
 
    private:
-    // Number of layers
+    // Number of layers and their arrangement
     int const nlayers;
+    bool const use_gauss_legendre_nodes;
+    std::vector<double> relative_depths;
 
     // References to input parameters
     double const& par_incident_direct;
@@ -138,6 +155,7 @@ class multilayer_canopy_properties : public direct_module
 
    protected:
     void run() const;
+    void run(int nlayers_active, double const* layer_depths) const;
     static string_vector get_inputs(int nlayers);
     static string_vector define_leaf_classes();                   // required by derived modules for compatibility with the multilayer_canopy_photosynthesis module
     static string_vector define_multiclass_multilayer_outputs();  // required by derived modules for compatibility with the multilayer_canopy_photosynthesis module
@@ -175,9 +193,112 @@ class ten_layer_canopy_properties : public multilayer_canopy_properties
     static string_vector get_outputs();
     static std::string get_name() { return "ten_layer_canopy_properties"; }
 
+    // Number of layers
+    static constexpr int nlayers = 10;
+
    private:
+    // Main operation
+    void do_operation() const;
+};
+
+/////////////////////////////////////////////
+// GAUSS-LEGENDRE CANOPY PROPERTIES MODULE //
+/////////////////////////////////////////////
+
+/**
+ * @class gauss_legendre_canopy_properties
+ *
+ * @brief A child class of multilayer_canopy_properties where the layers are
+ * placed at the nodes of a four-point Gauss-Legendre quadrature rule in
+ * cumulative LAI. When combined with the `gauss_legendre_canopy_integrator`,
+ * four layers represent the canopy at least as accurately as ten equally sized
+ * layers, so leaf-level photosynthesis needs to be calculated far fewer times.
+ * Instances of this class can be created using the module factory, unlike the
+ * parent class `multilayer_canopy_properties`.
+ */
+class gauss_legendre_canopy_properties : public multilayer_canopy_properties
+{
+   public:
+    gauss_legendre_canopy_properties(
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : multilayer_canopy_properties(
+              gauss_legendre_canopy_properties::nlayers,
+              input_quantities,
+              output_quantities,
+              true)
+    {
+    }
+    static string_vector get_inputs();
+    static string_vector define_leaf_classes();
+    static string_vector define_multiclass_multilayer_outputs();
+    static string_vector define_pure_multilayer_outputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "gauss_legendre_canopy_properties"; }
+
     // Number of layers
-    int static const nlayers;
+    static constexpr int nlayers = 4;
+
+   private:
+    // Main operation
+    void do_operation() const;
+};
+
+///////////////////////////////////////
+// ADAPTIVE CANOPY PROPERTIES MODULE //
+///////////////////////////////////////
+
+/**
+ * @class adaptive_canopy_properties
+ *
+ * @brief A child class of multilayer_canopy_properties where the layers are
+ * placed at the nodes of a Gauss-Legendre quadrature rule whose number of
+ * nodes is chosen each time the module runs.
+ *
+ * The number of active layers is the smallest one for which the quadrature
+ * rule integrates the light extinction profile `exp(-k * L)` through the whole
+ * canopy with a relative error below `canopy_quadrature_tolerance`, where `k` is
+ * the larger of the direct and diffuse extinction coefficients. A sparse
+ * canopy, such as one early in the season, therefore only needs one or two
+ * layers, while a dense canopy under a low sun uses up to `nlayers` layers.
+ *
+ * Outputs are always produced for `nlayers` layers so that the names of the
+ * quantities do not change, but the outputs for inactive layers are set to
+ * zero. The number of active layers is reported as `nlayers_active`, which is
+ * used by the `adaptive_c3_canopy`, `adaptive_c4_canopy`, and
+ * `adaptive_canopy_integrator` modules to skip the inactive layers and to
+ * choose the matching quadrature weights.
+ */
+class adaptive_canopy_properties : public multilayer_canopy_properties
+{
+   public:
+    adaptive_canopy_properties(
+        state_map const& input_quantities,
+        state_map* output_quantities);
+    static string_vector get_inputs();
+    static string_vector define_leaf_classes();
+    static string_vector define_multiclass_multilayer_outputs();
+    static string_vector define_pure_multilayer_outputs();
+    static string_vector get_outputs();
+    static std::string get_name() { return "adaptive_canopy_properties"; }
+
+    // Maximum number of layers
+    static constexpr int nlayers = 8;
+
+   private:
+    // Depths of the nodes for each possible number of active layers
+    std::vector<std::vector<double>> relative_depths_by_count;
+    std::vector<std::vector<double>> relative_weights_by_count;
+
+    // References to input parameters
+    double const& lai;
+    double const& cosine_zenith_angle;
+    double const& kd;
+    double const& chil;
+    double const& canopy_quadrature_tolerance;
+
+    // Pointers to output parameters
+    double* nlayers_active_op;
 
     // Main operation
     void do_operation() const;
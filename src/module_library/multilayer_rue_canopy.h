@@ -9,7 +9,8 @@
 using ten_layer_rue_canopy_parent =
     multilayer_canopy_photosynthesis<
         ten_layer_canopy_properties,
-        rue_leaf_photosynthesis>;
+        rue_leaf_photosynthesis,
+        ten_layer_canopy_properties::nlayers>;
 
 /**
  * @class ten_layer_rue_canopy
@@ -37,7 +38,6 @@ class ten_layer_rue_canopy : public ten_layer_rue_canopy_parent
         state_map const& input_quantities,
         state_map* output_quantities)
         : ten_layer_rue_canopy_parent(
-              ten_layer_rue_canopy::nlayers,
               input_quantities,
               output_quantities)
     {
@@ -47,9 +47,6 @@ class ten_layer_rue_canopy : public ten_layer_rue_canopy_parent
     static std::string get_name() { return "ten_layer_rue_canopy"; }
 
    private:
-    // Number of layers
-    int static const nlayers;
-
     // Main operation
     void do_operation() const;
 };
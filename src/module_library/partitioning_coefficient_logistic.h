@@ -73,6 +73,7 @@ class partitioning_coefficient_logistic : public direct_module
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "partitioning_coefficient_logistic"; }
+    std::vector<double> get_switching_functions() const override;
 
    private:
     // Pointers to input quantities
@@ -159,4 +160,11 @@ double kcoeff(double alpha, double beta, double DVI, double denom)
     return k;  // dimensionless
 }
 
+std::vector<double> partitioning_coefficient_logistic::get_switching_functions() const
+{
+    return {
+        DVI  // dimensionless; emergence, where kRhizome switches to zero
+    };
+}
+
 #endif
@@ -59,6 +59,7 @@ class partitioning_coefficient_selector : public direct_module
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "partitioning_coefficient_selector"; }
+    std::vector<double> get_switching_functions() const override;
 
    private:
     // Pointers to input quantities
@@ -191,4 +192,17 @@ void partitioning_coefficient_selector::do_operation() const
     update(kGrain_op, kGrain);
 }
 
+std::vector<double> partitioning_coefficient_selector::get_switching_functions() const
+{
+    double const TTc = *TTc_ip;
+    return {
+        TTc,            // degrees C * day
+        TTc - *tp1_ip,  // degrees C * day
+        TTc - *tp2_ip,  // degrees C * day
+        TTc - *tp3_ip,  // degrees C * day
+        TTc - *tp4_ip,  // degrees C * day
+        TTc - *tp5_ip   // degrees C * day
+    };
+}
+
 #endif
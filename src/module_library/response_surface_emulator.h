@@ -0,0 +1,106 @@
+#ifndef RESPONSE_SURFACE_EMULATOR_H
+#define RESPONSE_SURFACE_EMULATOR_H
+
+#include <memory>  // for std::shared_ptr, std::unique_ptr
+#include <string>
+#include <vector>
+#include "../modules.h"
+#include "../module_wrapper.h"
+#include "../state_map.h"
+#include "../utils/response_surface.h"
+
+/**
+ * @class response_surface_emulator
+ *
+ * @brief Emulates one or more direct modules by interpolating a table of their
+ * outputs; see the `response_surface` class for more information.
+ *
+ * The inputs of this module are the grid axes of the table, and its outputs
+ * are the tabulated outputs. Any other inputs of the original modules are
+ * fixed at the values used to make the table.
+ *
+ * Since its inputs and outputs depend on the table, this module cannot be
+ * included in the module factory's list of modules. Instead, each table is
+ * registered with the factory under a name chosen by the user, and the
+ * factory creates a `response_surface_emulator_wrapper` for that name.
+ */
+class response_surface_emulator : public direct_module
+{
+   public:
+    response_surface_emulator(
+        std::shared_ptr<response_surface const> table,
+        state_map const& input_quantities,
+        state_map* output_quantities)
+        : direct_module(),
+          table{table},
+          input_ips{get_ip(input_quantities, table->get_axis_names())},
+          output_ops{get_op(output_quantities, table->get_output_names())},
+          x(input_ips.size()),
+          outputs(output_ops.size())
+    {
+    }
+
+   private:
+    std::shared_ptr<response_surface const> const table;
+
+    // Pointers to input quantities
+    std::vector<const double*> const input_ips;
+
+    // Pointers to output quantities
+    std::vector<double*> const output_ops;
+
+    // Storage for the interpolation
+    std::vector<double> mutable x;
+    std::vector<double> mutable outputs;
+
+    // Main operation
+    void do_operation() const
+    {
+        for (size_t i = 0; i < input_ips.size(); ++i) {
+            x[i] = *input_ips[i];
+        }
+
+        table->interpolate(x.data(), outputs.data());
+
+        for (size_t j = 0; j < output_ops.size(); ++j) {
+            update(output_ops[j], outputs[j]);
+        }
+    }
+};
+
+/**
+ * @class response_surface_emulator_wrapper
+ *
+ * @brief A module wrapper for a `response_surface_emulator` that uses a
+ * particular table.
+ */
+class response_surface_emulator_wrapper : public module_wrapper_base
+{
+   public:
+    response_surface_emulator_wrapper(
+        std::string const& name,
+        std::shared_ptr<response_surface const> table)
+        : name{name},
+          table{table}
+    {
+    }
+
+    string_vector get_inputs() { return table->get_axis_names(); }
+
+    string_vector get_outputs() { return table->get_output_names(); }
+
+    std::string get_name() { return name; }
+
+    std::unique_ptr<module_base> createModule(
+        state_map const& input_quantities, state_map* output_quantities)
+    {
+        return std::unique_ptr<module_base>(new response_surface_emulator(
+            table, input_quantities, output_quantities));
+    }
+
+   private:
+    std::string const name;
+    std::shared_ptr<response_surface const> const table;
+};
+
+#endif
@@ -16,6 +16,12 @@
  * Remobilization of senesced leaf tissue is also included based on the
  * partitioning growth parameters.
  *
+ * This module does not declare any switching functions (see
+ * `module_base::get_switching_functions()`). Its rates are products of the
+ * biomasses and the coefficients from `senescence_coefficient_logistic`,
+ * which are smooth functions of the development index, so the onset of
+ * senescence is gradual rather than a discontinuity.
+ *
  */
 class senescence_logistic : public differential_module
 {
@@ -84,6 +84,7 @@ class soybean_development_rate_calculator : public direct_module
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "soybean_development_rate_calculator"; }
+    std::vector<double> get_switching_functions() const override;
 
    private:
     // References to input quantities
@@ -258,4 +259,16 @@ double photoFunc(double P, double Popt, double Pcrit)
     return fP;  // dimensionless
 }
 
+std::vector<double> soybean_development_rate_calculator::get_switching_functions() const
+{
+    return {
+        time - sowing_time,  // days; sowing
+        DVI + 1.0,           // dimensionless; lower bound of the DVI range
+        DVI,                 // dimensionless; emergence
+        DVI - 0.333,         // dimensionless; V0
+        DVI - 0.667,         // dimensionless; R0
+        DVI - 1.0            // dimensionless; R1
+    };
+}
+
 #endif
@@ -64,6 +64,7 @@ class thermal_time_development_rate_calculator : public direct_module
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "thermal_time_development_rate_calculator"; }
+    std::vector<double> get_switching_functions() const override;
 
    private:
     // Pointers to input quantities
@@ -137,4 +138,14 @@ void thermal_time_development_rate_calculator::do_operation() const
     update(development_rate_per_hour_op, development_rate_per_hour);
 }
 
+std::vector<double> thermal_time_development_rate_calculator::get_switching_functions() const
+{
+    return {
+        time - sowing_time,  // days; sowing
+        DVI + 1.0,           // dimensionless; lower bound of the DVI range
+        DVI,                 // dimensionless; emergence
+        DVI - 1.0            // dimensionless; flowering
+    };
+}
+
 #endif
@@ -86,6 +86,7 @@ class thermal_time_linear : public differential_module
     static string_vector get_inputs();
     static string_vector get_outputs();
     static std::string get_name() { return "thermal_time_linear"; }
+    std::vector<double> get_switching_functions() const override;
 
    private:
     // References to input quantities
@@ -132,4 +133,11 @@ void thermal_time_linear::do_operation() const
     update(TTc_op, rate_per_hour);
 }
 
+std::vector<double> thermal_time_linear::get_switching_functions() const
+{
+    return {
+        time - sowing_time  // days; the rate switches on at sowing
+    };
+}
+
 #endif
@@ -0,0 +1,75 @@
+#include <cstdint>  // for uint64_t
+#include <cstring>  // for std::memcmp, std::memcpy
+#include <boost/functional/hash.hpp>  // for boost::hash_combine
+#include "module_output_cache.h"
+
+constexpr size_t module_output_cache::capacity;
+
+module_output_cache::module_output_cache(
+    std::vector<const double*> input_ptrs,
+    std::vector<double*> output_ptrs)
+    : input_ptrs{input_ptrs},
+      output_ptrs{output_ptrs},
+      current_inputs(input_ptrs.size()),
+      stored_inputs(capacity * input_ptrs.size()),
+      stored_outputs(capacity * output_ptrs.size())
+{
+    filled.fill(false);
+}
+
+/**
+ *  @brief Copies the stored outputs to the module's output quantities and
+ *  returns true if the current input values have been stored; otherwise,
+ *  returns false
+ */
+bool module_output_cache::lookup()
+{
+    size_t const ninputs = input_ptrs.size();
+    size_t const noutputs = output_ptrs.size();
+
+    // Hash the bit patterns of the input values
+    current_hash = 0;
+    for (size_t j = 0; j < ninputs; ++j) {
+        current_inputs[j] = *input_ptrs[j];
+        uint64_t bits;
+        std::memcpy(&bits, &current_inputs[j], sizeof(bits));
+        boost::hash_combine(current_hash, bits);
+    }
+
+    for (size_t e = 0; e < capacity; ++e) {
+        if (filled[e] && hashes[e] == current_hash &&
+            (ninputs == 0 ||
+             std::memcmp(&stored_inputs[e * ninputs], current_inputs.data(), ninputs * sizeof(double)) == 0)) {
+            for (size_t j = 0; j < noutputs; ++j) {
+                *output_ptrs[j] = stored_outputs[e * noutputs + j];
+            }
+            ++nhits;
+            return true;
+        }
+    }
+
+    ++nmisses;
+    return false;
+}
+
+/**
+ *  @brief Stores the input values from the most recent lookup, along with the
+ *  current values of the module's output quantities, replacing the oldest entry
+ */
+void module_output_cache::store()
+{
+    size_t const ninputs = input_ptrs.size();
+    size_t const noutputs = output_ptrs.size();
+    size_t const e = next_entry;
+
+    for (size_t j = 0; j < ninputs; ++j) {
+        stored_inputs[e * ninputs + j] = current_inputs[j];
+    }
+    for (size_t j = 0; j < noutputs; ++j) {
+        stored_outputs[e * noutputs + j] = *output_ptrs[j];
+    }
+
+    hashes[e] = current_hash;
+    filled[e] = true;
+    next_entry = (next_entry + 1) % capacity;
+}
@@ -0,0 +1,73 @@
+#ifndef MODULE_OUTPUT_CACHE_H
+#define MODULE_OUTPUT_CACHE_H
+
+#include <array>
+#include <cstddef>  // for size_t
+#include <vector>
+
+/**
+ *  @class module_output_cache
+ *
+ *  @brief Remembers the outputs that a module calculated for its most recent
+ *  distinct sets of input values, so they can be reused when the same inputs
+ *  occur again.
+ *
+ *  The same inputs can be seen more than once during a simulation. For
+ *  example, a step that is rejected by an adaptive ODE solver is retried from
+ *  the same time and state, and a finite-difference Jacobian estimate leaves
+ *  the inputs of a module unchanged when the perturbed quantity is not one of
+ *  them. However, exact repeats are rare for a module whose inputs depend on
+ *  the state while an ODE solver is advancing; in a soybean simulation using
+ *  `boost_rkck54`, none of the canopy module's calls could reuse its outputs,
+ *  while about half of them could with `boost_rosenbrock`. A cache is only
+ *  used when it is requested with `dynamical_system::set_cached_modules`.
+ *
+ *  Each entry is found using a hash of the bit patterns of the input values,
+ *  and a match is confirmed by comparing all of the stored input values, so
+ *  outputs are only reused for inputs that are identical. When the cache is
+ *  full, the oldest entry is replaced.
+ *
+ *  `lookup` should be called before the module runs. If it returns true, the
+ *  stored outputs have been copied to the module's output quantities and the
+ *  module does not need to run. Otherwise, `store` should be called after the
+ *  module runs to remember its new outputs.
+ */
+class module_output_cache
+{
+   public:
+    module_output_cache(
+        std::vector<const double*> input_ptrs,
+        std::vector<double*> output_ptrs);
+
+    bool lookup();
+
+    void store();
+
+    size_t get_nhits() const { return nhits; }
+    size_t get_ncalls() const { return nhits + nmisses; }
+
+   private:
+    // The number of entries in the cache
+    static constexpr size_t capacity = 8;
+
+    std::vector<const double*> const input_ptrs;
+    std::vector<double*> const output_ptrs;
+
+    // The input values and hash found by the most recent lookup
+    std::vector<double> current_inputs;
+    size_t current_hash = 0;
+
+    // The stored entries; the inputs and outputs for each entry are stored in
+    // consecutive blocks
+    std::array<size_t, capacity> hashes;
+    std::array<bool, capacity> filled;
+    std::vector<double> stored_inputs;
+    std::vector<double> stored_outputs;
+    size_t next_entry = 0;
+
+    // Statistics
+    size_t nhits = 0;
+    size_t nmisses = 0;
+};
+
+#endif
@@ -3,7 +3,9 @@
 
 #include <vector>
 #include <memory>                     // For std::unique_ptr
+#include <utility>                    // For std::move
 #include "module_helper_functions.h"  // Essential for all modules
+#include "module_output_cache.h"
 
 /**
  *  @class module_base
@@ -23,6 +25,28 @@
  *  from previous times and will only work properly with a fixed step size
  *  Euler ODE solver.
  *
+ *  A module whose equations change abruptly when some quantity crosses a
+ *  threshold (for example, a development rate that switches on at sowing) may
+ *  also declare _switching functions_ by overriding
+ *  `get_switching_functions()`. Each switching function must change sign
+ *  exactly where the module changes from one branch of its equations to
+ *  another, with negative values corresponding to the branch that is used
+ *  below the threshold. An adaptive ODE solver can use them to locate each
+ *  switch and step exactly to it, rather than repeatedly rejecting steps that
+ *  straddle it.
+ *
+ *  Most modules calculate their outputs from the current values of their
+ *  inputs alone. A module that also keeps information from its previous calls
+ *  (for example, the starting guess of a warm-started solver) must say so by
+ *  overriding `keeps_state()` and `clear_state()`. Its outputs then depend on
+ *  the order in which it is called, so features that evaluate a module outside
+ *  of the normal sequence of calls can check for it.
+ *
+ *  A user may also ask for an expensive direct module to reuse its outputs when
+ *  its inputs repeat; see `dynamical_system::set_cached_modules` and
+ *  `module_output_cache` for more details. When a cache has been set, `run()`
+ *  only calls `do_operation()` for input values that are not in the cache.
+ *
  *  This class has a pure virtual destructor to designate it as being
  *  intentionally abstract.
  */
@@ -44,7 +68,36 @@ class module_base
     bool requires_euler_ode_solver() const { return requires_euler; }
 
     // Functions for running the module
-    void run() const { do_operation(); }
+    void run() const
+    {
+        if (!output_cache) {
+            do_operation();
+        } else if (!output_cache->lookup()) {
+            do_operation();
+            output_cache->store();
+        }
+    }
+
+    // For reusing stored outputs when the inputs repeat; a null pointer turns
+    // the cache off
+    void set_output_cache(std::unique_ptr<module_output_cache> cache)
+    {
+        output_cache = std::move(cache);
+    }
+
+    // For reporting how often stored outputs were reused; returns nullptr if
+    // the module does not use an output cache
+    module_output_cache const* get_output_cache() const { return output_cache.get(); }
+
+    // Functions for locating discontinuities; these are evaluated using the
+    // current values of the module's input quantities
+    virtual std::vector<double> get_switching_functions() const { return {}; }
+
+    // Functions for modules whose outputs depend on their previous calls, such
+    // as modules that warm-start an iterative solver; `clear_state()` returns
+    // the module to the state it had when it was created
+    virtual bool keeps_state() const { return false; }
+    virtual void clear_state() const {}
 
    private:
     virtual void do_operation() const = 0;
@@ -53,6 +106,8 @@ class module_base
     bool const differential;
     bool const requires_euler;
 
+    std::unique_ptr<module_output_cache> output_cache;
+
    protected:
     // Updates the values of output quantities
     virtual void update(double* output_ptr, const double& value) const = 0;
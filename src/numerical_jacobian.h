@@ -24,6 +24,59 @@ void evaluate_equations(std::shared_ptr<dynamical_system> const& sys, vector_typ
     sys->calculate_derivative(x, y, t);
 }
 
+/**
+ * @brief Numerically compute one column of the Jacobian matrix of a vector valued function.
+ *
+ * The ith column contains df_j(x,t)/dx_i for each j; it is found by perturbing x_i, as described
+ * for calculate_jacobian(equation_ptr, x, t, f_current, jacobi). The columns are independent, so
+ * different columns can be calculated at the same time using different equation_ptr objects.
+ *
+ * @param[in] i the index of the column to calculate.
+ *
+ * @param[in,out] x_perturbed a working vector that must equal x when this function is called; it
+ *                            is also equal to x when this function returns.
+ *
+ * @param[in,out] f_perturbed a working vector with the same length as x.
+ *
+ * See calculate_jacobian(equation_ptr, x, t, f_current, jacobi) for a description of the other
+ * parameters.
+ */
+template <typename equation_ptr_type, typename x_vector_type, typename time_type, typename f_vector_type, typename matrix_type>
+void calculate_jacobian_column(
+    equation_ptr_type const& equation_ptr,
+    x_vector_type const& x,
+    time_type t,
+    f_vector_type const& f_current,
+    size_t i,
+    x_vector_type& x_perturbed,
+    f_vector_type& f_perturbed,
+    matrix_type& jacobi)
+{
+    size_t n = x.size();
+
+    // Detemine the step size h by taking a fraction of x[i]: h = x[i] * eps_deriv.
+    // Ensure that the step size h is close to this value but is exactly representable
+    //  (see Numerical Recipes in C, 2nd ed., Section 5.7)
+    double h = x[i] * calculation_constants::eps_deriv;
+    if (h == 0.0) {
+        h = calculation_constants::eps_deriv * calculation_constants::eps_deriv;
+    }
+    double temp = x[i] + h;
+    h = temp - x[i];
+
+    // Calculate the new function value
+    x_perturbed[i] = x[i] + h;                                      // Add h to the ith differential quantity
+    evaluate_equations(equation_ptr, x_perturbed, t, f_perturbed);  // Calculate f_perturbed
+
+    // Store the results in the Jacobian matrix
+    for (size_t j = 0; j < n; j++) {
+        jacobi(j, i) = (f_perturbed[j] - f_current[j]) / h;
+    }
+
+    // Reset the ith differential quantity
+    x_perturbed[i] = x[i];
+}
+
 /**
  * @brief Numerically compute the Jacobian matrix of a vector valued function.
  *
@@ -81,33 +134,11 @@ void calculate_jacobian(
     // Make a vector to store the perturbed f(x,t)
     f_vector_type f_perturbed(n);
 
-    // Perturb each element x_i of the input vector to find df_j(x,t)/dx_i,
-    // which is stored at jacobi(j,i)
-    double h;
+    // Perturb each element x_i of the input vector to find df_j(x,t)/dx_i
     x_vector_type x_perturbed = x;
 
     for (size_t i = 0; i < n; i++) {
-        // Detemine the step size h by taking a fraction of x[i]: h = x[i] * eps_deriv.
-        // Ensure that the step size h is close to this value but is exactly representable
-        //  (see Numerical Recipes in C, 2nd ed., Section 5.7)
-        h = x[i] * calculation_constants::eps_deriv;
-        if (h == 0.0) {
-            h = calculation_constants::eps_deriv * calculation_constants::eps_deriv;
-        }
-        double temp = x[i] + h;
-        h = temp - x[i];
-
-        // Calculate the new function value
-        x_perturbed[i] = x[i] + h;                                      // Add h to the ith differential quantity
-        evaluate_equations(equation_ptr, x_perturbed, t, f_perturbed);  // Calculate f_perturbed
-
-        // Store the results in the Jacobian matrix
-        for (size_t j = 0; j < n; j++) {
-            jacobi(j, i) = (f_perturbed[j] - f_current[j]) / h;
-        }
-
-        // Reset the ith differential quantity
-        x_perturbed[i] = x[i];
+        calculate_jacobian_column(equation_ptr, x, t, f_current, i, x_perturbed, f_perturbed, jacobi);
     }
 }
 
@@ -249,6 +280,9 @@ void calculate_time_derivative(
  * @param[out] jacobi the calculated Jacobian matrix (containing df_i/dx_j evaluated at x, t)
  *
  * @param[out] dfdt the calculated explicit time dependence (i.e., df_i/dt evaluated at x, t)
+ *
+ * The function is evaluated at (x, t) once and the value is used for both calculations, so N + 2
+ * evaluations are made in total, where N is the length of x.
  */
 template <typename equation_ptr_type, typename time_type, typename vector_type, typename matrix_type>
 void calculate_jacobian_and_time_derivative(
@@ -259,8 +293,10 @@ void calculate_jacobian_and_time_derivative(
     matrix_type& jacobi,
     vector_type& dfdt)
 {
-    calculate_jacobian(equation_ptr, x, t, jacobi);
-    calculate_time_derivative(equation_ptr, max_time, x, t, dfdt);
+    vector_type f_current(x.size());
+    evaluate_equations(equation_ptr, x, t, f_current);
+    calculate_jacobian(equation_ptr, x, t, f_current, jacobi);
+    calculate_time_derivative(equation_ptr, max_time, x, t, f_current, dfdt);
 }
 
 #endif
@@ -1,13 +1,34 @@
 #include "ode_solver.h"
 
-state_vector_map ode_solver::integrate(std::shared_ptr<dynamical_system> sys)
+state_vector_map ode_solver::integrate(
+    std::shared_ptr<dynamical_system> sys,
+    output_observer* recorder,
+    stopping_criteria* stopping,
+    solver_diagnostics* diagnostics)
 {
     integrate_method_has_been_called = true;
 
+    this->recorder = recorder;
+    if (recorder) {
+        recorder->attach(*sys);
+    }
+
+    this->stopping = stopping;
+    if (stopping) {
+        stopping->attach(*sys);
+    }
+
+    // The diagnostics are attached after the derivative count is reset
+    this->diagnostics = diagnostics;
+
     if (should_check_euler_requirement && sys->requires_euler_ode_solver()) {
         return handle_euler_requirement(sys);
     } else {
         sys->reset_ncalls();
+        if (diagnostics) {
+            diagnostics->attach(*sys);
+        }
+
         return do_integrate(sys);
     }
 }
@@ -1,10 +1,15 @@
 #ifndef ODE_SOLVER_H
 #define ODE_SOLVER_H
 
+#include <stdexcept>  // for std::out_of_range
+#include <string>
 #include <vector>
 #include <boost/numeric/odeint.hpp>  // For use with ODEINT
 #include "state_map.h"
 #include "dynamical_system.h"
+#include "output_observer.h"
+#include "stopping_criteria.h"
+#include "solver_diagnostics.h"
 
 // An abstract class for a generic numerical ODE solver. Its `integrate()`
 // function provides a uniform interface for all derived ODE solvers, and its
@@ -30,7 +35,31 @@ class ode_solver
 
     virtual ~ode_solver() {}
 
-    state_vector_map integrate(std::shared_ptr<dynamical_system> sys);
+    // When an `output_observer` (such as an `output_aggregator`) is supplied,
+    // each output time point is passed to it instead of being stored, and the
+    // returned table is empty.
+    // When `stopping_criteria` are supplied, the integration ends at the
+    // first output time point where one of them is met. When
+    // `solver_diagnostics` are supplied, the solver's steps are recorded in
+    // them.
+    state_vector_map integrate(
+        std::shared_ptr<dynamical_system> sys,
+        output_observer* recorder = nullptr,
+        stopping_criteria* stopping = nullptr,
+        solver_diagnostics* diagnostics = nullptr);
+
+    // Sets the number of threads used to estimate each Jacobian matrix;
+    // only implicit ode_solvers use Jacobian matrices
+    void set_jacobian_threads(int nthreads)
+    {
+        if (nthreads < 1) {
+            throw std::out_of_range(
+                std::string("The number of Jacobian threads must be at least 1, ") +
+                std::string("but ") + std::to_string(nthreads) +
+                std::string(" was requested"));
+        }
+        jacobian_threads = nthreads;
+    }
 
     std::string generate_info_report() const
     {
@@ -51,6 +80,10 @@ class ode_solver
     double get_adaptive_rel_error_tol() const { return adaptive_rel_error_tol; }
     double get_adaptive_abs_error_tol() const { return adaptive_abs_error_tol; }
     int get_adaptive_max_steps() const { return adaptive_max_steps; }
+    output_observer* get_output_observer() const { return recorder; }
+    stopping_criteria* get_stopping_criteria() const { return stopping; }
+    solver_diagnostics* get_solver_diagnostics() const { return diagnostics; }
+    int get_jacobian_threads() const { return jacobian_threads; }
 
    private:
     const std::string ode_solver_name;
@@ -60,9 +93,16 @@ class ode_solver
     double adaptive_rel_error_tol;
     double adaptive_abs_error_tol;
     int adaptive_max_steps;
+    int jacobian_threads = 1;
 
     bool integrate_method_has_been_called = false;
 
+    // The output observer, stopping criteria, and diagnostics for the current
+    // call to `integrate`, if any
+    output_observer* recorder = nullptr;
+    stopping_criteria* stopping = nullptr;
+    solver_diagnostics* diagnostics = nullptr;
+
     virtual state_vector_map do_integrate(std::shared_ptr<dynamical_system> sys) = 0;
     virtual state_vector_map handle_euler_requirement(std::shared_ptr<dynamical_system> sys);
     virtual std::string get_param_info() const = 0;
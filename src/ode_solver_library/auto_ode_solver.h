@@ -36,7 +36,8 @@ class auto_ode_solver : public ode_solver
         // The `dynamical_system` does not require an Euler ode_solver, so use
         // the advanced ode_solver to integrate it
         advanced_ode_solver_most_recent = true;
-        return advanced_ode_solver->integrate(sys);
+        advanced_ode_solver->set_jacobian_threads(get_jacobian_threads());
+        return advanced_ode_solver->integrate(sys, get_output_observer(), get_stopping_criteria(), get_solver_diagnostics());
     }
 
     state_vector_map
@@ -45,7 +46,7 @@ class auto_ode_solver : public ode_solver
         // The `dynamical_system` requires an Euler ode_solver, so use the Euler
         // ode_solver to integrate it
         advanced_ode_solver_most_recent = false;
-        return euler_ode_solver->integrate(sys);
+        return euler_ode_solver->integrate(sys, get_output_observer(), get_stopping_criteria(), get_solver_diagnostics());
     }
 
     std::string get_param_info() const override
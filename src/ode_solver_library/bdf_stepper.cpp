@@ -0,0 +1,164 @@
+#include "bdf_stepper.h"
+
+bdf_stepper::bdf_stepper(
+    double abs_err,
+    double rel_err,
+    double max_time,
+    int max_attempts)
+    : abs_err(abs_err),
+      rel_err(rel_err),
+      max_time(max_time),
+      max_attempts(max_attempts),
+      newton_tol(std::max(10 * std::numeric_limits<double>::epsilon() / rel_err, std::min(0.03, std::sqrt(rel_err))))
+{
+}
+
+/**
+ *  @brief Starts a new integration from (x0, t0); the next step will be no
+ *  larger than dt0
+ *
+ *  If (x0, t0) is the stepper's current point, as it is when `integrate_const`
+ *  shortens the last step, the history is kept and only the step size changes.
+ *  Otherwise the history is discarded and the integration restarts at order 1,
+ *  although the Jacobian matrix is kept.
+ */
+void bdf_stepper::initialize(state_type const& x0, time_type t0, time_type dt0)
+{
+    bool const is_current_point = started && t0 == t && x0.size() == x.size() &&
+                                  std::equal(x0.begin(), x0.end(), x.begin());
+
+    if (is_current_point) {
+        if (dt0 < h) {
+            change_differences(dt0 / h);
+            h = dt0;
+            n_equal_steps = 0;
+            has_lu = false;
+        }
+        return;
+    }
+
+    x = x0;
+    t = t0;
+    x_old = x0;
+    t_old = t0;
+    h = dt0;
+    started = false;
+
+    size_t const n = x0.size();
+    if (J.size1() != n) {
+        J.resize(n, n);
+        LU.resize(n, n);
+        permutation.resize(n);
+        has_jacobian = false;
+    }
+}
+
+/**
+ *  @brief Interpolates the state between the previous and current times using
+ *  the polynomial defined by the differences
+ */
+void bdf_stepper::calc_state(time_type t_interp, state_type& x_interp) const
+{
+    x_interp = D[0];
+    double p = 1.0;
+    for (int k = 0; k < order; ++k) {
+        p *= (t_interp - (t - h * k)) / (h * (1 + k));
+        x_interp += p * D[k + 1];
+    }
+}
+
+/**
+ *  @brief Factorizes I - c * J; returns false if the matrix is singular
+ */
+bool bdf_stepper::factorize(double c)
+{
+    size_t const n = J.size1();
+
+    LU = boost::numeric::ublas::identity_matrix<double>(n) - c * J;
+    for (size_t i = 0; i < n; ++i) {
+        permutation(i) = i;
+    }
+
+    ++nfactorizations;
+    has_lu = boost::numeric::ublas::lu_factorize(LU, permutation) == 0;
+    return has_lu;
+}
+
+/**
+ *  @brief Rescales the differences for a step size that is `factor` times the
+ *  current one, so they describe the same interpolating polynomial
+ */
+void bdf_stepper::change_differences(double factor)
+{
+    // R(f) = cumulative product of the rows of M(f), where M(f)[0][j] = 1 and
+    // M(f)[i][j] = (i - 1 - f * j) / i for i, j >= 1
+    auto compute_R = [this](double f) {
+        matrix_type M(order + 1, order + 1);
+        for (int j = 0; j <= order; ++j) {
+            M(0, j) = 1.0;
+        }
+        for (int i = 1; i <= order; ++i) {
+            M(i, 0) = 0.0;
+            for (int j = 1; j <= order; ++j) {
+                M(i, j) = M(i - 1, j) * (i - 1 - f * j) / i;
+            }
+        }
+        return M;
+    };
+
+    matrix_type const RU = boost::numeric::ublas::prod(compute_R(factor), compute_R(1.0));
+
+    std::vector<state_type> new_D(order + 1, state_type(boost::numeric::ublas::zero_vector<double>(x.size())));
+    for (int i = 0; i <= order; ++i) {
+        for (int k = 0; k <= order; ++k) {
+            new_D[i] += RU(k, i) * D[k];
+        }
+    }
+
+    for (int i = 0; i <= order; ++i) {
+        D[i] = new_D[i];
+    }
+}
+
+double bdf_stepper::rms_norm(state_type const& v, state_type const& scale, double multiplier) const
+{
+    size_t const n = v.size();
+    if (n == 0) {
+        return 0.0;
+    }
+
+    double sum = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double const r = multiplier * v[i] / scale[i];
+        sum += r * r;
+    }
+    return std::sqrt(sum / n);
+}
+
+bdf_stepper::state_type bdf_stepper::get_scale(state_type const& v) const
+{
+    state_type scale(v.size());
+    for (size_t i = 0; i < v.size(); ++i) {
+        scale[i] = abs_err + rel_err * std::abs(v[i]);
+    }
+    return scale;
+}
+
+// The kappa values of the numerical differentiation formulas, which reduce the
+// error constants of the BDFs while keeping them stable (Shampine and Reichelt,
+// 1997); kappa(k) is used for order k
+double bdf_stepper::kappa(int k)
+{
+    static double const values[max_order + 2] = {0.0, -0.1850, -1.0 / 9.0, -0.0823, -0.0415, 0.0, 0.0};
+    return values[k];
+}
+
+// gamma(k) = 1 + 1/2 + ... + 1/k
+double bdf_stepper::gamma(int k)
+{
+    double sum = 0.0;
+    for (int j = 1; j <= k; ++j) {
+        sum += 1.0 / j;
+    }
+    return sum;
+}
@@ -0,0 +1,421 @@
+#ifndef BDF_STEPPER_H
+#define BDF_STEPPER_H
+
+#include <algorithm>  // for std::min, std::max, std::equal
+#include <cmath>      // for std::abs, std::pow, std::sqrt, std::isfinite, std::nextafter
+#include <limits>     // for std::numeric_limits
+#include <stdexcept>  // for std::runtime_error
+#include <string>
+#include <utility>  // for std::pair
+#include <vector>
+#include <boost/numeric/odeint.hpp>  // for dense_output_stepper_tag, unwrap_reference
+#include <boost/numeric/ublas/vector.hpp>
+#include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/lu.hpp>
+
+/**
+ *  @class bdf_stepper
+ *
+ *  @brief A variable-step, variable-order backward differentiation formula
+ *  (BDF) stepper for stiff systems.
+ *
+ *  The method follows the quasi-constant step size implementation described
+ *  in L. F. Shampine and M. W. Reichelt, "The MATLAB ODE Suite", SIAM J. Sci.
+ *  Comput. 18, 1-22 (1997), using orders 1 through 5. The solution history is
+ *  stored as backward differences, which are rescaled whenever the step size
+ *  changes. The error of each step is estimated from the difference between
+ *  the predicted and corrected states and is controlled using the absolute and
+ *  relative tolerances, just as for the odeint steppers. After a few steps of
+ *  the same size, the order that allows the largest next step is chosen.
+ *
+ *  The implicit equations for each step are solved with a simplified Newton
+ *  iteration. The Jacobian matrix is kept across steps and is only requested
+ *  again when the iteration fails to converge. The LU factorization of
+ *  I - c * J is recalculated after a new Jacobian matrix, a failed iteration,
+ *  a change of step size or order between accepted steps, or a step that is
+ *  shortened to end at `max_time`. When a step is
+ *  rejected because its error is too large, the old factorization is reused
+ *  on purpose for the smaller step: the iteration converged with it, so it is
+ *  likely to converge again, and a stale c only slows the iteration rather
+ *  than changing its solution. The matrix is provided by the
+ *  second member of the system, which is called as `jacobi(x, J, t, dfdt)` like
+ *  the Jacobian functions of odeint's implicit steppers, so any Jacobian
+ *  provider with that form can be used.
+ *
+ *  This class provides the interface of an odeint dense-output stepper. Steps
+ *  never go past `max_time`, so the drivers are never needed beyond the end of
+ *  their table; for this reason, the stepper should be used with
+ *  `boost_ode_solver::run_integrate_bounded` rather than `integrate_const`,
+ *  which keeps stepping until the last output time has been passed. A step is
+ *  abandoned by throwing an exception if `max_attempts` attempts in a row are
+ *  rejected or the step size becomes negligibly small.
+ */
+class bdf_stepper
+{
+   public:
+    typedef double value_type;
+    typedef double time_type;
+    typedef boost::numeric::ublas::vector<double> state_type;
+    typedef state_type deriv_type;
+    typedef boost::numeric::ublas::matrix<double> matrix_type;
+    typedef boost::numeric::ublas::permutation_matrix<size_t> pmatrix_type;
+    typedef boost::numeric::odeint::dense_output_stepper_tag stepper_category;
+
+    static int const max_order = 5;
+
+    bdf_stepper(
+        double abs_err,
+        double rel_err,
+        double max_time,
+        int max_attempts);
+
+    void initialize(state_type const& x0, time_type t0, time_type dt0);
+
+    template <class System>
+    std::pair<time_type, time_type> do_step(System system);
+
+    void calc_state(time_type t_interp, state_type& x_interp) const;
+
+    state_type const& current_state() const { return x; }
+    time_type current_time() const { return t; }
+    state_type const& previous_state() const { return x_old; }
+    time_type previous_time() const { return t_old; }
+    time_type current_time_step() const { return h; }
+
+    // For reporting
+    int get_rejected_steps() const { return nrejected; }
+    int get_lu_factorizations() const { return nfactorizations; }
+    int get_max_order_used() const { return max_order_used; }
+
+   private:
+    double const abs_err;
+    double const rel_err;
+    double const max_time;
+    int const max_attempts;
+    double const newton_tol;
+
+    // The current and previous points
+    state_type x;
+    time_type t = 0.0;
+    state_type x_old;
+    time_type t_old = 0.0;
+
+    // The step size and order to use for the next step
+    time_type h = 0.0;
+    int order = 1;
+    int n_equal_steps = 0;
+    bool started = false;
+
+    // The backward differences of the solution, scaled by the step size
+    std::vector<state_type> D;
+
+    // The Jacobian matrix and the LU factorization of I - c * J
+    matrix_type J;
+    bool has_jacobian = false;
+    matrix_type LU;
+    pmatrix_type permutation{0};
+    bool has_lu = false;
+
+    // Counts
+    int nrejected = 0;
+    int nfactorizations = 0;
+    int max_order_used = 1;
+
+    template <class DerivFunc>
+    void start(DerivFunc& deriv_func);
+
+    template <class DerivFunc>
+    bool solve_newton(
+        DerivFunc& deriv_func,
+        time_type t_new,
+        state_type const& x_predict,
+        double c,
+        state_type const& psi,
+        state_type const& scale,
+        state_type& x_new,
+        state_type& d,
+        int& n_iter);
+
+    bool factorize(double c);
+    void change_differences(double factor);
+    double rms_norm(state_type const& v, state_type const& scale, double multiplier) const;
+    state_type get_scale(state_type const& v) const;
+
+    // Method coefficients
+    static double kappa(int k);
+    static double gamma(int k);
+    static double alpha(int k) { return (1.0 - kappa(k)) * gamma(k); }
+    static double error_const(int k) { return kappa(k) * gamma(k) + 1.0 / (k + 1); }
+
+    // Tuning constants
+    static int const newton_max_iter = 4;
+    static constexpr double min_factor = 0.2;
+    static constexpr double max_factor = 10.0;
+};
+
+/**
+ *  @brief Takes one step, possibly after some rejected attempts, and returns
+ *  the times at its start and end
+ */
+template <class System>
+std::pair<bdf_stepper::time_type, bdf_stepper::time_type> bdf_stepper::do_step(System system)
+{
+    typedef typename boost::numeric::odeint::unwrap_reference<System>::type system_type;
+    typedef typename boost::numeric::odeint::unwrap_reference<typename system_type::first_type>::type deriv_func_type;
+    typedef typename boost::numeric::odeint::unwrap_reference<typename system_type::second_type>::type jacobi_func_type;
+    system_type& sys = system;
+    deriv_func_type& deriv_func = sys.first;
+    jacobi_func_type& jacobi_func = sys.second;
+
+    if (!started) {
+        start(deriv_func);
+    }
+
+    size_t const n = x.size();
+    double const min_step = 10.0 * (std::nextafter(t, std::numeric_limits<double>::infinity()) - t);
+
+    state_type x_predict(n), x_new(n), d(n), psi(n), scale(n), dfdt(n);
+    time_type t_new = t;
+    double error_norm = 0.0;
+    double safety = 0.0;
+    bool current_jacobian = false;
+
+    for (int attempt = 1;; ++attempt) {
+        if (attempt > max_attempts) {
+            throw std::runtime_error(
+                std::string("bdf_stepper: ") + std::to_string(max_attempts) +
+                std::string(" attempts in a row were rejected at t = ") +
+                std::to_string(t));
+        }
+
+        // Don't step past the last time, and make sure a step that reaches it
+        // ends exactly there
+        bool const reaches_end = t + h >= max_time;
+        if (reaches_end && t + h > max_time) {
+            double const new_h = max_time - t;
+            change_differences(new_h / h);
+            h = new_h;
+            n_equal_steps = 0;
+            has_lu = false;
+        }
+
+        if (h < min_step && !reaches_end) {
+            throw std::runtime_error(
+                std::string("bdf_stepper: the step size became too small at t = ") +
+                std::to_string(t));
+        }
+
+        t_new = reaches_end ? max_time : t + h;
+
+        // Predict the new state by extrapolating the history
+        x_predict = D[0];
+        for (int k = 1; k <= order; ++k) {
+            x_predict += D[k];
+        }
+        scale = get_scale(x_predict);
+
+        psi = boost::numeric::ublas::zero_vector<double>(n);
+        for (int k = 1; k <= order; ++k) {
+            psi += gamma(k) * D[k];
+        }
+        psi /= alpha(order);
+
+        // Correct the prediction, requesting a new Jacobian matrix if the
+        // iteration fails with an old one
+        double const c = h / alpha(order);
+        bool converged = false;
+        int n_iter = 0;
+        while (!converged) {
+            if (!has_jacobian) {
+                jacobi_func(x_predict, J, t_new, dfdt);
+                has_jacobian = true;
+                current_jacobian = true;
+                has_lu = false;
+            }
+
+            if (!has_lu && !factorize(c)) {
+                break;
+            }
+
+            converged = solve_newton(deriv_func, t_new, x_predict, c, psi, scale, x_new, d, n_iter);
+
+            if (!converged) {
+                if (current_jacobian) {
+                    break;
+                }
+                has_jacobian = false;
+            }
+        }
+
+        if (!converged) {
+            h *= 0.5;
+            change_differences(0.5);
+            n_equal_steps = 0;
+            has_lu = false;
+            ++nrejected;
+            continue;
+        }
+
+        safety = 0.9 * (2 * newton_max_iter + 1) / (2 * newton_max_iter + n_iter);
+        scale = get_scale(x_new);
+        error_norm = rms_norm(d, scale, error_const(order));
+
+        if (error_norm > 1.0) {
+            // The factorization is kept; since the iteration converged, it is
+            // likely to be good enough for a slightly smaller step
+            double const factor = std::max(min_factor, safety * std::pow(error_norm, -1.0 / (order + 1)));
+            h *= factor;
+            change_differences(factor);
+            n_equal_steps = 0;
+            ++nrejected;
+            continue;
+        }
+
+        break;
+    }
+
+    // Accept the step and update the differences
+    x_old = x;
+    t_old = t;
+    x = x_new;
+    t = t_new;
+    ++n_equal_steps;
+
+    D[order + 2] = d - D[order + 1];
+    D[order + 1] = d;
+    for (int k = order; k >= 0; --k) {
+        D[k] += D[k + 1];
+    }
+
+    // Choose a new step size and order once enough steps of the current size
+    // have been taken
+    if (n_equal_steps < order + 1) {
+        return std::make_pair(t_old, t);
+    }
+
+    double const infinity = std::numeric_limits<double>::infinity();
+    double const error_m_norm = order > 1 ? rms_norm(D[order], scale, error_const(order - 1)) : infinity;
+    double const error_p_norm = order < max_order ? rms_norm(D[order + 2], scale, error_const(order + 1)) : infinity;
+    double const error_norms[3] = {error_m_norm, error_norm, error_p_norm};
+
+    int best = 0;
+    double best_factor = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        double const factor = error_norms[i] == 0.0 ? infinity : std::pow(error_norms[i], -1.0 / (order + i));
+        if (factor > best_factor) {
+            best_factor = factor;
+            best = i;
+        }
+    }
+
+    order += best - 1;
+    max_order_used = std::max(max_order_used, order);
+
+    double const factor = std::min(max_factor, safety * best_factor);
+    h *= factor;
+    change_differences(factor);
+    n_equal_steps = 0;
+    has_lu = false;
+
+    return std::make_pair(t_old, t);
+}
+
+/**
+ *  @brief Chooses the first step size and initializes the differences
+ *
+ *  The step size is chosen as in E. Hairer, S. P. Norsett and G. Wanner,
+ *  "Solving Ordinary Differential Equations I: Nonstiff Problems", Sec. II.4,
+ *  but is no larger than the one passed to `initialize`.
+ */
+template <class DerivFunc>
+void bdf_stepper::start(DerivFunc& deriv_func)
+{
+    size_t const n = x.size();
+
+    state_type f0(n);
+    deriv_func(x, f0, t);
+
+    state_type const scale = get_scale(x);
+    double const d0 = rms_norm(x, scale, 1.0);
+    double const d1 = rms_norm(f0, scale, 1.0);
+
+    double const h_max = std::min(h, max_time - t);
+    double const h0 = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : std::min(0.01 * d0 / d1, h_max);
+
+    state_type x1 = x + h0 * f0;
+    state_type f1(n);
+    deriv_func(x1, f1, t + h0);
+
+    double const d2 = rms_norm(f1 - f0, scale, 1.0) / h0;
+    double const h1 = (d1 <= 1e-15 && d2 <= 1e-15) ? std::max(1e-6, h0 * 1e-3) : std::pow(0.01 / std::max(d1, d2), 0.5);
+
+    h = std::min(std::min(100 * h0, h1), h_max);
+
+    D.assign(max_order + 3, state_type(boost::numeric::ublas::zero_vector<double>(n)));
+    D[0] = x;
+    D[1] = h * f0;
+
+    order = 1;
+    n_equal_steps = 0;
+    has_lu = false;
+    started = true;
+}
+
+/**
+ *  @brief Solves the implicit equations for one step using a simplified
+ *  Newton iteration; returns true if the iteration converged
+ */
+template <class DerivFunc>
+bool bdf_stepper::solve_newton(
+    DerivFunc& deriv_func,
+    time_type t_new,
+    state_type const& x_predict,
+    double c,
+    state_type const& psi,
+    state_type const& scale,
+    state_type& x_new,
+    state_type& d,
+    int& n_iter)
+{
+    size_t const n = x_predict.size();
+
+    x_new = x_predict;
+    d = boost::numeric::ublas::zero_vector<double>(n);
+
+    state_type f(n), dx(n);
+    double dx_norm_old = -1.0;
+
+    for (int k = 0; k < newton_max_iter; ++k) {
+        n_iter = k + 1;
+
+        deriv_func(x_new, f, t_new);
+        for (size_t i = 0; i < n; ++i) {
+            if (!std::isfinite(f[i])) {
+                return false;
+            }
+        }
+
+        dx = c * f - psi - d;
+        boost::numeric::ublas::lu_substitute(LU, permutation, dx);
+        double const dx_norm = rms_norm(dx, scale, 1.0);
+
+        double const rate = dx_norm_old > 0.0 ? dx_norm / dx_norm_old : -1.0;
+        if (rate >= 1.0 ||
+            (rate > 0.0 && std::pow(rate, newton_max_iter - k) / (1.0 - rate) * dx_norm > newton_tol)) {
+            return false;
+        }
+
+        x_new += dx;
+        d += dx;
+
+        if (dx_norm == 0.0 || (rate > 0.0 && rate / (1.0 - rate) * dx_norm < newton_tol)) {
+            return true;
+        }
+
+        dx_norm_old = dx_norm;
+    }
+
+    return false;
+}
+
+#endif
@@ -1,15 +1,15 @@
 #include "boost_ode_solvers.h"
+#include "bdf_stepper.h"
 
 void boost_rsnbrk_ode_solver::do_boost_integrate(
     dynamical_system_caller syscall,
     push_back_state_and_time<boost::numeric::ublas::vector<double>>& observer
 )
 {
-    // Set up a rosenbrock stepper
+    // Set up a rosenbrock stepper that counts its rejected steps
     double const rel_err = get_adaptive_rel_error_tol();
     double const abs_err = get_adaptive_abs_error_tol();
-    typedef boost::numeric::odeint::rosenbrock4<double> dense_stepper_type;
-    auto stepper = boost::numeric::odeint::make_dense_output<dense_stepper_type>(abs_err, rel_err);
+    counting_rosenbrock4_dense_output<double> stepper(abs_err, rel_err);
 
     // Run integrate_const
     run_integrate_const(stepper, syscall, observer);
@@ -22,5 +22,38 @@ std::string boost_rsnbrk_ode_solver::get_boost_param_info() const
         std::string("\nAbsolute error tolerance: ") +
         std::to_string(get_adaptive_abs_error_tol()) +
         std::string("\nMaximum attempts to find a new step size: ") +
-        std::to_string(get_adaptive_max_steps());
+        std::to_string(get_adaptive_max_steps()) +
+        std::string("\nThreads used to estimate each Jacobian matrix: ") +
+        std::to_string(get_jacobian_threads());
+}
+
+void bdf_ode_solver::do_boost_integrate(
+    dynamical_system_caller syscall,
+    push_back_state_and_time<boost::numeric::ublas::vector<double>>& observer
+)
+{
+    // Set up a BDF stepper; it never steps past the last time point, so it
+    // can't be used with integrate_const
+    bdf_stepper stepper(
+        get_adaptive_abs_error_tol(),
+        get_adaptive_rel_error_tol(),
+        syscall.get_ntimes() - 1.0,
+        get_adaptive_max_steps());
+
+    // Integrate the system
+    run_integrate_bounded(stepper, syscall, observer);
+}
+
+std::string bdf_ode_solver::get_boost_param_info() const
+{
+    return std::string("\nRelative error tolerance: ") +
+        std::to_string(get_adaptive_rel_error_tol()) +
+        std::string("\nAbsolute error tolerance: ") +
+        std::to_string(get_adaptive_abs_error_tol()) +
+        std::string("\nMaximum attempts to find a new step size: ") +
+        std::to_string(get_adaptive_max_steps()) +
+        std::string("\nMaximum order: ") +
+        std::to_string(bdf_stepper::max_order) +
+        std::string("\nThreads used to estimate each Jacobian matrix: ") +
+        std::to_string(get_jacobian_threads());
 }
@@ -1,10 +1,13 @@
 #ifndef BOOST_ODE_SOLVERS_H
 #define BOOST_ODE_SOLVERS_H
 
+#include <algorithm>  // for std::min, std::max
 #include <boost/numeric/ublas/vector.hpp>
 #include "../ode_solver.h"
 #include "../dynamical_system_caller.h"
 #include "../state_map.h"  // for state_vector_map
+#include "../output_point_collector.h"
+#include "recording_steppers.h"
 
 /**
  *  @brief A class representing a generic boost system ode_solver.
@@ -34,9 +37,29 @@ class boost_ode_solver : public ode_solver
     template <class stepper_type>
     void run_integrate_const(stepper_type stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer);
 
+    template <class stepper_type>
+    void run_integrate_with_events(stepper_type stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer);
+
+    template <class stepper_type>
+    void run_integrate_bounded(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer);
+
    private:
     std::string boost_error_string;
     size_t nsteps;
+    size_t nevents = 0;
+    bool stopped_early = false;
+
+    template <class stepper_type>
+    void do_run_integrate_const(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer);
+
+    template <class stepper_type>
+    void do_run_integrate_with_events(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer);
+
+    template <class stepper_type>
+    void do_run_integrate_bounded(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer);
+
+    template <class integrate_type>
+    void run_and_catch(integrate_type integrate);
 
     state_type state;
     std::vector<state_type> state_vec;
@@ -57,10 +80,21 @@ class boost_ode_solver : public ode_solver
 
     std::string get_solution_info() const override
     {
-        if (boost_error_string.empty()) {
+        if (stopped_early) {
+            return std::string("boost::numeric::odeint::integrate_const was ") +
+                   std::string("stopped early by a stopping condition after ") +
+                   std::to_string(time_vec.size()) +
+                   std::string(" output time points\n\nThe observer reports the following:\n") +
+                   observer_message;
+        } else if (boost_error_string.empty()) {
+            std::string const event_info = nevents == 0 ? std::string("") :
+                std::string(" and located ") + std::to_string(nevents) +
+                std::string(" discontinuities using the modules' switching functions");
+
             return std::string("boost::numeric::odeint::integrate_const required ") +
                    std::to_string(nsteps) +
-                   std::string(" steps to integrate the system\n\nThe observer reports the following:\n") +
+                   std::string(" steps to integrate the system") + event_info +
+                   std::string("\n\nThe observer reports the following:\n") +
                    observer_message;
         } else {
             return std::string("boost::numeric::odeint::integrate_const ") +
@@ -80,26 +114,56 @@ state_vector_map boost_ode_solver<state_type>::do_integrate(std::shared_ptr<dyna
     time_vec.clear();
     observer_message = std::string("");
 
-    // Make an observer
-    push_back_state_and_time<state_type> observer(state_vec, time_vec, sys->get_ntimes() - 1.0, observer_message);
+    // Make an observer. At each output time point, it calculates the output
+    // quantities and stores them or passes them to the output observer; if
+    // there are diagnostics, it ends their current interval, and if there are
+    // stopping criteria, it checks them using the quantities that were just
+    // calculated
+    output_point_collector outputs(sys, get_output_observer());
+    stopping_criteria* stopping = get_stopping_criteria();
+    solver_diagnostics* diagnostics = get_solver_diagnostics();
+    auto should_stop = [&outputs, stopping, diagnostics](state_type const& x, double t) {
+        outputs.collect(x, t);
+        if (diagnostics) {
+            diagnostics->record_output();
+        }
+        return stopping && stopping->is_met();
+    };
+
+    push_back_state_and_time<state_type> observer(state_vec, time_vec, sys->get_ntimes() - 1.0, observer_message, should_stop);
 
     // Make a system caller
-    dynamical_system_caller syscall{sys};
+    dynamical_system_caller syscall{sys, static_cast<size_t>(get_jacobian_threads())};
 
     // integrate the system (modifies state_vec and time_vec via the observer)
     do_boost_integrate(syscall, observer);
 
     // Return the results
-    return get_results_from_system(sys, state_vec, time_vec);
+    return outputs.get_results();
 }
 
-// Run integrate_const using stored information and the supplied stepper
+// Run integrate_const using stored information and the supplied stepper,
+// recording its steps if there are diagnostics
 template <class state_type>
 template <class stepper_type>
 void boost_ode_solver<state_type>::run_integrate_const(stepper_type stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer)
 {
-    try {
-        nsteps = boost::numeric::odeint::integrate_const(
+    solver_diagnostics* diagnostics = get_solver_diagnostics();
+    if (diagnostics) {
+        recording_stepper<stepper_type> recorder(stepper, *diagnostics);
+        do_run_integrate_const(recorder, syscall, observer);
+    } else {
+        do_run_integrate_const(stepper, syscall, observer);
+    }
+}
+
+template <class state_type>
+template <class stepper_type>
+void boost_ode_solver<state_type>::do_run_integrate_const(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer)
+{
+    nevents = 0;
+    run_and_catch([&]() {
+        return boost::numeric::odeint::integrate_const(
             stepper,
             syscall,
             state,
@@ -108,11 +172,295 @@ void boost_ode_solver<state_type>::run_integrate_const(stepper_type stepper, dyn
             get_output_step_size(),
             observer,
             boost::numeric::odeint::max_step_checker(get_adaptive_max_steps()));
+    });
+}
+
+/**
+ *  @brief Integrates the system with a controlled stepper, using the modules'
+ *  switching functions to locate discontinuities.
+ *
+ *  The observer is called at the same output time points as in
+ *  `run_integrate_const`, and the system is integrated adaptively between
+ *  them. When a step is rejected, the switching functions are evaluated at
+ *  both of its ends. If any of them changed sign, the first crossing is
+ *  located along the straight line joining the two ends; the solver then steps
+ *  to just before the crossing, crosses it with a very short step, and
+ *  restarts with the step size it was attempting. Otherwise, the step size
+ *  controller would keep shrinking the step until the step that straddles the
+ *  discontinuity happened to be accepted.
+ *
+ *  The crossing found along the straight line is only an estimate, but an
+ *  inaccurate estimate is corrected automatically: if the step to the estimate
+ *  still crosses the discontinuity, it is rejected and located again.
+ *
+ *  As in `run_integrate_const`, the steps are recorded if there are
+ *  diagnostics.
+ */
+template <class state_type>
+template <class stepper_type>
+void boost_ode_solver<state_type>::run_integrate_with_events(stepper_type stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer)
+{
+    solver_diagnostics* diagnostics = get_solver_diagnostics();
+    if (diagnostics) {
+        recording_stepper<stepper_type> recorder(stepper, *diagnostics);
+        do_run_integrate_with_events(recorder, syscall, observer);
+    } else {
+        do_run_integrate_with_events(stepper, syscall, observer);
+    }
+}
+
+template <class state_type>
+template <class stepper_type>
+void boost_ode_solver<state_type>::do_run_integrate_with_events(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer)
+{
+    using boost::numeric::odeint::detail::less_eq_with_sign;
+    using boost::numeric::odeint::detail::less_with_sign;
+
+    // The width of the interval that is stepped across at each discontinuity,
+    // as a fraction of the rejected step
+    constexpr double crossing_width = 1e-6;
+    constexpr int max_locate_iterations = 10;
+
+    nevents = 0;
+    run_and_catch([&]() {
+        boost::numeric::odeint::max_step_checker step_checker(get_adaptive_max_steps());
+        boost::numeric::odeint::failed_step_checker fail_checker;
+
+        double const end_time = syscall.get_ntimes() - 1.0;
+        double const output_step = get_output_step_size();
+
+        state_type trial = state;
+        state_type point = state;
+        std::vector<double> g_lo, g_hi, g;
+
+        // Returns true if any switching function has a different sign in `a`
+        // than in `b`
+        auto switched = [](std::vector<double> const& a, std::vector<double> const& b) {
+            for (size_t k = 0; k < a.size(); ++k) {
+                if ((a[k] < 0) != (b[k] < 0)) return true;
+            }
+            return false;
+        };
+
+        // Evaluates the switching functions at a fraction `s` of the way from
+        // `state` to `trial`
+        auto evaluate_along_step = [&](double time, double dt, double s, std::vector<double>& values) {
+            point = state;
+            for (size_t i = 0; i < point.size(); ++i) {
+                point[i] += s * (trial[i] - state[i]);
+            }
+            syscall.get_switching_functions(point, time + s * dt, values);
+        };
+
+        size_t steps = 0;
+        int output_count = 0;
+        double time = 0.0;
+
+        // The step size is kept from one output interval to the next, so the
+        // controller does not have to shrink it again after every output
+        double dt = output_step;
+
+        while (less_eq_with_sign(time + output_step, end_time, output_step)) {
+            observer(state, time);
+            step_checker.reset();
+
+            ++output_count;
+            double const output_time = output_count * output_step;
+
+            double dt_cross = 0.0;   // a short step across a located discontinuity
+            double dt_resume = 0.0;  // the step to use after crossing it
+
+            while (less_with_sign(time, output_time, dt)) {
+                // A step that is shortened to end at the output time does not
+                // reduce the step size used after it
+                bool const ends_interval = !less_with_sign(time + dt, output_time, dt);
+                double const dt_unshortened = dt;
+                if (ends_interval) {
+                    dt = output_time - time;
+                }
+
+                double const dt_attempt = dt;
+                double t = time;
+
+                if (stepper.try_step(syscall, state, t, trial, dt) == boost::numeric::odeint::success) {
+                    state = trial;
+                    ++steps;
+                    step_checker();
+                    fail_checker.reset();
+
+                    // Output times are calculated rather than accumulated, so
+                    // they do not drift with rounding errors
+                    if (ends_interval) {
+                        time = output_time;
+                        dt = std::max(dt, dt_unshortened);
+                    } else {
+                        time = t;
+                    }
+
+                    if (dt_cross > 0) {
+                        dt = dt_cross;
+                        dt_cross = 0.0;
+                    } else if (dt_resume > 0) {
+                        dt = dt_resume;
+                        dt_resume = 0.0;
+                    }
+                    continue;
+                }
+
+                fail_checker();
+                dt_cross = 0.0;
+                dt_resume = 0.0;
+
+                syscall.get_switching_functions(state, time, g_lo);
+                syscall.get_switching_functions(trial, time + dt_attempt, g_hi);
+
+                if (!switched(g_lo, g_hi)) {
+                    continue;
+                }
+
+                // Narrow the bracket [lo, hi] around the first crossing using
+                // linear estimates of the crossing points
+                double lo = 0.0;
+                double hi = 1.0;
+                for (int i = 0; i < max_locate_iterations && hi - lo > crossing_width; ++i) {
+                    double s = hi;
+                    for (size_t k = 0; k < g_lo.size(); ++k) {
+                        if ((g_lo[k] < 0) != (g_hi[k] < 0)) {
+                            s = std::min(s, lo + (hi - lo) * g_lo[k] / (g_lo[k] - g_hi[k]));
+                        }
+                    }
+
+                    double const a = std::max(lo, s - 0.5 * crossing_width);
+                    double const b = std::min(hi, s + 0.5 * crossing_width);
+
+                    evaluate_along_step(time, dt_attempt, a, g);
+                    if (switched(g_lo, g)) {
+                        hi = a;
+                        g_hi = g;
+                        continue;
+                    }
+                    lo = a;
+                    g_lo = g;
+
+                    if (b >= hi) {
+                        break;
+                    }
+
+                    evaluate_along_step(time, dt_attempt, b, g);
+                    if (switched(g_lo, g)) {
+                        hi = b;
+                        g_hi = g;
+                        break;
+                    }
+                    lo = b;
+                    g_lo = g;
+                }
+
+                ++nevents;
+                dt_resume = dt_attempt;
+                if (lo > 0) {
+                    dt = lo * dt_attempt;
+                    dt_cross = (hi - lo) * dt_attempt;
+                } else {
+                    dt = hi * dt_attempt;
+                }
+            }
+        }
+        observer(state, time);
+
+        return steps;
+    });
+}
+
+/**
+ *  @brief Integrates the system with a dense-output stepper that never steps
+ *  past the last time point.
+ *
+ *  The observer is called at the same output time points as in
+ *  `run_integrate_const`, and the states at those points are interpolated by
+ *  the stepper. Unlike `integrate_const`, which keeps stepping until the
+ *  stepper has passed each output time point, the stepper is only asked for a
+ *  new step while it is short of the next output time point. So a stepper that
+ *  stops exactly at the last time point can be used, and the drivers are never
+ *  needed beyond the end of their table.
+ *
+ *  The stepper is passed by reference; the `bdf_stepper` holds a ublas
+ *  permutation_matrix, whose implicit copy constructor is deprecated, so it is
+ *  never copied.
+ *
+ *  As in `run_integrate_const`, the steps are recorded if there are
+ *  diagnostics.
+ */
+template <class state_type>
+template <class stepper_type>
+void boost_ode_solver<state_type>::run_integrate_bounded(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer)
+{
+    solver_diagnostics* diagnostics = get_solver_diagnostics();
+    if (diagnostics) {
+        recording_stepper<stepper_type> recorder(stepper, *diagnostics);
+        do_run_integrate_bounded(recorder, syscall, observer);
+    } else {
+        do_run_integrate_bounded(stepper, syscall, observer);
+    }
+}
+
+template <class state_type>
+template <class stepper_type>
+void boost_ode_solver<state_type>::do_run_integrate_bounded(stepper_type& stepper, dynamical_system_caller syscall, push_back_state_and_time<state_type> observer)
+{
+    using boost::numeric::odeint::detail::less_eq_with_sign;
+    using boost::numeric::odeint::detail::less_with_sign;
+
+    nevents = 0;
+    run_and_catch([&]() {
+        boost::numeric::odeint::max_step_checker step_checker(get_adaptive_max_steps());
+
+        double const end_time = syscall.get_ntimes() - 1.0;
+        double const output_step = get_output_step_size();
+
+        stepper.initialize(state, 0.0, output_step);
+        observer(state, 0.0);
+
+        size_t steps = 0;
+        for (int output_count = 1; less_eq_with_sign(output_count * output_step, end_time, output_step); ++output_count) {
+            double const output_time = output_count * output_step;
+            step_checker.reset();
+
+            while (less_with_sign(stepper.current_time(), output_time, output_step)) {
+                stepper.do_step(syscall);
+                ++steps;
+                step_checker();
+            }
+
+            stepper.calc_state(output_time, state);
+            observer(state, output_time);
+        }
+
+        return steps;
+    });
+}
+
+// Run an integration function that returns the number of steps it required,
+// storing information about how it ended
+template <class state_type>
+template <class integrate_type>
+void boost_ode_solver<state_type>::run_and_catch(integrate_type integrate)
+{
+    try {
+        nsteps = integrate();
+        boost_error_string.clear();
+        stopped_early = false;
+    } catch (integration_stopped const&) {
+        // A stopping condition was met; the observer has already stored the
+        // last time point
+        nsteps = 0;
         boost_error_string.clear();
+        stopped_early = true;
     } catch (std::exception& e) {
         // Store the error message and let the ode_solver return the partial results
         nsteps = 0;
         boost_error_string = std::string(e.what());
+        stopped_early = false;
     }
 }
 
@@ -192,8 +540,13 @@ class boost_rkck54_ode_solver : public boost_ode_solver<state_type>
         typedef boost::numeric::odeint::runge_kutta_cash_karp54<state_type, double, state_type, double> error_stepper_type;
         auto stepper = boost::numeric::odeint::make_controlled<error_stepper_type>(abs_err, rel_err);
 
-        // Run integrate_const
-        this->run_integrate_const(stepper, syscall, observer);
+        // Run integrate_const, locating any discontinuities declared by the
+        // modules
+        if (syscall.has_switching_functions()) {
+            this->run_integrate_with_events(stepper, syscall, observer);
+        } else {
+            this->run_integrate_const(stepper, syscall, observer);
+        }
     }
     std::string get_boost_param_info() const override
     {
@@ -225,4 +578,25 @@ class boost_rsnbrk_ode_solver : public boost_ode_solver<boost::numeric::ublas::v
     std::string get_boost_param_info() const override;
 };
 
+// A class representing a variable-order BDF ode_solver for stiff systems (see
+// `bdf_stepper`); it uses the same system caller and observer as the boost
+// ode_solvers
+// Note that this ode_solver is only compatible with boost::numeric::ublas::vector<double> state vectors
+class bdf_ode_solver : public boost_ode_solver<boost::numeric::ublas::vector<double>>
+{
+   public:
+    bdf_ode_solver(
+        double step_size,
+        double rel_error_tolerance,
+        double abs_error_tolerance,
+        int max_steps) : boost_ode_solver<boost::numeric::ublas::vector<double>>("bdf", true, step_size, rel_error_tolerance, abs_error_tolerance, max_steps) {}
+
+   private:
+    void do_boost_integrate(
+        dynamical_system_caller syscall,
+        push_back_state_and_time<boost::numeric::ublas::vector<double>>& observer) override;
+
+    std::string get_boost_param_info() const override;
+};
+
 #endif
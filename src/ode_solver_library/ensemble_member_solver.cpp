@@ -0,0 +1,245 @@
+#include <cmath>      // for std::isfinite
+#include <limits>     // for std::numeric_limits
+#include <stdexcept>  // for std::logic_error, std::out_of_range
+#include <algorithm>  // for std::find, std::min
+#include "../output_point_collector.h"
+#include "ensemble_member_solver.h"
+
+ensemble_member_solver::ensemble_member_solver(
+    std::string const& ode_solver_name,
+    double output_step_size)
+    : ode_solver_name{ode_solver_name},
+      output_step_size{output_step_size}
+{
+    string_vector const supported = get_ensemble_ode_solvers();
+    if (std::find(supported.begin(), supported.end(), ode_solver_name) == supported.end()) {
+        throw std::out_of_range(
+            std::string("\"") + ode_solver_name + std::string("\" was given ") +
+            std::string("as an ensemble ode_solver name, but only fixed-step ") +
+            std::string("ode_solvers can be used for ensembles (boost_rk4 or ") +
+            std::string("homemade_euler).\n"));
+    }
+
+    if (ode_solver_name == "boost_rk4" && !(output_step_size > 0)) {
+        throw std::out_of_range(
+            std::string("The output step size must be positive when ") +
+            std::string("using the boost_rk4 ode_solver for an ensemble.\n"));
+    }
+}
+
+/**
+ *  @brief Integrates the system, beginning at `start_step`.
+ */
+state_vector_map ensemble_member_solver::integrate(
+    std::shared_ptr<dynamical_system> const& sys,
+    output_observer* observer,
+    size_t start_step,
+    step_function const& after_derivative)
+{
+    completed = true;
+    message = std::string("");
+    nsteps = 0;
+
+    this->observer = observer;
+    this->start_step = start_step;
+    this->after_derivative = after_derivative;
+
+    sys->reset_ncalls();
+
+    if (observer) {
+        observer->attach(*sys);
+    }
+
+    if (ode_solver_name == "homemade_euler") {
+        return integrate_euler(sys);
+    } else {
+        if (sys->requires_euler_ode_solver()) {
+            throw std::logic_error(
+                std::string("ode_solver '") + ode_solver_name +
+                std::string("' is not compatible with the input system because one ") +
+                std::string("or more of its modules requires an Euler ode_solver.\n"));
+        }
+        return integrate_rk4(sys);
+    }
+}
+
+void ensemble_member_solver::stop(std::string const& reason)
+{
+    completed = false;
+    message = reason;
+}
+
+/**
+ *  @brief Follows the same algorithm as `homemade_euler_ode_solver`.
+ */
+state_vector_map ensemble_member_solver::integrate_euler(
+    std::shared_ptr<dynamical_system> const& sys)
+{
+    size_t const ntimes = sys->get_ntimes();
+    string_vector const output_names = sys->get_output_quantity_names();
+
+    // When the outputs are being passed to an observer, there is no need to
+    // store them
+    std::vector<const double*> const output_ptrs = sys->get_quantity_access_ptrs(output_names);
+    std::vector<std::vector<double>> result_vec(
+        output_names.size(), std::vector<double>(observer ? 0 : ntimes));
+
+    std::vector<double> state;
+    sys->get_differential_quantities(state);
+    std::vector<double> dstatedt = state;
+    size_t nrows = ntimes;
+
+    for (size_t t = start_step; t < ntimes && completed; ++t) {
+        try {
+            sys->calculate_derivative(state, dstatedt, t);
+        } catch (std::exception const& e) {
+            nrows = t;
+            stop(std::string("stopped at time index ") + std::to_string(t) + std::string(": ") + e.what());
+            break;
+        }
+
+        if (observer) {
+            observer->record();
+        } else {
+            for (size_t i = 0; i < output_names.size(); ++i) {
+                result_vec[i][t] = *output_ptrs[i];
+            }
+        }
+
+        ++nsteps;
+
+        if (after_derivative && !after_derivative(t, state)) {
+            nrows = t + 1;
+            stop(std::string("ended at time index ") + std::to_string(t));
+            break;
+        }
+
+        for (size_t j = 0; j < state.size(); ++j) {
+            state[j] += dstatedt[j];  // The derivative has already been multiplied by the timestep
+            if (!std::isfinite(state[j])) {
+                nrows = t + 1;
+                stop(std::string("stopped at time index ") + std::to_string(t) + std::string(": the state became non-finite"));
+                break;
+            }
+        }
+    }
+
+    // Fill in the result map, truncating it if the integration was stopped
+    state_vector_map result;
+    if (observer) {
+        return result;
+    }
+
+    size_t const first_row = std::min(start_step, nrows);
+    for (size_t i = 0; i < output_names.size(); ++i) {
+        result_vec[i].resize(nrows);
+        result[output_names[i]] = std::vector<double>(
+            result_vec[i].begin() + first_row, result_vec[i].end());
+    }
+    result["ncalls"] = std::vector<double>(nrows - first_row, sys->get_ncalls());
+
+    return result;
+}
+
+/**
+ *  @brief Follows the same algorithm as `boost_rk4_ode_solver` (i.e.,
+ *  `boost::numeric::odeint::integrate_const` with a `runge_kutta4` stepper).
+ */
+state_vector_map ensemble_member_solver::integrate_rk4(
+    std::shared_ptr<dynamical_system> const& sys)
+{
+    double const start_time = 0.0;
+    double const end_time = sys->get_ntimes() - 1.0;
+    double const dt = output_step_size;
+
+    // Butcher tableau for the classical fourth-order Runge-Kutta method
+    double const a[4] = {0.0, 0.5, 0.5, 1.0};
+    double const b[4] = {1.0 / 6.0, 1.0 / 3.0, 1.0 / 3.0, 1.0 / 6.0};
+
+    std::vector<double> state;
+    sys->get_differential_quantities(state);
+    std::vector<std::vector<double>> stage_derivs(4, state);
+    std::vector<double> stage_state;
+
+    // The outputs are calculated at each output time point, and stored or
+    // passed to the observer
+    output_point_collector outputs(sys, observer);
+
+    size_t step = 0;
+    double time = start_time;
+    while (time + dt - end_time <= std::numeric_limits<double>::epsilon()) {
+        if (step >= start_step) {
+            outputs.collect(state, time);
+
+            for (int s = 0; s < 4 && completed; ++s) {
+                stage_state = state;
+                if (s > 0) {
+                    for (size_t j = 0; j < stage_state.size(); ++j) {
+                        stage_state[j] += dt * a[s] * stage_derivs[s - 1][j];
+                    }
+                }
+
+                try {
+                    sys->calculate_derivative(stage_state, stage_derivs[s], time + a[s] * dt);
+                } catch (std::exception const& e) {
+                    stop(std::string("stopped at time ") + std::to_string(time) + std::string(": ") + e.what());
+                    break;
+                }
+
+                if (after_derivative && !after_derivative(step, state)) {
+                    stop(std::string("ended at time ") + std::to_string(time));
+                }
+            }
+
+            if (!completed) {
+                break;
+            }
+
+            for (size_t j = 0; j < state.size(); ++j) {
+                state[j] += dt * (b[0] * stage_derivs[0][j] +
+                                  b[1] * stage_derivs[1][j] +
+                                  b[2] * stage_derivs[2][j] +
+                                  b[3] * stage_derivs[3][j]);
+
+                if (!std::isfinite(state[j])) {
+                    stop(std::string("stopped at time ") + std::to_string(time) + std::string(": the state became non-finite"));
+                    break;
+                }
+            }
+
+            if (!completed) {
+                break;
+            }
+
+            ++nsteps;
+        }
+
+        ++step;
+        time = start_time + static_cast<double>(step) * dt;
+    }
+
+    if (completed) {
+        outputs.collect(state, time);
+    }
+
+    return outputs.get_results();
+}
+
+std::string ensemble_member_solver::generate_integrate_report() const
+{
+    std::string report = std::string("The ensemble ode_solver (") +
+                         ode_solver_name + std::string(") took ") +
+                         std::to_string(nsteps) + std::string(" steps");
+
+    if (start_step > 0) {
+        report += std::string(", beginning at step ") + std::to_string(start_step);
+    }
+
+    if (completed) {
+        report += std::string(", and completed\n");
+    } else {
+        report += std::string(", and ") + message + std::string("\n");
+    }
+
+    return report;
+}
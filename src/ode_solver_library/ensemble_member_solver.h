@@ -0,0 +1,96 @@
+#ifndef ENSEMBLE_MEMBER_SOLVER_H
+#define ENSEMBLE_MEMBER_SOLVER_H
+
+#include <vector>
+#include <string>
+#include <memory>           // for std::shared_ptr
+#include <functional>       // for std::function
+#include "../state_map.h"  // for state_vector_map, string_vector
+#include "../dynamical_system.h"
+#include "../output_observer.h"
+
+/**
+ *  @class ensemble_member_solver
+ *
+ *  @brief Integrates one member of a `biocro_ensemble` using a fixed-step
+ *  method that can begin at any step and can be ended early.
+ *
+ *  This is not a performance feature: the members of an ensemble are
+ *  integrated one after another, each in the same way as a separate
+ *  simulation. Instead, it provides the two hooks that `biocro_ensemble` needs
+ *  to share the beginning of a simulation among its members:
+ *
+ *  - A member may begin at a later step, starting from the values of the
+ *    differential quantities currently stored in its system; its results
+ *    begin at the output time point of its first step.
+ *
+ *  - A function can be supplied that is called after each successful
+ *    derivative calculation with the step and the values of the differential
+ *    quantities at the beginning of the step. If it returns false, the
+ *    integration is ended: the results stop at the output time point at the
+ *    beginning of that step.
+ *
+ *  Only fixed-step methods are supported, since a member must be able to begin
+ *  at a step of the shared simulation. The supported methods are:
+ *
+ *  - `homemade_euler`: produces the same output as the
+ *    `homemade_euler_ode_solver`
+ *
+ *  - `boost_rk4`: produces the same output as the `boost_rk4_ode_solver`
+ *
+ *  If a module throws an exception or the state becomes non-finite, the
+ *  integration is stopped, its results are truncated at the last successful
+ *  time point, and an explanation is stored for the report. This way, one
+ *  member of an ensemble cannot prevent the others from being run.
+ *
+ *  When an `output_observer` is supplied, each output time point is passed to
+ *  it rather than being stored, and the returned table is empty.
+ */
+class ensemble_member_solver
+{
+   public:
+    ensemble_member_solver(
+        std::string const& ode_solver_name,
+        double output_step_size);
+
+    using step_function = std::function<bool(size_t, std::vector<double> const&)>;
+
+    state_vector_map integrate(
+        std::shared_ptr<dynamical_system> const& sys,
+        output_observer* observer = nullptr,
+        size_t start_step = 0,
+        step_function const& after_derivative = nullptr);
+
+    std::string generate_integrate_report() const;
+
+    // Whether the most recent integration reached the end of the drivers
+    bool get_completed() const { return completed; }
+
+    static string_vector get_ensemble_ode_solvers()
+    {
+        return {"boost_rk4", "homemade_euler"};
+    }
+
+   private:
+    std::string const ode_solver_name;
+    double const output_step_size;
+
+    // Information about the most recent integration
+    bool completed = true;
+    std::string message;
+    size_t nsteps = 0;
+
+    // The observer, the first step, and the function called after each
+    // derivative for the current call to `integrate`, if any
+    output_observer* observer = nullptr;
+    size_t start_step = 0;
+    step_function after_derivative;
+
+    state_vector_map integrate_euler(std::shared_ptr<dynamical_system> const& sys);
+
+    state_vector_map integrate_rk4(std::shared_ptr<dynamical_system> const& sys);
+
+    void stop(std::string const& reason);
+};
+
+#endif
@@ -0,0 +1,190 @@
+#include <stdexcept>  // for std::logic_error
+#include <algorithm>  // for std::find
+#include "finite_difference_sensitivity_solver.h"
+
+finite_difference_sensitivity_solver::finite_difference_sensitivity_solver(
+    std::vector<double> const& perturbations)
+    : perturbations{perturbations}
+{
+    for (double h : perturbations) {
+        if (!(h != 0.0)) {
+            throw std::out_of_range(
+                std::string("Thrown by finite_difference_sensitivity_solver: each ") +
+                std::string("perturbation must be nonzero.\n"));
+        }
+    }
+}
+
+/**
+ *  @brief Integrates the base system, returning its result table in the same
+ *  format as the `homemade_euler_ode_solver`, and fills `sensitivities` with
+ *  one table for each perturbed system.
+ *
+ *  Each sensitivity table contains the derivatives of the differential and
+ *  direct quantities with respect to the corresponding parameter or initial
+ *  value, along with a copy of the `time` column from the base result (when
+ *  it is present) so the tables can be formatted in the same way.
+ *
+ *  The perturbed systems must have been created from the same inputs as the
+ *  base system, except for a perturbed value of the parameter of interest.
+ *  For a sensitivity to an initial value, the perturbed system should be
+ *  identical to the base system and its initial sensitivity should be the
+ *  corresponding unit vector.
+ */
+state_vector_map finite_difference_sensitivity_solver::integrate(
+    std::shared_ptr<dynamical_system> base_system,
+    std::vector<std::shared_ptr<dynamical_system>> const& perturbed_systems,
+    std::vector<std::vector<double>> const& initial_sensitivities,
+    std::vector<state_vector_map>& sensitivities)
+{
+    size_t const nsens = perturbed_systems.size();
+    size_t const ntimes = base_system->get_ntimes();
+
+    if (initial_sensitivities.size() != nsens || perturbations.size() != nsens) {
+        throw std::logic_error(
+            std::string("Thrown by finite_difference_sensitivity_solver::integrate: the ") +
+            std::string("number of perturbed systems, initial sensitivities, and ") +
+            std::string("perturbations must be the same.\n"));
+    }
+
+    for (auto const& sys : perturbed_systems) {
+        if (sys->get_ntimes() != ntimes ||
+            sys->get_differential_quantity_names() != base_system->get_differential_quantity_names()) {
+            throw std::logic_error(
+                std::string("Thrown by finite_difference_sensitivity_solver::integrate: ") +
+                std::string("all perturbed systems must share the drivers and ") +
+                std::string("differential quantities of the base system.\n"));
+        }
+        sys->reset_ncalls();
+    }
+
+    // The differences between the systems would be dominated by the effects
+    // of earlier calls on any module that keeps state
+    if (base_system->has_stateful_modules()) {
+        throw std::logic_error(
+            std::string("Thrown by finite_difference_sensitivity_solver::integrate: ") +
+            std::string("sensitivities cannot be found for a system with a ") +
+            std::string("module that keeps state between calls.\n"));
+    }
+
+    base_system->reset_ncalls();
+    nsteps = 0;
+
+    // Sensitivities are reported for every output quantity except the
+    // drivers, which do not depend on the parameters
+    string_vector const output_names = base_system->get_output_quantity_names();
+    string_vector const driver_names = base_system->get_driver_quantity_names();
+
+    string_vector sensitivity_names;
+    for (std::string const& name : output_names) {
+        if (std::find(driver_names.begin(), driver_names.end(), name) == driver_names.end()) {
+            sensitivity_names.push_back(name);
+        }
+    }
+
+    std::vector<const double*> const base_output_ptrs =
+        base_system->get_quantity_access_ptrs(output_names);
+
+    std::vector<const double*> const base_sensitivity_ptrs =
+        base_system->get_quantity_access_ptrs(sensitivity_names);
+
+    std::vector<std::vector<const double*>> perturbed_ptrs(nsens);
+    for (size_t j = 0; j < nsens; ++j) {
+        perturbed_ptrs[j] = perturbed_systems[j]->get_quantity_access_ptrs(sensitivity_names);
+    }
+
+    std::vector<std::vector<double>> result_vec(output_names.size(), std::vector<double>(ntimes));
+    std::vector<std::vector<std::vector<double>>> sensitivity_vec(
+        nsens,
+        std::vector<std::vector<double>>(sensitivity_names.size(), std::vector<double>(ntimes)));
+
+    // Get the current state in the correct format
+    std::vector<double> state;
+    base_system->get_differential_quantities(state);
+    std::vector<double> dstatedt = state;
+
+    std::vector<std::vector<double>> S = initial_sensitivities;
+    for (auto const& s : S) {
+        if (s.size() != state.size()) {
+            throw std::logic_error(
+                std::string("Thrown by finite_difference_sensitivity_solver::integrate: ") +
+                std::string("each initial sensitivity must have one element ") +
+                std::string("for each differential quantity.\n"));
+        }
+    }
+
+    std::vector<double> perturbed_state = state;
+    std::vector<std::vector<double>> perturbed_dstatedt(nsens, state);
+
+    // Run through all the times
+    for (size_t t = 0; t < ntimes; ++t) {
+        // Evaluate the base system and store its output
+        base_system->calculate_derivative(state, dstatedt, t);
+
+        for (size_t i = 0; i < output_names.size(); ++i) {
+            result_vec[i][t] = *base_output_ptrs[i];
+        }
+
+        // Evaluate each perturbed system at the perturbed state and use the
+        // difference from the base system to update its sensitivity
+        for (size_t j = 0; j < nsens; ++j) {
+            double const h = perturbations[j];
+
+            for (size_t k = 0; k < state.size(); ++k) {
+                perturbed_state[k] = state[k] + h * S[j][k];
+            }
+
+            perturbed_systems[j]->calculate_derivative(perturbed_state, perturbed_dstatedt[j], t);
+
+            for (size_t i = 0; i < sensitivity_names.size(); ++i) {
+                sensitivity_vec[j][i][t] = (*perturbed_ptrs[j][i] - *base_sensitivity_ptrs[i]) / h;
+            }
+
+            for (size_t k = 0; k < state.size(); ++k) {
+                S[j][k] += (perturbed_dstatedt[j][k] - dstatedt[k]) / h;
+            }
+        }
+
+        // Update the state for the next step
+        for (size_t k = 0; k < state.size(); ++k) {
+            state[k] += dstatedt[k];  // The derivative has already been multiplied by the timestep
+        }
+
+        ++nsteps;
+    }
+
+    // Fill in the result maps
+    state_vector_map results;
+    for (size_t i = 0; i < output_names.size(); ++i) {
+        results[output_names[i]] = result_vec[i];
+    }
+
+    ncalls = base_system->get_ncalls();
+    for (auto const& sys : perturbed_systems) {
+        ncalls += sys->get_ncalls();
+    }
+    results["ncalls"] = std::vector<double>(ntimes, ncalls);
+
+    sensitivities.assign(nsens, state_vector_map{});
+    for (size_t j = 0; j < nsens; ++j) {
+        for (size_t i = 0; i < sensitivity_names.size(); ++i) {
+            sensitivities[j][sensitivity_names[i]] = sensitivity_vec[j][i];
+        }
+        if (results.count("time") > 0) {
+            sensitivities[j]["time"] = results["time"];
+        }
+    }
+
+    return results;
+}
+
+std::string finite_difference_sensitivity_solver::generate_integrate_report() const
+{
+    return std::string("The finite difference sensitivity solver took ") +
+           std::to_string(nsteps) +
+           std::string(" Euler steps while propagating ") +
+           std::to_string(perturbations.size()) +
+           std::string(" sensitivities, using ") +
+           std::to_string(ncalls) +
+           std::string(" derivative calculations in total\n");
+}
@@ -0,0 +1,92 @@
+#ifndef FIXED_CAPACITY_VECTOR_H
+#define FIXED_CAPACITY_VECTOR_H
+
+#include <array>
+#include <cstddef>    // for size_t
+#include <stdexcept>  // for std::length_error
+#include <string>
+#include <boost/type_traits/integral_constant.hpp>  // for boost::true_type
+#include <boost/numeric/odeint/util/is_resizeable.hpp>
+
+/**
+ *  @class fixed_capacity_vector
+ *
+ *  @brief A vector of doubles whose elements are stored inside the object
+ *  rather than on the heap.
+ *
+ *  The size can be changed at run time, but it can never exceed `capacity`.
+ *  Copying, constructing, and resizing a `fixed_capacity_vector` never
+ *  allocates memory, so an odeint stepper that uses it as its state type does
+ *  not allocate its temporary states on the heap, and storing a state at each
+ *  output time point doesn't require a separate allocation.
+ *
+ *  Only the members needed by odeint's range algebra and by the
+ *  `dynamical_system` are provided.
+ */
+template <size_t capacity>
+class fixed_capacity_vector
+{
+   public:
+    typedef double value_type;
+    typedef size_t size_type;
+    typedef double* iterator;
+    typedef double const* const_iterator;
+    typedef double& reference;
+    typedef double const& const_reference;
+
+    fixed_capacity_vector() {}
+
+    explicit fixed_capacity_vector(size_t n, double value = 0.0)
+    {
+        resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            elements[i] = value;
+        }
+    }
+
+    size_t size() const { return nelements; }
+
+    static constexpr size_t max_size() { return capacity; }
+
+    void resize(size_t n)
+    {
+        if (n > capacity) {
+            throw std::length_error(
+                std::string("A fixed_capacity_vector with a capacity of ") +
+                std::to_string(capacity) +
+                std::string(" elements cannot be resized to ") +
+                std::to_string(n) + std::string(" elements"));
+        }
+        nelements = n;
+    }
+
+    double& operator[](size_t i) { return elements[i]; }
+    double const& operator[](size_t i) const { return elements[i]; }
+
+    iterator begin() { return elements.data(); }
+    iterator end() { return elements.data() + nelements; }
+    const_iterator begin() const { return elements.data(); }
+    const_iterator end() const { return elements.data() + nelements; }
+
+   private:
+    std::array<double, capacity> elements;
+    size_t nelements = 0;
+};
+
+namespace boost
+{
+namespace numeric
+{
+namespace odeint
+{
+// Allow odeint to resize the states used by a stepper, as it does for
+// std::vector
+template <size_t capacity>
+struct is_resizeable<fixed_capacity_vector<capacity>> : boost::true_type {
+};
+
+}  // namespace odeint
+}  // namespace numeric
+}  // namespace boost
+
+#endif
@@ -41,8 +41,12 @@ state_vector_map homemade_euler_ode_solver<state_type>::do_integrate(std::shared
     // Make the results map
     state_vector_map results;
 
-    // Make the result vector
-    std::vector<double> temp(sys->get_ntimes());
+    // Make the result vector; when the outputs are being passed to an
+    // observer, there is no need to store them
+    output_observer* recorder = get_output_observer();
+    stopping_criteria* stopping = get_stopping_criteria();
+    solver_diagnostics* diagnostics = get_solver_diagnostics();
+    std::vector<double> temp(recorder ? 0 : sys->get_ntimes());
     std::vector<std::vector<double>> result_vec(output_param_vector.size(), temp);
 
     // Get the current state in the correct format
@@ -52,20 +56,47 @@ state_vector_map homemade_euler_ode_solver<state_type>::do_integrate(std::shared
     // Make a vector to store the derivative
     state_type dstatedt = state;
 
-    // Run through all the times
-    for (size_t t = 0; t < sys->get_ntimes(); t++) {
+    // Run through all the times, or until a stopping condition is met
+    size_t ntimes = sys->get_ntimes();
+    for (size_t t = 0; t < ntimes; t++) {
         // Update all the parameters and calculate the derivative based on the current time and state
         sys->calculate_derivative(state, dstatedt, t);
 
-        // Store the current parameter values
-        for (size_t i = 0; i < result_vec.size(); i++) (result_vec[i])[t] = *output_ptr_vector[i];
+        // Store or observe the current parameter values
+        if (recorder) {
+            recorder->record();
+        } else {
+            for (size_t i = 0; i < result_vec.size(); i++) (result_vec[i])[t] = *output_ptr_vector[i];
+        }
+
+        if (diagnostics) {
+            diagnostics->record_output();
+        }
+
+        // Keep this time point but go no further if a condition is met
+        if (stopping && stopping->is_met()) {
+            ntimes = t + 1;
+            break;
+        }
 
         // Update the state for the next step
         for (size_t j = 0; j < state.size(); j++) state[j] += dstatedt[j];  // The derivative has already been multiplied by the timestep
+
+        if (diagnostics) {
+            diagnostics->record_step(1.0);
+        }
     }
 
-    // Fill in the result map
-    for (size_t i = 0; i < output_param_vector.size(); i++) results[output_param_vector[i]] = result_vec[i];
+    if (recorder) {
+        return results;
+    }
+
+    // Fill in the result map, truncating it if the simulation was stopped early
+    for (size_t i = 0; i < output_param_vector.size(); i++) {
+        result_vec[i].resize(ntimes);
+        results[output_param_vector[i]] = result_vec[i];
+    }
+    temp.resize(ntimes);
 
     // Add the number of derivative calculations
     std::fill(temp.begin(), temp.end(), sys->get_ncalls());
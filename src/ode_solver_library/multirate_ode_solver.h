@@ -0,0 +1,318 @@
+#ifndef MULTIRATE_ODE_SOLVER_H
+#define MULTIRATE_ODE_SOLVER_H
+
+#include <algorithm>  // for std::min, std::max
+#include <cmath>      // for std::abs, std::sqrt
+#include <stdexcept>  // for std::runtime_error
+#include <string>
+#include <vector>
+#include <boost/numeric/odeint.hpp>  // for runge_kutta_cash_karp54, make_controlled
+#include "../ode_solver.h"
+#include "../state_map.h"
+#include "../output_point_collector.h"
+
+/**
+ *  @class multirate_ode_solver
+ *
+ *  @brief An adaptive ode_solver that takes short steps for the fast
+ *  differential quantities and long steps for the slow ones.
+ *
+ *  The quantities are divided into partitions by the system (see
+ *  `dynamical_system::set_fast_modules`). Each macro step from `T` to `T + H`
+ *  proceeds as follows:
+ *
+ *  1. The full derivative is calculated at `T`, and its slow part is used to
+ *     predict the slow quantities at `T + H` with an Euler step.
+ *
+ *  2. The fast quantities are integrated from `T` to `T + H` with adaptive
+ *     Cash-Karp substeps. During these substeps the slow quantities are
+ *     linearly interpolated between their values at `T` and their predicted
+ *     values at `T + H`, and only the fast modules and the direct modules they
+ *     depend on are run.
+ *
+ *  3. The full derivative is calculated again at `T + H`, and the slow
+ *     quantities are corrected using the trapezoidal rule (Heun's method). The
+ *     difference between the prediction and the correction estimates the error
+ *     of the slow quantities, which determines whether the macro step is
+ *     accepted and the size of the next one.
+ *
+ *  So each macro step requires two full derivative calculations, while the
+ *  fast derivatives are calculated as often as the fast quantities require.
+ *  Both partitions are controlled using the same absolute and relative error
+ *  tolerances. Macro steps end exactly at the output time points, and the
+ *  integration stops with a partial result if `max_steps` attempts in a row
+ *  are rejected. If there are no fast quantities, this is an adaptive Heun
+ *  method.
+ */
+template <class state_type>
+class multirate_ode_solver : public ode_solver
+{
+   public:
+    multirate_ode_solver(
+        double step_size,
+        double rel_error_tolerance,
+        double abs_error_tolerance,
+        int max_steps) : ode_solver("multirate", true, step_size, rel_error_tolerance, abs_error_tolerance, max_steps) {}
+
+   private:
+    std::string error_string;
+    bool stopped_early = false;
+    size_t nmacro_steps = 0;
+    size_t nfast_steps = 0;
+    size_t nfast = 0;
+    std::vector<bool> is_fast;
+
+    state_vector_map do_integrate(std::shared_ptr<dynamical_system> sys) override;
+
+    bool try_macro_step(
+        std::shared_ptr<dynamical_system> sys,
+        double time,
+        double dt,
+        state_type const& state,
+        state_type& trial,
+        double& dt_fast,
+        double& error_norm);
+
+    std::string get_param_info() const override
+    {
+        return std::string("\nOutput step size: ") +
+               std::to_string(get_output_step_size()) +
+               std::string("\nRelative error tolerance: ") +
+               std::to_string(get_adaptive_rel_error_tol()) +
+               std::string("\nAbsolute error tolerance: ") +
+               std::to_string(get_adaptive_abs_error_tol()) +
+               std::string("\nMaximum attempts to find a new step size: ") +
+               std::to_string(get_adaptive_max_steps());
+    }
+
+    std::string get_solution_info() const override
+    {
+        std::string const step_info = std::to_string(nmacro_steps) +
+                                      std::string(" macro steps and ") +
+                                      std::to_string(nfast_steps) +
+                                      std::string(" substeps for the ") +
+                                      std::to_string(nfast) +
+                                      std::string(" fast quantities");
+
+        if (stopped_early) {
+            return std::string("The multirate ode_solver was stopped early by a ") +
+                   std::string("stopping condition after ") + step_info;
+        } else if (error_string.empty()) {
+            return std::string("The multirate ode_solver required ") + step_info;
+        } else {
+            return std::string("The multirate ode_solver encountered an error ") +
+                   std::string("and has returned a partial result:\n") + error_string;
+        }
+    }
+};
+
+template <class state_type>
+state_vector_map multirate_ode_solver<state_type>::do_integrate(std::shared_ptr<dynamical_system> sys)
+{
+    using boost::numeric::odeint::detail::less_eq_with_sign;
+    using boost::numeric::odeint::detail::less_with_sign;
+
+    // Step size factors
+    constexpr double safety = 0.9;
+    constexpr double min_factor = 0.2;
+    constexpr double max_factor = 5.0;
+
+    error_string.clear();
+    stopped_early = false;
+    nmacro_steps = 0;
+    nfast_steps = 0;
+    nfast = sys->get_fast_quantity_indices().size();
+    is_fast.assign(sys->get_differential_quantity_names().size(), false);
+    for (size_t i : sys->get_fast_quantity_indices()) {
+        is_fast[i] = true;
+    }
+
+    output_point_collector outputs(sys, get_output_observer());
+    stopping_criteria* stopping = get_stopping_criteria();
+    solver_diagnostics* diagnostics = get_solver_diagnostics();
+
+    state_type state;
+    sys->get_differential_quantities(state);
+    state_type trial = state;
+
+    double const end_time = sys->get_ntimes() - 1.0;
+    double const output_step = get_output_step_size();
+
+    // Calculates the outputs at an output time point; returns true if the
+    // integration should stop there
+    auto observe = [&](double time) {
+        outputs.collect(state, time);
+        if (diagnostics) {
+            diagnostics->record_output();
+        }
+        return stopping && stopping->is_met();
+    };
+
+    try {
+        double time = 0.0;
+        double dt = output_step;
+        double dt_fast = output_step;
+
+        bool stop = observe(time);
+
+        for (int output_count = 1; !stop && less_eq_with_sign(output_count * output_step, end_time, output_step); ++output_count) {
+            double const output_time = output_count * output_step;
+            int attempts = 0;
+
+            while (less_with_sign(time, output_time, output_step)) {
+                double const dt_attempt = std::min(dt, output_time - time);
+                double error_norm = 0.0;
+
+                bool const accepted = try_macro_step(sys, time, dt_attempt, state, trial, dt_fast, error_norm);
+
+                double const factor = error_norm == 0.0 ? max_factor :
+                    std::min(max_factor, std::max(min_factor, safety / std::sqrt(error_norm)));
+
+                if (accepted) {
+                    state = trial;
+                    time = output_time - time <= dt_attempt ? output_time : time + dt_attempt;
+                    attempts = 0;
+                    ++nmacro_steps;
+                    if (diagnostics) {
+                        diagnostics->record_step(dt_attempt);
+                    }
+
+                    // A step shortened to reach the output time doesn't
+                    // limit the next one
+                    dt = dt_attempt < dt ? std::max(dt, dt_attempt * factor) : dt_attempt * factor;
+                } else {
+                    if (diagnostics) {
+                        diagnostics->record_rejection();
+                    }
+                    if (++attempts >= get_adaptive_max_steps()) {
+                        throw std::runtime_error(
+                            std::string("multirate_ode_solver: ") +
+                            std::to_string(attempts) +
+                            std::string(" macro step attempts in a row were rejected at time index ") +
+                            std::to_string(time));
+                    }
+                    dt = dt_attempt * factor;
+                }
+            }
+
+            stop = observe(output_time);
+        }
+
+        stopped_early = stop;
+    } catch (std::exception& e) {
+        // Store the error message and return the partial results
+        error_string = std::string(e.what());
+    }
+
+    return outputs.get_results();
+}
+
+/**
+ *  @brief Attempts one macro step; returns true if it is accepted, in which
+ *  case `trial` holds the new state
+ *
+ *  @param[in,out] dt_fast the substep size for the fast quantities, which is
+ *         kept from one macro step to the next
+ *
+ *  @param[out] error_norm the estimated error of the slow quantities relative
+ *         to the tolerances; the step is accepted if it is no larger than 1
+ */
+template <class state_type>
+bool multirate_ode_solver<state_type>::try_macro_step(
+    std::shared_ptr<dynamical_system> sys,
+    double time,
+    double dt,
+    state_type const& state,
+    state_type& trial,
+    double& dt_fast,
+    double& error_norm)
+{
+    using boost::numeric::odeint::detail::less_with_sign;
+
+    std::vector<size_t> const& fast_indices = sys->get_fast_quantity_indices();
+    size_t const n = state.size();
+    double const rel_err = get_adaptive_rel_error_tol();
+    double const abs_err = get_adaptive_abs_error_tol();
+
+    // Calculate the full derivative at the start of the step and predict the
+    // slow quantities at its end
+    state_type start_derivative = state;
+    sys->calculate_derivative(state, start_derivative, time);
+
+    state_type predicted = state;
+    for (size_t i = 0; i < n; ++i) {
+        predicted[i] += dt * start_derivative[i];
+    }
+
+    // Integrate the fast quantities while the slow ones move along a straight
+    // line between the start and the prediction
+    state_type fast_state(nfast);
+    for (size_t k = 0; k < nfast; ++k) {
+        fast_state[k] = state[fast_indices[k]];
+    }
+
+    state_type full = state;
+    state_type full_derivative = state;
+    auto fast_system = [&](state_type const& y, state_type& dydt, double t) {
+        double const s = (t - time) / dt;
+        for (size_t i = 0; i < n; ++i) {
+            full[i] = state[i] + s * (predicted[i] - state[i]);
+        }
+        for (size_t k = 0; k < nfast; ++k) {
+            full[fast_indices[k]] = y[k];
+        }
+        sys->calculate_fast_derivative(full, full_derivative, t);
+        for (size_t k = 0; k < nfast; ++k) {
+            dydt[k] = full_derivative[fast_indices[k]];
+        }
+    };
+
+    if (nfast > 0) {
+        typedef boost::numeric::odeint::runge_kutta_cash_karp54<state_type, double, state_type, double> error_stepper_type;
+        auto stepper = boost::numeric::odeint::make_controlled<error_stepper_type>(abs_err, rel_err);
+        boost::numeric::odeint::failed_step_checker fail_checker(get_adaptive_max_steps());
+
+        double const end = time + dt;
+        double t = time;
+        while (less_with_sign(t, end, dt)) {
+            double h = std::min(dt_fast, end - t);
+            bool const shortened = h < dt_fast;
+            if (stepper.try_step(fast_system, fast_state, t, h) == boost::numeric::odeint::success) {
+                ++nfast_steps;
+                fail_checker.reset();
+                // As for the macro steps, a substep shortened to reach the end
+                // doesn't limit the next one
+                dt_fast = shortened ? std::max(dt_fast, h) : h;
+            } else {
+                fail_checker();
+                dt_fast = h;
+            }
+        }
+    }
+
+    // Calculate the full derivative at the end of the step and correct the
+    // slow quantities
+    for (size_t k = 0; k < nfast; ++k) {
+        predicted[fast_indices[k]] = fast_state[k];
+    }
+
+    state_type end_derivative = state;
+    sys->calculate_derivative(predicted, end_derivative, time + dt);
+
+    trial = predicted;
+
+    error_norm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (is_fast[i]) {
+            continue;
+        }
+        trial[i] = state[i] + 0.5 * dt * (start_derivative[i] + end_derivative[i]);
+        double const error = 0.5 * dt * std::abs(end_derivative[i] - start_derivative[i]);
+        double const scale = abs_err + rel_err * std::max(std::abs(state[i]), std::abs(trial[i]));
+        error_norm = std::max(error_norm, error / scale);
+    }
+
+    return error_norm <= 1.0;
+}
+
+#endif
@@ -4,6 +4,8 @@
 #include "boost_ode_solvers.h"
 #include "homemade_euler_ode_solver.h"
 #include "auto_ode_solver.h"
+#include "multirate_ode_solver.h"
+#include "fixed_capacity_vector.h"
 
 /**
  * @brief A function that returns a unique_ptr to a ode_solver object.
@@ -13,7 +15,8 @@ std::unique_ptr<ode_solver> create_ode_solver(
     double step_size,
     double rel_error_tolerance,
     double abs_error_tolerance,
-    int max_steps)
+    int max_steps,
+    size_t /*state_size*/)
 {
     return std::unique_ptr<ode_solver>(new ode_solver_type(
         step_size,
@@ -22,14 +25,46 @@ std::unique_ptr<ode_solver> create_ode_solver(
         max_steps));
 }
 
+/**
+ * @brief A function that returns a unique_ptr to a ode_solver object whose
+ * state type is chosen from the number of differential quantities.
+ *
+ * Small systems use a `fixed_capacity_vector`, which keeps the states used by
+ * the ode_solver off the heap; larger systems use `large_state_type`.
+ */
+template <template <class> class ode_solver_template, class large_state_type>
+std::unique_ptr<ode_solver> create_sized_ode_solver(
+    double step_size,
+    double rel_error_tolerance,
+    double abs_error_tolerance,
+    int max_steps,
+    size_t state_size)
+{
+    if (state_size <= 8) {
+        return create_ode_solver<ode_solver_template<fixed_capacity_vector<8>>>(
+            step_size, rel_error_tolerance, abs_error_tolerance, max_steps, state_size);
+    } else if (state_size <= 16) {
+        return create_ode_solver<ode_solver_template<fixed_capacity_vector<16>>>(
+            step_size, rel_error_tolerance, abs_error_tolerance, max_steps, state_size);
+    } else if (state_size <= 32) {
+        return create_ode_solver<ode_solver_template<fixed_capacity_vector<32>>>(
+            step_size, rel_error_tolerance, abs_error_tolerance, max_steps, state_size);
+    } else {
+        return create_ode_solver<ode_solver_template<large_state_type>>(
+            step_size, rel_error_tolerance, abs_error_tolerance, max_steps, state_size);
+    }
+}
+
 ode_solver_factory::ode_solver_creator_map ode_solver_factory::ode_solver_creators =
     {
-        {"auto",             create_ode_solver<auto_ode_solver<preferred_state_type>>},
-        {"homemade_euler",   create_ode_solver<homemade_euler_ode_solver<preferred_state_type>>},
-        {"boost_euler",      create_ode_solver<boost_euler_ode_solver<preferred_state_type>>},
-        {"boost_rosenbrock", create_ode_solver<boost_rsnbrk_ode_solver>},
-        {"boost_rk4",        create_ode_solver<boost_rk4_ode_solver<preferred_state_type>>},
-        {"boost_rkck54",     create_ode_solver<boost_rkck54_ode_solver<preferred_state_type>>},
+        {"auto",                    create_sized_ode_solver<auto_ode_solver, preferred_state_type>},
+        {"bdf",                     create_ode_solver<bdf_ode_solver>},
+        {"homemade_euler",          create_sized_ode_solver<homemade_euler_ode_solver, preferred_state_type>},
+        {"boost_euler",             create_sized_ode_solver<boost_euler_ode_solver, preferred_state_type>},
+        {"multirate",               create_sized_ode_solver<multirate_ode_solver, preferred_state_type>},
+        {"boost_rosenbrock",        create_ode_solver<boost_rsnbrk_ode_solver>},
+        {"boost_rk4",               create_sized_ode_solver<boost_rk4_ode_solver, preferred_state_type>},
+        {"boost_rkck54",            create_sized_ode_solver<boost_rkck54_ode_solver, preferred_state_type>},
 };
 
 std::unique_ptr<ode_solver> ode_solver_factory::create(
@@ -37,14 +72,16 @@ std::unique_ptr<ode_solver> ode_solver_factory::create(
     double step_size,
     double rel_error_tolerance,
     double abs_error_tolerance,
-    int max_steps)
+    int max_steps,
+    size_t state_size)
 {
     try {
         return ode_solver_factory::ode_solver_creators.at(ode_solver_name)(
             step_size,
             rel_error_tolerance,
             abs_error_tolerance,
-            max_steps);
+            max_steps,
+            state_size);
     } catch (std::out_of_range const&) {
         std::string message = std::string("\"") + ode_solver_name +
                               std::string("\"") +
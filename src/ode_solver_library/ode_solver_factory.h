@@ -16,21 +16,24 @@ class ode_solver_factory
         double step_size,
         double rel_error_tolerance,
         double abs_error_tolerance,
-        int max_steps);
+        int max_steps,
+        size_t state_size);
 
     static string_vector get_ode_solvers();
 
    private:
     // Define a ode_solver_creator to be a pointer to a function that
-    // has no arguments and returns a std::unique_ptr<ode_solver>
+    // takes the ode_solver's settings and the number of differential
+    // quantities and returns a std::unique_ptr<ode_solver>
     using ode_solver_creator =
-        std::unique_ptr<ode_solver> (*)(double, double, double, int);
+        std::unique_ptr<ode_solver> (*)(double, double, double, int, size_t);
 
     // A map of strings to ode_solver_creators
     using ode_solver_creator_map =
         std::map<std::string, ode_solver_creator>;
 
-    // A default value for state type
+    // A default value for state type, which is used by systems with too many
+    // differential quantities for a fixed_capacity_vector
     using preferred_state_type = std::vector<double>;
 
     static ode_solver_creator_map ode_solver_creators;
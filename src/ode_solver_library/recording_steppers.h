@@ -0,0 +1,259 @@
+#ifndef RECORDING_STEPPERS_H
+#define RECORDING_STEPPERS_H
+
+#include <memory>                    // for std::shared_ptr, std::make_shared
+#include <utility>                   // for std::pair, std::declval
+#include <boost/numeric/odeint.hpp>  // for stepper categories and controlled_step_result
+#include "../solver_diagnostics.h"
+
+/**
+ *  @class recording_stepper
+ *
+ *  @brief Wraps a boost::numeric::odeint stepper so that each of its steps is
+ *  recorded in a `solver_diagnostics` object, without changing the steps
+ *  themselves.
+ *
+ *  The wrapper has the same basic stepper category as the stepper it wraps
+ *  and provides the part of that category's interface that is used by
+ *  `integrate_const`, so it can be used in its place. Only a reference to the
+ *  stepper is stored, so the wrapped stepper must outlive the wrapper.
+ */
+template <class stepper_type,
+          class category = typename boost::numeric::odeint::base_tag<
+              typename stepper_type::stepper_category>::type>
+class recording_stepper;
+
+/**
+ *  @brief A fixed-step stepper; every step is accepted.
+ */
+template <class stepper_type>
+class recording_stepper<stepper_type, boost::numeric::odeint::stepper_tag>
+{
+   public:
+    typedef boost::numeric::odeint::stepper_tag stepper_category;
+    typedef typename stepper_type::state_type state_type;
+    typedef typename stepper_type::value_type value_type;
+    typedef typename stepper_type::deriv_type deriv_type;
+    typedef typename stepper_type::time_type time_type;
+
+    recording_stepper(stepper_type& stepper, solver_diagnostics& diagnostics)
+        : stepper(stepper), diagnostics(diagnostics)
+    {
+    }
+
+    template <class System, class StateInOut>
+    void do_step(System system, StateInOut& x, time_type t, time_type dt)
+    {
+        stepper.do_step(system, x, t, dt);
+        diagnostics.record_step(dt);
+    }
+
+   private:
+    stepper_type& stepper;
+    solver_diagnostics& diagnostics;
+};
+
+/**
+ *  @brief A controlled stepper; each call to `try_step` either accepts or
+ *  rejects one step.
+ */
+template <class stepper_type>
+class recording_stepper<stepper_type, boost::numeric::odeint::controlled_stepper_tag>
+{
+   public:
+    typedef boost::numeric::odeint::controlled_stepper_tag stepper_category;
+    typedef typename stepper_type::state_type state_type;
+    typedef typename stepper_type::value_type value_type;
+    typedef typename stepper_type::deriv_type deriv_type;
+    typedef typename stepper_type::time_type time_type;
+
+    recording_stepper(stepper_type& stepper, solver_diagnostics& diagnostics)
+        : stepper(stepper), diagnostics(diagnostics)
+    {
+    }
+
+    template <class System, class StateInOut>
+    boost::numeric::odeint::controlled_step_result
+    try_step(System system, StateInOut& x, time_type& t, time_type& dt)
+    {
+        time_type const dt_attempt = dt;
+        return record(stepper.try_step(system, x, t, dt), dt_attempt);
+    }
+
+    template <class System, class StateIn, class StateOut>
+    boost::numeric::odeint::controlled_step_result
+    try_step(System system, StateIn const& in, time_type& t, StateOut& out, time_type& dt)
+    {
+        time_type const dt_attempt = dt;
+        return record(stepper.try_step(system, in, t, out, dt), dt_attempt);
+    }
+
+   private:
+    stepper_type& stepper;
+    solver_diagnostics& diagnostics;
+
+    boost::numeric::odeint::controlled_step_result record(
+        boost::numeric::odeint::controlled_step_result result,
+        time_type dt_attempt)
+    {
+        if (result == boost::numeric::odeint::success) {
+            diagnostics.record_step(dt_attempt);
+        } else {
+            diagnostics.record_rejection();
+        }
+        return result;
+    }
+};
+
+/**
+ *  @brief A dense-output stepper; each call to `do_step` takes one accepted
+ *  step, possibly after some rejected attempts.
+ *
+ *  If the stepper counts its rejected attempts with a `get_rejected_steps`
+ *  method, the count is used directly. Otherwise, the rejected attempts are not
+ *  visible from outside the stepper, so the number of rejections is recorded
+ *  as unknown.
+ */
+template <class stepper_type>
+class recording_stepper<stepper_type, boost::numeric::odeint::dense_output_stepper_tag>
+{
+   public:
+    typedef boost::numeric::odeint::dense_output_stepper_tag stepper_category;
+    typedef typename stepper_type::state_type state_type;
+    typedef typename stepper_type::value_type value_type;
+    typedef typename stepper_type::deriv_type deriv_type;
+    typedef typename stepper_type::time_type time_type;
+
+    recording_stepper(stepper_type& stepper, solver_diagnostics& diagnostics)
+        : stepper(stepper), diagnostics(diagnostics)
+    {
+    }
+
+    template <class System>
+    std::pair<time_type, time_type> do_step(System system)
+    {
+        int const nrejected = total_rejections(0);
+        std::pair<time_type, time_type> const step = stepper.do_step(system);
+
+        diagnostics.record_step(step.second - step.first);
+        if (nrejected < 0) {
+            diagnostics.record_unknown_rejections();
+        } else {
+            for (int i = nrejected; i < total_rejections(0); ++i) {
+                diagnostics.record_rejection();
+            }
+        }
+
+        return step;
+    }
+
+    template <class StateType>
+    void initialize(StateType const& x0, time_type t0, time_type dt0)
+    {
+        stepper.initialize(x0, t0, dt0);
+    }
+
+    template <class StateOut>
+    void calc_state(time_type t, StateOut& x) const { stepper.calc_state(t, x); }
+
+    template <class StateOut>
+    void calc_state(time_type t, StateOut const& x) const { stepper.calc_state(t, x); }
+
+    state_type const& current_state() const { return stepper.current_state(); }
+    time_type current_time() const { return stepper.current_time(); }
+    state_type const& previous_state() const { return stepper.previous_state(); }
+    time_type previous_time() const { return stepper.previous_time(); }
+    time_type current_time_step() const { return stepper.current_time_step(); }
+
+   private:
+    stepper_type& stepper;
+    solver_diagnostics& diagnostics;
+
+    // The total number of rejected attempts so far, or -1 if it is unknown;
+    // the `int` overload is preferred when the stepper provides its own count
+    template <class S = stepper_type>
+    auto total_rejections(int) const -> decltype(std::declval<S const&>().get_rejected_steps())
+    {
+        return stepper.get_rejected_steps();
+    }
+
+    int total_rejections(long) const
+    {
+        return -1;
+    }
+};
+
+/**
+ *  @class counting_rosenbrock4_controller
+ *
+ *  @brief odeint's `rosenbrock4_controller`, except that each step rejected by
+ *  `try_step` is added to a counter that can be shared with other objects.
+ */
+template <class value_type>
+class counting_rosenbrock4_controller
+    : public boost::numeric::odeint::rosenbrock4_controller<boost::numeric::odeint::rosenbrock4<value_type>>
+{
+    typedef boost::numeric::odeint::rosenbrock4_controller<boost::numeric::odeint::rosenbrock4<value_type>> controller_type;
+
+   public:
+    typedef typename controller_type::state_type state_type;
+    typedef typename controller_type::time_type time_type;
+
+    counting_rosenbrock4_controller(value_type abs_err, value_type rel_err, std::shared_ptr<int> nrejected)
+        : controller_type(abs_err, rel_err), nrejected(nrejected)
+    {
+    }
+
+    template <class System>
+    boost::numeric::odeint::controlled_step_result
+    try_step(System system, state_type const& x, time_type& t, state_type& xout, time_type& dt)
+    {
+        boost::numeric::odeint::controlled_step_result const result =
+            controller_type::try_step(system, x, t, xout, dt);
+
+        if (result != boost::numeric::odeint::success) {
+            ++*nrejected;
+        }
+        return result;
+    }
+
+   private:
+    std::shared_ptr<int> nrejected;
+};
+
+/**
+ *  @class counting_rosenbrock4_dense_output
+ *
+ *  @brief odeint's `rosenbrock4_dense_output` stepper, which also counts the
+ *  steps rejected by its controller.
+ *
+ *  The dense-output stepper keeps its own copy of its controller and repeats
+ *  `try_step` until a step is accepted, so the controller shares its count of
+ *  the rejected steps with this object, which reports it through
+ *  `get_rejected_steps`.
+ */
+template <class value_type>
+class counting_rosenbrock4_dense_output
+    : public boost::numeric::odeint::rosenbrock4_dense_output<counting_rosenbrock4_controller<value_type>>
+{
+    typedef boost::numeric::odeint::rosenbrock4_dense_output<counting_rosenbrock4_controller<value_type>> dense_output_type;
+
+   public:
+    counting_rosenbrock4_dense_output(value_type abs_err, value_type rel_err)
+        : counting_rosenbrock4_dense_output(abs_err, rel_err, std::make_shared<int>(0))
+    {
+    }
+
+    int get_rejected_steps() const { return *nrejected; }
+
+   private:
+    counting_rosenbrock4_dense_output(value_type abs_err, value_type rel_err, std::shared_ptr<int> nrejected)
+        : dense_output_type(counting_rosenbrock4_controller<value_type>(abs_err, rel_err, nrejected)),
+          nrejected(nrejected)
+    {
+    }
+
+    std::shared_ptr<int> nrejected;
+};
+
+#endif
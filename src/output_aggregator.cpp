@@ -0,0 +1,150 @@
+#include <cmath>      // for std::floor, std::isinf
+#include <algorithm>  // for std::find
+#include <stdexcept>  // for std::out_of_range
+#include "output_aggregator.h"
+
+output_aggregator::output_aggregator(std::vector<output_reduction> const& specs)
+{
+    for (output_reduction const& r : specs) {
+        reduction_state s;
+        s.spec = r;
+
+        if (r.op == "sum") {
+            s.op = reduction_op::sum;
+        } else if (r.op == "mean") {
+            s.op = reduction_op::mean;
+        } else if (r.op == "max") {
+            s.op = reduction_op::max;
+        } else if (r.op == "last") {
+            s.op = reduction_op::last;
+        } else {
+            throw std::out_of_range(
+                std::string("\"") + r.op + std::string("\" was given as a ") +
+                std::string("reduction operation for \"") + r.quantity +
+                std::string("\", but it must be one of `sum`, `mean`, ") +
+                std::string("`max`, or `last`.\n"));
+        }
+
+        if (!(r.window > 0)) {
+            throw std::out_of_range(
+                std::string("The reduction window for \"") + r.quantity +
+                std::string("\" must be positive.\n"));
+        }
+
+        for (reduction_state const& other : reductions) {
+            if (other.spec.quantity == r.quantity && other.spec.op == r.op &&
+                other.spec.window == r.window) {
+                throw std::out_of_range(
+                    std::string("The `") + r.op + std::string("` of \"") +
+                    r.quantity + std::string("\" was requested more than ") +
+                    std::string("once with the same window.\n"));
+            }
+        }
+
+        reductions.push_back(s);
+    }
+}
+
+/**
+ *  @brief Gets pointers to the `time` quantity and to each reduced quantity in
+ *  the system's internally stored quantity map.
+ */
+void output_aggregator::attach(dynamical_system const& sys)
+{
+    string_vector const output_names = sys.get_output_quantity_names();
+
+    auto check_name = [&output_names](std::string const& name) {
+        if (std::find(output_names.begin(), output_names.end(), name) == output_names.end()) {
+            throw std::out_of_range(
+                std::string("\"") + name + std::string("\" was given as a ") +
+                std::string("quantity to reduce, but it is not an output of ") +
+                std::string("the system.\n"));
+        }
+    };
+
+    if (std::find(output_names.begin(), output_names.end(), "time") == output_names.end()) {
+        throw std::out_of_range(
+            std::string("Output reductions require a `time` driver.\n"));
+    }
+    time_ptr = sys.get_quantity_access_ptrs({"time"})[0];
+
+    for (reduction_state& s : reductions) {
+        check_name(s.spec.quantity);
+        s.value_ptr = sys.get_quantity_access_ptrs({s.spec.quantity})[0];
+        s.window_open = false;
+        s.times.clear();
+        s.values.clear();
+    }
+}
+
+void output_aggregator::record()
+{
+    double const time = *time_ptr;
+
+    for (reduction_state& s : reductions) {
+        double const index = std::isinf(s.spec.window) ? 0.0 : std::floor(time / s.spec.window);
+
+        if (s.window_open && index != s.window_index) {
+            s.close_window();
+        }
+
+        double const value = *s.value_ptr;
+
+        if (!s.window_open) {
+            s.window_open = true;
+            s.window_index = index;
+            s.window_time = time;
+            s.accumulator = value;
+            s.count = 1;
+            continue;
+        }
+
+        switch (s.op) {
+            case reduction_op::sum:
+            case reduction_op::mean:
+                s.accumulator += value;
+                break;
+            case reduction_op::max:
+                s.accumulator = std::max(s.accumulator, value);
+                break;
+            case reduction_op::last:
+                s.accumulator = value;
+                break;
+        }
+        ++s.count;
+    }
+}
+
+void output_aggregator::reduction_state::close_window()
+{
+    times.push_back(window_time);
+    values.push_back(op == reduction_op::mean ? accumulator / count : accumulator);
+    window_open = false;
+}
+
+/**
+ *  @brief Returns one table for each reduction, in the same order as the
+ *  reductions were supplied to the constructor. Each table contains the time
+ *  of the first point in each window (`time`) and the reduced value (named
+ *  after the quantity).
+ *
+ *  The window that is still open when the simulation ends is included, even
+ *  though it may be shorter than the others.
+ */
+std::vector<state_vector_map> output_aggregator::get_results() const
+{
+    std::vector<state_vector_map> results;
+
+    for (reduction_state s : reductions) {
+        if (s.window_open) {
+            s.close_window();
+        }
+
+        state_vector_map table;
+        table["time"] = s.times;
+        table[s.spec.quantity] = s.values;
+        results.push_back(table);
+    }
+
+    return results;
+}
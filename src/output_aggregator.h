@@ -0,0 +1,82 @@
+#ifndef OUTPUT_AGGREGATOR_H
+#define OUTPUT_AGGREGATOR_H
+
+#include <vector>
+#include <string>
+#include "state_map.h"  // for state_vector_map, string_vector
+#include "dynamical_system.h"
+#include "output_observer.h"
+
+/**
+ *  @brief Describes a reduction of one output quantity over time windows.
+ *
+ *  The windows are consecutive intervals of the `time` quantity with length
+ *  `window`; for example, a window of 1 produces daily values when `time` is
+ *  expressed in days. A window of infinity produces a single value for the
+ *  whole simulation. `op` must be one of `sum`, `mean`, `max`, or `last`.
+ */
+struct output_reduction {
+    std::string quantity;
+    double window;
+    std::string op;
+};
+
+/**
+ *  @class output_aggregator
+ *
+ *  @brief Reduces a stream of output time points to a small set of window
+ *  aggregates, so that an ODE solver does not need to store the value of every
+ *  output quantity at every time point.
+ *
+ *  After it has been attached to a `dynamical_system`, the `record` method
+ *  should be called once for each output time point, after the system's
+ *  quantities have been updated for that point; see `output_observer`. Each
+ *  call only updates the running value of the current window for each
+ *  reduction; a window is finalized as soon as a time point falls in a later
+ *  window.
+ *
+ *  The windows are aligned to multiples of `window` in units of `time`, so
+ *  daily windows begin at midnight regardless of when the simulation starts.
+ *  Each finished window is reported at the time of its first point.
+ */
+class output_aggregator : public output_observer
+{
+   public:
+    output_aggregator(std::vector<output_reduction> const& specs);
+
+    void attach(dynamical_system const& sys) override;
+
+    void record() override;
+
+    std::vector<state_vector_map> get_results() const;
+
+   private:
+    enum class reduction_op { sum,
+                              mean,
+                              max,
+                              last };
+
+    struct reduction_state {
+        output_reduction spec;
+        reduction_op op;
+        const double* value_ptr = nullptr;
+
+        // The running value of the current window
+        bool window_open = false;
+        double window_index = 0.0;
+        double window_time = 0.0;
+        double accumulator = 0.0;
+        size_t count = 0;
+
+        // Finished windows
+        std::vector<double> times;
+        std::vector<double> values;
+
+        void close_window();
+    };
+
+    std::vector<reduction_state> reductions;
+    const double* time_ptr = nullptr;
+};
+
+#endif
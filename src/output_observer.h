@@ -0,0 +1,28 @@
+#ifndef OUTPUT_OBSERVER_H
+#define OUTPUT_OBSERVER_H
+
+#include "dynamical_system.h"
+
+/**
+ *  @class output_observer
+ *
+ *  @brief An interface for objects that consume the output time points of a
+ *  simulation as they are produced, so that an ODE solver does not need to
+ *  store the value of every output quantity at every time point.
+ *
+ *  `attach` is called once before the integration begins. After that, an ODE
+ *  solver calls `record` once for each output time point, in order of
+ *  increasing time, after the system's quantities have been updated for that
+ *  point.
+ */
+class output_observer
+{
+   public:
+    virtual ~output_observer() {}
+
+    virtual void attach(dynamical_system const& sys) = 0;
+
+    virtual void record() = 0;
+};
+
+#endif
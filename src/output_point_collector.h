@@ -0,0 +1,86 @@
+#ifndef OUTPUT_POINT_COLLECTOR_H
+#define OUTPUT_POINT_COLLECTOR_H
+
+#include <vector>
+#include <memory>       // for std::shared_ptr
+#include "state_map.h"  // for state_vector_map, string_vector
+#include "dynamical_system.h"
+#include "output_observer.h"
+
+/**
+ *  @class output_point_collector
+ *
+ *  @brief Calculates the output quantities of a system at each output time
+ *  point as an ODE solver reaches it, and either stores them or passes them to
+ *  an `output_observer`.
+ *
+ *  This is an alternative to storing the differential quantities during the
+ *  integration and calculating the other outputs afterwards with
+ *  `get_results_from_system`. The outputs are calculated the same number of
+ *  times either way, but an observer receives each point while the
+ *  integration is running, and the quantities for the most recent point are
+ *  available to anything else that needs them, such as `stopping_criteria`.
+ *
+ *  It should only be used with systems whose modules do not keep state between
+ *  calls, since the output points are calculated in between the derivative
+ *  calculations of the integration.
+ */
+class output_point_collector
+{
+   public:
+    output_point_collector(
+        std::shared_ptr<dynamical_system> sys,
+        output_observer* recorder)
+        : sys{sys},
+          recorder{recorder},
+          output_names{sys->get_output_quantity_names()},
+          output_ptrs{sys->get_quantity_access_ptrs(output_names)},
+          columns(recorder ? 0 : output_names.size())
+    {
+    }
+
+    // Updates all of the system's quantities for a point and then stores the
+    // outputs or passes them to the observer
+    template <typename vector_type>
+    void collect(vector_type const& x, double t)
+    {
+        sys->update_all_quantities(x, t);
+        ++npoints;
+
+        if (recorder) {
+            recorder->record();
+            return;
+        }
+
+        for (size_t i = 0; i < output_ptrs.size(); ++i) {
+            columns[i].push_back(*output_ptrs[i]);
+        }
+    }
+
+    // Returns the stored outputs along with the number of derivative
+    // calculations, or an empty table if the points were passed to an observer
+    state_vector_map get_results() const
+    {
+        state_vector_map results;
+        if (recorder) {
+            return results;
+        }
+
+        for (size_t i = 0; i < output_names.size(); ++i) {
+            results[output_names[i]] = columns[i];
+        }
+        results["ncalls"] = std::vector<double>(npoints, sys->get_ncalls());
+
+        return results;
+    }
+
+   private:
+    std::shared_ptr<dynamical_system> const sys;
+    output_observer* const recorder;
+    string_vector const output_names;
+    std::vector<const double*> const output_ptrs;
+    std::vector<std::vector<double>> columns;
+    size_t npoints = 0;
+};
+
+#endif
@@ -0,0 +1,10 @@
+#include "parallel_jacobian.h"
+
+void parallel_jacobian_calculator::initialize()
+{
+    systems.push_back(sys);
+    for (size_t k = 1; k < nthreads; ++k) {
+        systems.push_back(std::make_shared<dynamical_system>(*sys));
+    }
+    pool.reset(new thread_pool(nthreads));
+}
@@ -0,0 +1,89 @@
+#ifndef PARALLEL_JACOBIAN_H
+#define PARALLEL_JACOBIAN_H
+
+#include <memory>  // for std::shared_ptr, std::unique_ptr
+#include <vector>
+#include "dynamical_system.h"
+#include "numerical_jacobian.h"
+#include "utils/thread_pool.h"
+
+/**
+ * @class parallel_jacobian_calculator
+ *
+ * @brief Estimates the Jacobian matrix and time derivative of a
+ * `dynamical_system` using several threads.
+ *
+ * Each column of the matrix requires a separate derivative calculation, but
+ * the calculations can't share one `dynamical_system` because each of them
+ * changes its quantity maps. So each worker thread uses its own copy of the
+ * system, and the columns are divided among the workers. The first worker is
+ * the calling thread, which uses the original system.
+ *
+ * The copies and threads are only made the first time a matrix is requested.
+ * The derivatives calculated by the copies are added to the original system's
+ * count, so the usage report is the same as for a serial calculation.
+ */
+class parallel_jacobian_calculator
+{
+   public:
+    parallel_jacobian_calculator(std::shared_ptr<dynamical_system> sys, size_t nthreads)
+        : sys(sys), nthreads(nthreads)
+    {
+    }
+
+    template <typename state_type, typename jacobi_type, typename time_type>
+    void calculate(state_type const& x, time_type t, jacobi_type& jacobi, state_type& dfdt);
+
+   private:
+    std::shared_ptr<dynamical_system> sys;
+    size_t const nthreads;
+
+    // One system for each worker; the first is `sys` itself
+    std::vector<std::shared_ptr<dynamical_system>> systems;
+    std::unique_ptr<thread_pool> pool;
+
+    void initialize();
+};
+
+/**
+ * @brief Fills `jacobi` with df_j/dx_i and `dfdt` with df_j/dt, evaluated at
+ * (x, t), just as `calculate_jacobian_and_time_derivative` does.
+ */
+template <typename state_type, typename jacobi_type, typename time_type>
+void parallel_jacobian_calculator::calculate(
+    state_type const& x,
+    time_type t,
+    jacobi_type& jacobi,
+    state_type& dfdt)
+{
+    if (!pool) {
+        initialize();
+    }
+
+    size_t const n = x.size();
+    double const max_time = sys->get_ntimes() - 1.0;
+
+    state_type f_current(n);
+    evaluate_equations(sys, x, t, f_current);
+
+    // Each worker needs its own working vectors
+    std::vector<state_type> x_perturbed(systems.size(), x);
+    std::vector<state_type> f_perturbed(systems.size(), state_type(n));
+
+    // There is one task for each column, plus one for the time derivative
+    pool->run(n + 1, [&](size_t i, size_t worker) {
+        if (i < n) {
+            calculate_jacobian_column(systems[worker], x, t, f_current, i,
+                                      x_perturbed[worker], f_perturbed[worker], jacobi);
+        } else {
+            calculate_time_derivative(systems[worker], max_time, x, t, f_current, dfdt);
+        }
+    });
+
+    for (size_t k = 1; k < systems.size(); ++k) {
+        sys->count_derivative_calls(systems[k]->get_ncalls());
+        systems[k]->reset_ncalls();
+    }
+}
+
+#endif
@@ -0,0 +1,77 @@
+#include <algorithm>  // for std::min, std::max
+#include <limits>     // for std::numeric_limits
+#include "solver_diagnostics.h"
+
+/**
+ *  @brief Clears any previous record and starts counting derivative calls and
+ *  Jacobian evaluations from the system's current totals.
+ */
+void solver_diagnostics::attach(dynamical_system const& sys)
+{
+    this->sys = &sys;
+    previous_ncalls = sys.get_ncalls();
+    previous_njacobians = sys.get_njacobians();
+    reset_interval();
+
+    accepted_steps_vec.clear();
+    rejected_steps_vec.clear();
+    derivative_calls_vec.clear();
+    jacobian_evaluations_vec.clear();
+    min_step_size_vec.clear();
+    max_step_size_vec.clear();
+}
+
+void solver_diagnostics::record_step(double step_size)
+{
+    if (accepted_steps == 0) {
+        min_step_size = step_size;
+        max_step_size = step_size;
+    } else {
+        min_step_size = std::min(min_step_size, step_size);
+        max_step_size = std::max(max_step_size, step_size);
+    }
+    ++accepted_steps;
+}
+
+void solver_diagnostics::record_output()
+{
+    int const ncalls = sys->get_ncalls();
+    int const njacobians = sys->get_njacobians();
+
+    double const nan = std::numeric_limits<double>::quiet_NaN();
+
+    accepted_steps_vec.push_back(accepted_steps);
+    rejected_steps_vec.push_back(rejections_known ? rejected_steps : nan);
+    derivative_calls_vec.push_back(ncalls - previous_ncalls);
+    jacobian_evaluations_vec.push_back(njacobians - previous_njacobians);
+    min_step_size_vec.push_back(accepted_steps > 0 ? min_step_size : nan);
+    max_step_size_vec.push_back(accepted_steps > 0 ? max_step_size : nan);
+
+    previous_ncalls = ncalls;
+    previous_njacobians = njacobians;
+    reset_interval();
+}
+
+void solver_diagnostics::reset_interval()
+{
+    accepted_steps = 0;
+    rejected_steps = 0;
+    rejections_known = true;
+    min_step_size = 0.0;
+    max_step_size = 0.0;
+}
+
+/**
+ *  @brief Returns a table with one row for each output time point; see the
+ *  class description for the meaning of each column.
+ */
+state_vector_map solver_diagnostics::get_results() const
+{
+    return state_vector_map{
+        {"accepted_steps", accepted_steps_vec},
+        {"rejected_steps", rejected_steps_vec},
+        {"derivative_calls", derivative_calls_vec},
+        {"jacobian_evaluations", jacobian_evaluations_vec},
+        {"min_step_size", min_step_size_vec},
+        {"max_step_size", max_step_size_vec}};
+}
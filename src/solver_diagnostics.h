@@ -0,0 +1,80 @@
+#ifndef SOLVER_DIAGNOSTICS_H
+#define SOLVER_DIAGNOSTICS_H
+
+#include <vector>
+#include "state_map.h"  // for state_vector_map
+#include "dynamical_system.h"
+
+/**
+ *  @class solver_diagnostics
+ *
+ *  @brief Records where an ODE solver spends its effort during a simulation.
+ *
+ *  The record is divided into intervals that end at the output time points, so
+ *  that the first interval ends at the first output point, and so on. For each
+ *  interval, the following are stored:
+ *
+ *  - `accepted_steps`: the number of steps taken by the solver
+ *
+ *  - `rejected_steps`: the number of step attempts that were rejected by an
+ *    adaptive solver's error control; this is `NaN` for intervals where the
+ *    solver could not report its rejections
+ *
+ *  - `derivative_calls`: the number of times the derivatives of the
+ *    differential quantities were calculated, including the calculations
+ *    used to estimate Jacobian matrices
+ *
+ *  - `jacobian_evaluations`: the number of Jacobian matrices that were
+ *    estimated (only nonzero for implicit solvers)
+ *
+ *  - `min_step_size` and `max_step_size`: the smallest and largest accepted
+ *    steps, in units of the driver time step; these are `NaN` for intervals
+ *    without any steps
+ *
+ *  After it has been attached to a `dynamical_system`, the ODE solver should
+ *  call `record_step` after each accepted step, `record_rejection` after each
+ *  rejected one, and `record_output` at each output time point. A solver that
+ *  cannot see its rejected attempts should call `record_unknown_rejections`
+ *  instead of `record_rejection`.
+ */
+class solver_diagnostics
+{
+   public:
+    void attach(dynamical_system const& sys);
+
+    void record_step(double step_size);
+
+    void record_rejection() { ++rejected_steps; }
+
+    void record_unknown_rejections() { rejections_known = false; }
+
+    void record_output();
+
+    state_vector_map get_results() const;
+
+   private:
+    dynamical_system const* sys = nullptr;
+
+    // Totals at the end of the previous interval
+    int previous_ncalls = 0;
+    int previous_njacobians = 0;
+
+    // The current interval
+    int accepted_steps = 0;
+    int rejected_steps = 0;
+    bool rejections_known = true;
+    double min_step_size = 0.0;
+    double max_step_size = 0.0;
+
+    // Finished intervals
+    std::vector<double> accepted_steps_vec;
+    std::vector<double> rejected_steps_vec;
+    std::vector<double> derivative_calls_vec;
+    std::vector<double> jacobian_evaluations_vec;
+    std::vector<double> min_step_size_vec;
+    std::vector<double> max_step_size_vec;
+
+    void reset_interval();
+};
+
+#endif
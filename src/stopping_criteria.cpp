@@ -0,0 +1,100 @@
+#include <algorithm>  // for std::find
+#include <stdexcept>  // for std::out_of_range
+#include "stopping_criteria.h"
+
+stopping_criteria::stopping_criteria(std::vector<stopping_condition> const& specs)
+{
+    for (stopping_condition const& c : specs) {
+        condition_state s;
+        s.spec = c;
+
+        if (c.comparison == ">=") {
+            s.comparison = comparison_type::greater_or_equal;
+        } else if (c.comparison == ">") {
+            s.comparison = comparison_type::greater;
+        } else if (c.comparison == "<=") {
+            s.comparison = comparison_type::less_or_equal;
+        } else if (c.comparison == "<") {
+            s.comparison = comparison_type::less;
+        } else {
+            throw std::out_of_range(
+                std::string("\"") + c.comparison + std::string("\" was given ") +
+                std::string("as a comparison for the stopping condition on \"") +
+                c.quantity + std::string("\", but it must be one of `>=`, ") +
+                std::string("`>`, `<=`, or `<`.\n"));
+        }
+
+        conditions.push_back(s);
+    }
+}
+
+/**
+ *  @brief Gets pointers to each quantity in the system's internally stored
+ *  quantity map, and resets the information about the most recent simulation.
+ */
+void stopping_criteria::attach(dynamical_system const& sys)
+{
+    string_vector const output_names = sys.get_output_quantity_names();
+
+    for (condition_state& s : conditions) {
+        if (std::find(output_names.begin(), output_names.end(), s.spec.quantity) == output_names.end()) {
+            throw std::out_of_range(
+                std::string("\"") + s.spec.quantity + std::string("\" was ") +
+                std::string("given as a stopping condition quantity, but it ") +
+                std::string("is not an output of the system.\n"));
+        }
+        s.value_ptr = sys.get_quantity_access_ptrs({s.spec.quantity})[0];
+    }
+
+    bool const has_time =
+        std::find(output_names.begin(), output_names.end(), "time") != output_names.end();
+    time_ptr = has_time ? sys.get_quantity_access_ptrs({"time"})[0] : nullptr;
+
+    met = false;
+}
+
+bool stopping_criteria::is_met()
+{
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        condition_state const& s = conditions[i];
+        double const value = *s.value_ptr;
+
+        bool condition_met = false;
+        switch (s.comparison) {
+            case comparison_type::greater_or_equal:
+                condition_met = value >= s.spec.threshold;
+                break;
+            case comparison_type::greater:
+                condition_met = value > s.spec.threshold;
+                break;
+            case comparison_type::less_or_equal:
+                condition_met = value <= s.spec.threshold;
+                break;
+            case comparison_type::less:
+                condition_met = value < s.spec.threshold;
+                break;
+        }
+
+        if (condition_met) {
+            met = true;
+            met_index = i;
+            met_time = time_ptr ? *time_ptr : 0.0;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string stopping_criteria::generate_report() const
+{
+    if (!met) {
+        return std::string("No stopping condition was met\n");
+    }
+
+    stopping_condition const& c = conditions[met_index].spec;
+    return std::string("The simulation was stopped because the condition `") +
+           c.quantity + std::string(" ") + c.comparison + std::string(" ") +
+           std::to_string(c.threshold) + std::string("` was met") +
+           (time_ptr ? std::string(" at time ") + std::to_string(met_time) : std::string("")) +
+           std::string("\n");
+}
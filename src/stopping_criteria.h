@@ -0,0 +1,65 @@
+#ifndef STOPPING_CRITERIA_H
+#define STOPPING_CRITERIA_H
+
+#include <vector>
+#include <string>
+#include "state_map.h"  // for string_vector
+#include "dynamical_system.h"
+
+/**
+ *  @brief Describes a condition on one output quantity that ends a simulation
+ *  when it is met, such as `DVI >= 2` at crop maturity. `comparison` must be
+ *  one of `>=`, `>`, `<=`, or `<`.
+ */
+struct stopping_condition {
+    std::string quantity;
+    std::string comparison;
+    double threshold;
+};
+
+/**
+ *  @class stopping_criteria
+ *
+ *  @brief Checks a set of stopping conditions at each output time point of a
+ *  simulation.
+ *
+ *  After it has been attached to a `dynamical_system`, the `is_met` method
+ *  should be called once for each output time point, after the system's
+ *  quantities have been updated for that point. It returns true as soon as any
+ *  of the conditions is met. The ODE solvers include that point in their
+ *  output and then stop integrating, so the output table is truncated at the
+ *  first time point where a condition holds.
+ */
+class stopping_criteria
+{
+   public:
+    stopping_criteria(std::vector<stopping_condition> const& specs);
+
+    void attach(dynamical_system const& sys);
+
+    bool is_met();
+
+    std::string generate_report() const;
+
+   private:
+    enum class comparison_type { greater_or_equal,
+                                 greater,
+                                 less_or_equal,
+                                 less };
+
+    struct condition_state {
+        stopping_condition spec;
+        comparison_type comparison;
+        const double* value_ptr = nullptr;
+    };
+
+    std::vector<condition_state> conditions;
+    const double* time_ptr = nullptr;
+
+    // Information about the most recent simulation
+    bool met = false;
+    size_t met_index = 0;
+    double met_time = 0.0;
+};
+
+#endif
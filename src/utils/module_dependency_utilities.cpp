@@ -1,6 +1,7 @@
 #include "module_dependency_utilities.h"
 
 #include <boost/config.hpp> // put this first to suppress some VC++ warnings
+#include <algorithm> // for any_of
 #include <boost/graph/adjacency_list.hpp> // for adjacency_list
 #include <boost/graph/topological_sort.hpp> // for dfs_visitor and not_a_dag
 
@@ -351,3 +352,51 @@ string_vector get_evaluation_order(string_vector module_names) {
 
     return ordered_module_list;
 }
+
+/**
+ *  @brief Given a list of direct module names in a suitable evaluation
+ *  order, returns the ones that must be run to calculate the quantities
+ *  in `quantity_names`.
+ *
+ *  A module is needed if one of its outputs is in `quantity_names` or
+ *  is an input of another module that is needed. Since each module in
+ *  the list depends only on modules that occur earlier, the needed
+ *  modules can be found with a single pass through the list in reverse
+ *  order.
+ *
+ *  @param ordered_module_names A list (presented as a vector of
+ *                              strings) of names of direct modules,
+ *                              such as one returned by
+ *                              `get_evaluation_order`.
+ *
+ *  @param quantity_names The names of the quantities whose values are
+ *                        required; quantities that are not calculated
+ *                        by any of the modules are ignored.
+ *
+ *  @return The needed modules, in the same order as in
+ *          `ordered_module_names`.
+ */
+string_vector get_upstream_modules(
+    string_vector const& ordered_module_names,
+    string_vector const& quantity_names) {
+    string_set required(quantity_names.begin(), quantity_names.end());
+
+    string_vector upstream_modules;
+
+    for (auto it = ordered_module_names.rbegin(); it != ordered_module_names.rend(); ++it) {
+        string_vector const outputs = get_module_outputs(*it);
+
+        bool const is_needed = std::any_of(
+            outputs.begin(), outputs.end(),
+            [&required](string const& q) { return required.count(q) > 0; });
+
+        if (is_needed) {
+            upstream_modules.insert(upstream_modules.begin(), *it);
+
+            string_vector const inputs = get_module_inputs(*it);
+            required.insert(inputs.begin(), inputs.end());
+        }
+    }
+
+    return upstream_modules;
+}
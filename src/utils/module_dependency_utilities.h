@@ -12,4 +12,8 @@ bool has_cyclic_dependency(string_vector module_names);
 
 bool order_ok(string_vector module_names);
 
+string_vector get_upstream_modules(
+    string_vector const& ordered_module_names,
+    string_vector const& quantity_names);
+
 #endif
@@ -0,0 +1,445 @@
+#include <algorithm>  // for std::upper_bound, std::min, std::max, std::find
+#include <cmath>      // for std::abs, std::isnan, std::isfinite
+#include <cstdint>    // for uint64_t
+#include <fstream>
+#include <random>     // for std::mt19937, std::uniform_int_distribution
+#include <stdexcept>  // for std::runtime_error, std::out_of_range
+#include "response_surface.h"
+#include "module_dependency_utilities.h"   // for get_evaluation_order
+#include "../validate_dynamical_system.h"  // for find_unique_module_inputs, get_module_vector
+#include "../modules.h"                    // for module_vector, run_module_list
+
+constexpr size_t response_surface::max_axes;
+
+namespace
+{
+// Identifies response surface files and the version of their layout
+char const file_signature[8] = {'B', 'C', 'R', 'S', 'U', 'R', 'F', '1'};
+
+void write_size(std::ofstream& out, size_t n)
+{
+    uint64_t const value = n;
+    out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+}
+
+void write_string(std::ofstream& out, std::string const& s)
+{
+    write_size(out, s.size());
+    out.write(s.data(), s.size());
+}
+
+void write_doubles(std::ofstream& out, std::vector<double> const& v)
+{
+    write_size(out, v.size());
+    out.write(reinterpret_cast<char const*>(v.data()), v.size() * sizeof(double));
+}
+
+size_t read_size(std::ifstream& in)
+{
+    uint64_t value = 0;
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    if (!in) {
+        throw std::runtime_error("The response surface file ended unexpectedly.\n");
+    }
+    return value;
+}
+
+std::string read_string(std::ifstream& in)
+{
+    std::string s(read_size(in), '\0');
+    in.read(&s[0], s.size());
+    return s;
+}
+
+std::vector<double> read_doubles(std::ifstream& in)
+{
+    std::vector<double> v(read_size(in));
+    in.read(reinterpret_cast<char*>(v.data()), v.size() * sizeof(double));
+    return v;
+}
+}  // namespace
+
+/**
+ *  @brief Runs the modules at each node of the grid and stores the named
+ *  outputs, then estimates the accuracy of the interpolation at the centres of
+ *  up to `ncheck` grid cells
+ */
+response_surface response_surface::tabulate(
+    string_vector const& module_names,
+    state_map const& fixed_inputs,
+    string_vector const& axis_names,
+    std::vector<std::vector<double>> const& axis_points,
+    string_vector const& output_names,
+    size_t ncheck)
+{
+    response_surface rs;
+    rs.module_names = get_evaluation_order(module_names);
+    rs.fixed_inputs = fixed_inputs;
+    rs.axis_names = axis_names;
+    rs.axis_points = axis_points;
+    rs.output_names = output_names;
+    rs.check_axes();
+    rs.find_strides();
+
+    // Form the quantities used by the modules
+    state_map quantities = fixed_inputs;
+
+    for (std::string const& name : axis_names) {
+        if (quantities.count(name) > 0) {
+            throw std::runtime_error(
+                std::string("\"") + name + std::string("\" was given as both ") +
+                std::string("a grid axis and a fixed input.\n"));
+        }
+        quantities[name] = 0.0;
+    }
+
+    string_set const module_outputs = find_unique_module_outputs({rs.module_names});
+    for (std::string const& name : module_outputs) {
+        if (quantities.count(name) > 0) {
+            throw std::runtime_error(
+                std::string("\"") + name + std::string("\" is an output of ") +
+                std::string("one of the modules, so it cannot be a grid axis ") +
+                std::string("or a fixed input.\n"));
+        }
+        quantities[name] = 0.0;
+    }
+
+    std::string missing;
+    for (std::string const& name : find_unique_module_inputs({rs.module_names})) {
+        if (quantities.count(name) == 0) {
+            missing += std::string(" ") + name;
+        }
+    }
+    if (!missing.empty()) {
+        throw std::runtime_error(
+            std::string("The following module inputs were not given as grid ") +
+            std::string("axes or fixed inputs:") + missing + std::string("\n"));
+    }
+
+    if (rs.output_names.empty()) {
+        rs.output_names.assign(module_outputs.begin(), module_outputs.end());
+    }
+    for (std::string const& name : rs.output_names) {
+        if (module_outputs.count(name) == 0) {
+            throw std::runtime_error(
+                std::string("\"") + name + std::string("\" was given as an ") +
+                std::string("output, but it is not an output of any of the modules.\n"));
+        }
+    }
+
+    // Create the modules
+    module_vector modules = get_module_vector(rs.module_names, quantities, &quantities);
+    for (size_t i = 0; i < modules.size(); ++i) {
+        if (modules[i]->is_differential()) {
+            throw std::runtime_error(
+                std::string("\"") + rs.module_names[i] + std::string("\" is a ") +
+                std::string("differential module, but only direct modules can be tabulated.\n"));
+        }
+    }
+
+    size_t const naxes = axis_names.size();
+    size_t const noutputs = rs.output_names.size();
+
+    std::vector<double*> axis_ptrs;
+    for (std::string const& name : axis_names) {
+        axis_ptrs.push_back(&quantities.at(name));
+    }
+
+    std::vector<double const*> output_ptrs;
+    for (std::string const& name : rs.output_names) {
+        output_ptrs.push_back(&quantities.at(name));
+    }
+
+    auto evaluate = [&](double const* x, double* outputs) {
+        for (size_t a = 0; a < naxes; ++a) {
+            *axis_ptrs[a] = x[a];
+        }
+        run_module_list(modules);
+        for (size_t j = 0; j < noutputs; ++j) {
+            outputs[j] = *output_ptrs[j];
+        }
+    };
+
+    // Run the modules at each node, with the last axis varying fastest
+    size_t const nnodes = rs.strides[0] * axis_points[0].size();
+    rs.values.resize(nnodes * noutputs);
+
+    std::vector<double> x(naxes);
+    for (size_t node = 0; node < nnodes; ++node) {
+        for (size_t a = 0; a < naxes; ++a) {
+            x[a] = axis_points[a][(node / rs.strides[a]) % axis_points[a].size()];
+        }
+        evaluate(x.data(), &rs.values[node * noutputs]);
+
+        // An undefined value would spoil the interpolation throughout the
+        // surrounding cells, so report the node where it occurred
+        for (size_t j = 0; j < noutputs; ++j) {
+            if (!std::isfinite(rs.values[node * noutputs + j])) {
+                std::string location;
+                for (size_t a = 0; a < naxes; ++a) {
+                    location += std::string(" ") + axis_names[a] +
+                                std::string(" = ") + std::to_string(x[a]);
+                }
+                throw std::runtime_error(
+                    std::string("The modules calculated a value of \"") +
+                    rs.output_names[j] + std::string("\" that is not finite ") +
+                    std::string("at the grid node where") + location +
+                    std::string(".\n"));
+            }
+        }
+    }
+
+    // Compare the modules and the interpolation at the cell centres
+    size_t ncells = 1;
+    for (auto const& points : axis_points) {
+        ncells *= points.size() - 1;
+    }
+
+    rs.ncheck = std::min(ncheck, ncells);
+    rs.estimated_abs_errors.assign(noutputs, 0.0);
+
+    std::mt19937 generator(0);
+    std::vector<double> exact(noutputs);
+    std::vector<double> interpolated(noutputs);
+
+    for (size_t c = 0; c < rs.ncheck; ++c) {
+        size_t cell = c;
+        if (ncells > ncheck) {
+            cell = std::uniform_int_distribution<size_t>(0, ncells - 1)(generator);
+        }
+
+        for (size_t a = naxes; a-- > 0;) {
+            size_t const ncells_on_axis = axis_points[a].size() - 1;
+            size_t const i = cell % ncells_on_axis;
+            cell /= ncells_on_axis;
+            x[a] = 0.5 * (axis_points[a][i] + axis_points[a][i + 1]);
+        }
+
+        evaluate(x.data(), exact.data());
+        rs.interpolate(x.data(), interpolated.data());
+
+        for (size_t j = 0; j < noutputs; ++j) {
+            double const error = std::abs(exact[j] - interpolated[j]);
+            if (error > rs.estimated_abs_errors[j] || std::isnan(error)) {
+                rs.estimated_abs_errors[j] = error;
+            }
+        }
+    }
+
+    return rs;
+}
+
+/**
+ *  @brief Reads a table that was written by `save`
+ */
+response_surface response_surface::load(std::string const& file_name)
+{
+    std::ifstream in(file_name, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error(
+            std::string("The response surface file \"") + file_name +
+            std::string("\" could not be opened.\n"));
+    }
+
+    char signature[sizeof(file_signature)];
+    in.read(signature, sizeof(signature));
+    if (!in || !std::equal(signature, signature + sizeof(signature), file_signature)) {
+        throw std::runtime_error(
+            std::string("\"") + file_name +
+            std::string("\" is not a response surface file.\n"));
+    }
+
+    response_surface rs;
+
+    size_t const nmodules = read_size(in);
+    for (size_t i = 0; i < nmodules; ++i) {
+        rs.module_names.push_back(read_string(in));
+    }
+
+    size_t const nfixed = read_size(in);
+    for (size_t i = 0; i < nfixed; ++i) {
+        std::string const name = read_string(in);
+        rs.fixed_inputs[name] = read_doubles(in).at(0);
+    }
+
+    size_t const naxes = read_size(in);
+    for (size_t i = 0; i < naxes; ++i) {
+        rs.axis_names.push_back(read_string(in));
+        rs.axis_points.push_back(read_doubles(in));
+    }
+
+    size_t const noutputs = read_size(in);
+    for (size_t i = 0; i < noutputs; ++i) {
+        rs.output_names.push_back(read_string(in));
+    }
+
+    rs.values = read_doubles(in);
+    rs.estimated_abs_errors = read_doubles(in);
+    rs.ncheck = read_size(in);
+
+    rs.check_axes();
+    rs.find_strides();
+
+    if (rs.values.size() != rs.strides[0] * rs.axis_points[0].size() * noutputs ||
+        rs.estimated_abs_errors.size() != noutputs) {
+        throw std::runtime_error(
+            std::string("The response surface file \"") + file_name +
+            std::string("\" is incomplete.\n"));
+    }
+
+    return rs;
+}
+
+/**
+ *  @brief Writes the table to a binary file
+ */
+void response_surface::save(std::string const& file_name) const
+{
+    std::ofstream out(file_name, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error(
+            std::string("The response surface file \"") + file_name +
+            std::string("\" could not be opened for writing.\n"));
+    }
+
+    out.write(file_signature, sizeof(file_signature));
+
+    write_size(out, module_names.size());
+    for (std::string const& name : module_names) {
+        write_string(out, name);
+    }
+
+    write_size(out, fixed_inputs.size());
+    for (auto const& x : fixed_inputs) {
+        write_string(out, x.first);
+        write_doubles(out, {x.second});
+    }
+
+    write_size(out, axis_names.size());
+    for (size_t a = 0; a < axis_names.size(); ++a) {
+        write_string(out, axis_names[a]);
+        write_doubles(out, axis_points[a]);
+    }
+
+    write_size(out, output_names.size());
+    for (std::string const& name : output_names) {
+        write_string(out, name);
+    }
+
+    write_doubles(out, values);
+    write_doubles(out, estimated_abs_errors);
+    write_size(out, ncheck);
+
+    if (!out) {
+        throw std::runtime_error(
+            std::string("The response surface file \"") + file_name +
+            std::string("\" could not be written.\n"));
+    }
+}
+
+/**
+ *  @brief Interpolates the outputs at the point `x`, whose values are given in
+ *  the order of the axes; values outside the grid are moved to its edges
+ */
+void response_surface::interpolate(double const* x, double* outputs) const
+{
+    size_t const naxes = axis_names.size();
+    size_t const noutputs = output_names.size();
+
+    // Find the cell containing the point and the fractional position of the
+    // point within the cell along each axis
+    double fractions[max_axes];
+    size_t base = 0;
+    for (size_t a = 0; a < naxes; ++a) {
+        std::vector<double> const& points = axis_points[a];
+        double const xa = std::min(std::max(x[a], points.front()), points.back());
+        size_t i = std::upper_bound(points.begin(), points.end(), xa) - points.begin();
+        i = std::min(i > 0 ? i - 1 : 0, points.size() - 2);
+        fractions[a] = (xa - points[i]) / (points[i + 1] - points[i]);
+        base += i * strides[a];
+    }
+
+    for (size_t j = 0; j < noutputs; ++j) {
+        outputs[j] = 0.0;
+    }
+
+    // Add the contribution from each corner of the cell
+    for (size_t corner = 0; corner < (size_t(1) << naxes); ++corner) {
+        double weight = 1.0;
+        size_t node = base;
+        for (size_t a = 0; a < naxes; ++a) {
+            if (corner & (size_t(1) << a)) {
+                weight *= fractions[a];
+                node += strides[a];
+            } else {
+                weight *= 1.0 - fractions[a];
+            }
+        }
+
+        if (weight == 0.0) {
+            continue;
+        }
+
+        for (size_t j = 0; j < noutputs; ++j) {
+            outputs[j] += weight * values[node * noutputs + j];
+        }
+    }
+}
+
+/**
+ *  @brief Returns the difference between the largest and smallest tabulated
+ *  values of each output
+ */
+std::vector<double> response_surface::get_output_ranges() const
+{
+    size_t const noutputs = output_names.size();
+    std::vector<double> lowest(noutputs, INFINITY);
+    std::vector<double> highest(noutputs, -INFINITY);
+
+    for (size_t k = 0; k < values.size(); ++k) {
+        lowest[k % noutputs] = std::min(lowest[k % noutputs], values[k]);
+        highest[k % noutputs] = std::max(highest[k % noutputs], values[k]);
+    }
+
+    std::vector<double> ranges(noutputs);
+    for (size_t j = 0; j < noutputs; ++j) {
+        ranges[j] = highest[j] - lowest[j];
+    }
+    return ranges;
+}
+
+void response_surface::check_axes() const
+{
+    if (axis_names.empty() || axis_names.size() > max_axes) {
+        throw std::out_of_range(
+            std::string("A response surface must have between 1 and ") +
+            std::to_string(max_axes) + std::string(" grid axes.\n"));
+    }
+
+    if (axis_points.size() != axis_names.size()) {
+        throw std::runtime_error(
+            std::string("Each grid axis must have a name and a set of points.\n"));
+    }
+
+    for (size_t a = 0; a < axis_names.size(); ++a) {
+        std::vector<double> const& points = axis_points[a];
+        bool ok = points.size() >= 2;
+        for (size_t i = 0; ok && i < points.size(); ++i) {
+            ok = std::isfinite(points[i]) && (i == 0 || points[i] > points[i - 1]);
+        }
+        if (!ok) {
+            throw std::runtime_error(
+                std::string("The points for the \"") + axis_names[a] +
+                std::string("\" grid axis must be at least two finite values ") +
+                std::string("in increasing order.\n"));
+        }
+    }
+}
+
+void response_surface::find_strides()
+{
+    strides.assign(axis_points.size(), 1);
+    for (size_t a = axis_points.size() - 1; a-- > 0;) {
+        strides[a] = strides[a + 1] * axis_points[a + 1].size();
+    }
+}
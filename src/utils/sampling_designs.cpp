@@ -0,0 +1,277 @@
+#include <cstdint>    // for uint32_t, uint64_t
+#include <random>     // for std::mt19937, std::uniform_int_distribution, std::uniform_real_distribution
+#include <stdexcept>  // for std::out_of_range
+#include <string>
+#include <utility>    // for std::swap
+#include "sampling_designs.h"
+
+namespace
+{
+// The initial direction numbers m_1, ..., m_s for dimensions 2 through 65,
+// from the `new-joe-kuo-6.21201` table of Joe and Kuo (2008)
+std::vector<std::vector<uint32_t>> const joe_kuo_initial_numbers{
+    {1},
+    {1, 3},
+    {1, 3, 1},
+    {1, 1, 1},
+    {1, 1, 3, 3},
+    {1, 3, 5, 13},
+    {1, 1, 5, 5, 17},
+    {1, 1, 5, 5, 5},
+    {1, 1, 7, 11, 19},
+    {1, 1, 5, 1, 1},
+    {1, 1, 1, 3, 11},
+    {1, 3, 5, 5, 31},
+    {1, 3, 3, 9, 7, 49},
+    {1, 1, 1, 15, 21, 21},
+    {1, 3, 1, 13, 27, 49},
+    {1, 1, 1, 15, 7, 5},
+    {1, 3, 1, 15, 13, 25},
+    {1, 1, 5, 5, 19, 61},
+    {1, 3, 7, 11, 23, 15, 103},
+    {1, 3, 7, 13, 13, 15, 69},
+    {1, 1, 3, 13, 7, 35, 63},
+    {1, 3, 5, 9, 1, 25, 53},
+    {1, 3, 1, 13, 9, 35, 107},
+    {1, 3, 1, 5, 27, 61, 31},
+    {1, 1, 5, 11, 19, 41, 61},
+    {1, 3, 5, 3, 3, 13, 69},
+    {1, 1, 7, 13, 1, 19, 1},
+    {1, 3, 7, 5, 13, 19, 59},
+    {1, 1, 3, 9, 25, 29, 41},
+    {1, 3, 5, 13, 23, 1, 55},
+    {1, 3, 7, 3, 13, 59, 17},
+    {1, 3, 1, 3, 5, 53, 69},
+    {1, 1, 5, 5, 23, 33, 13},
+    {1, 1, 7, 7, 1, 61, 123},
+    {1, 1, 7, 9, 13, 61, 49},
+    {1, 3, 3, 5, 3, 55, 33},
+    {1, 3, 1, 15, 31, 13, 49, 245},
+    {1, 3, 5, 15, 31, 59, 63, 97},
+    {1, 3, 1, 11, 11, 11, 77, 249},
+    {1, 3, 1, 11, 27, 43, 71, 9},
+    {1, 1, 7, 15, 21, 11, 81, 45},
+    {1, 3, 7, 3, 25, 31, 65, 79},
+    {1, 3, 1, 1, 19, 11, 3, 205},
+    {1, 1, 5, 9, 19, 21, 29, 157},
+    {1, 3, 7, 11, 1, 33, 89, 185},
+    {1, 3, 3, 3, 15, 9, 79, 71},
+    {1, 3, 7, 11, 15, 39, 119, 27},
+    {1, 1, 3, 1, 11, 31, 97, 225},
+    {1, 1, 1, 3, 23, 43, 57, 177},
+    {1, 3, 7, 7, 17, 17, 37, 71},
+    {1, 3, 1, 5, 27, 63, 123, 213},
+    {1, 1, 3, 5, 11, 43, 53, 133},
+    {1, 3, 5, 5, 29, 17, 47, 173, 479},
+    {1, 3, 3, 11, 3, 1, 109, 9, 69},
+    {1, 1, 1, 5, 17, 39, 23, 5, 343},
+    {1, 3, 1, 5, 25, 15, 31, 103, 499},
+    {1, 1, 1, 11, 11, 17, 63, 105, 183},
+    {1, 1, 5, 11, 9, 29, 97, 231, 363},
+    {1, 1, 5, 15, 19, 45, 41, 7, 383},
+    {1, 3, 7, 7, 31, 19, 83, 137, 221},
+    {1, 1, 1, 3, 23, 15, 111, 223, 83},
+    {1, 1, 5, 13, 31, 15, 55, 25, 161},
+    {1, 1, 3, 13, 25, 47, 39, 87, 257},
+    {1, 1, 1, 11, 21, 53, 125, 249, 293}};
+
+size_t const nbits = 32;
+
+// Multiplies two polynomials over GF(2) modulo a polynomial of the given
+// degree; each polynomial is represented by the bits of its coefficients
+uint64_t multiply_mod(uint64_t a, uint64_t b, uint64_t modulus, size_t degree)
+{
+    uint64_t product = 0;
+    while (b) {
+        if (b & 1) {
+            product ^= a;
+        }
+        b >>= 1;
+        a <<= 1;
+        if (a >> degree & 1) {
+            a ^= modulus;
+        }
+    }
+    return product;
+}
+
+// Raises x to a power modulo a polynomial over GF(2)
+uint64_t power_of_x_mod(uint64_t exponent, uint64_t modulus, size_t degree)
+{
+    uint64_t result = 1;
+    uint64_t base = degree > 1 ? 2 : 2 ^ modulus;  // x reduced modulo the polynomial
+    while (exponent) {
+        if (exponent & 1) {
+            result = multiply_mod(result, base, modulus, degree);
+        }
+        base = multiply_mod(base, base, modulus, degree);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+// A polynomial of degree s over GF(2) is primitive if x has multiplicative
+// order 2^s - 1 modulo the polynomial
+bool is_primitive(uint64_t polynomial, size_t degree)
+{
+    uint64_t const order = (uint64_t(1) << degree) - 1;
+
+    if (power_of_x_mod(order, polynomial, degree) != 1) {
+        return false;
+    }
+
+    uint64_t remaining = order;
+    for (uint64_t q = 2; q * q <= remaining; ++q) {
+        if (remaining % q == 0) {
+            if (power_of_x_mod(order / q, polynomial, degree) == 1) {
+                return false;
+            }
+            while (remaining % q == 0) {
+                remaining /= q;
+            }
+        }
+    }
+    if (remaining > 1 && remaining != order) {
+        return power_of_x_mod(order / remaining, polynomial, degree) != 1;
+    }
+    return true;
+}
+
+// Describes a primitive polynomial x^s + a_1 x^(s-1) + ... + a_(s-1) x + 1 by
+// its degree s and the bits a_1 ... a_(s-1), with a_1 the most significant
+struct primitive_polynomial {
+    size_t degree;
+    uint32_t coefficients;
+};
+
+// Returns the first `n` primitive polynomials in order of increasing degree
+// and, for each degree, increasing coefficients
+std::vector<primitive_polynomial> primitive_polynomials(size_t n)
+{
+    std::vector<primitive_polynomial> result;
+    for (size_t degree = 1; result.size() < n; ++degree) {
+        if (degree >= nbits) {
+            throw std::out_of_range(
+                std::string("A Sobol sequence cannot have this many dimensions.\n"));
+        }
+        for (uint32_t a = 0; a < (uint32_t(1) << (degree - 1)) && result.size() < n; ++a) {
+            uint64_t const polynomial = (uint64_t(1) << degree) | (uint64_t(a) << 1) | 1;
+            if (is_primitive(polynomial, degree)) {
+                result.push_back({degree, a});
+            }
+        }
+    }
+    return result;
+}
+}  // namespace
+
+sobol_sequence::sobol_sequence(size_t ndims)
+    : directions(ndims, std::vector<uint32_t>(nbits)),
+      current(ndims, 0)
+{
+    if (ndims == 0) {
+        throw std::out_of_range(
+            std::string("A Sobol sequence must have at least one dimension.\n"));
+    }
+
+    // The first dimension is the van der Corput sequence in base 2
+    for (size_t k = 0; k < nbits; ++k) {
+        directions[0][k] = uint32_t(1) << (nbits - 1 - k);
+    }
+
+    std::vector<primitive_polynomial> const polynomials = primitive_polynomials(ndims - 1);
+    std::mt19937 generator(0);
+
+    for (size_t j = 1; j < ndims; ++j) {
+        size_t const s = polynomials[j - 1].degree;
+        uint32_t const a = polynomials[j - 1].coefficients;
+        std::vector<uint32_t>& v = directions[j];
+
+        // The initial direction numbers m_k must be odd and less than 2^k
+        for (size_t k = 0; k < s && k < nbits; ++k) {
+            uint32_t m;
+            if (j - 1 < joe_kuo_initial_numbers.size()) {
+                m = joe_kuo_initial_numbers[j - 1][k];
+            } else {
+                m = 2 * std::uniform_int_distribution<uint32_t>(0, (uint32_t(1) << k) - 1)(generator) + 1;
+            }
+            v[k] = m << (nbits - 1 - k);
+        }
+
+        // The remaining direction numbers follow from the polynomial
+        for (size_t k = s; k < nbits; ++k) {
+            v[k] = v[k - s] ^ (v[k - s] >> s);
+            for (size_t i = 1; i < s; ++i) {
+                if ((a >> (s - 1 - i)) & 1) {
+                    v[k] ^= v[k - i];
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  @brief Returns the next point of the sequence, using the Gray code ordering
+ *  of Antonov and Saleev so that each point only differs from the previous one
+ *  by a single direction number in each dimension.
+ */
+std::vector<double> sobol_sequence::next()
+{
+    if (index == UINT32_MAX) {
+        throw std::out_of_range(
+            std::string("A Sobol sequence cannot have more than 2^32 - 1 points.\n"));
+    }
+
+    std::vector<double> point(current.size());
+    for (size_t j = 0; j < current.size(); ++j) {
+        point[j] = current[j] * (1.0 / 4294967296.0);  // 2^-32
+    }
+
+    // The direction number used for the next point is chosen by the position
+    // of the lowest zero bit of the current index
+    size_t c = 0;
+    for (uint32_t i = index; i & 1; i >>= 1) {
+        ++c;
+    }
+    for (size_t j = 0; j < current.size(); ++j) {
+        current[j] ^= directions[j][c];
+    }
+    ++index;
+
+    return point;
+}
+
+/**
+ *  @brief Returns a Latin hypercube sample of `npoints` points in the unit
+ *  hypercube of dimension `ndims`.
+ *
+ *  Along each coordinate, exactly one point falls in each of the `npoints`
+ *  intervals of equal width, at a random position within it. The intervals
+ *  are matched to points by an independent random permutation for each
+ *  coordinate.
+ */
+std::vector<std::vector<double>> latin_hypercube(size_t npoints, size_t ndims, unsigned seed)
+{
+    std::vector<std::vector<double>> points(npoints, std::vector<double>(ndims));
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> offset(0.0, 1.0);
+
+    std::vector<size_t> intervals(npoints);
+    for (size_t j = 0; j < ndims; ++j) {
+        for (size_t i = 0; i < npoints; ++i) {
+            intervals[i] = i;
+        }
+
+        // Fisher-Yates shuffle
+        for (size_t i = npoints; i > 1; --i) {
+            size_t const k = std::uniform_int_distribution<size_t>(0, i - 1)(generator);
+            std::swap(intervals[i - 1], intervals[k]);
+        }
+
+        for (size_t i = 0; i < npoints; ++i) {
+            points[i][j] = (intervals[i] + offset(generator)) / npoints;
+        }
+    }
+
+    return points;
+}
@@ -0,0 +1,43 @@
+#ifndef SAMPLING_DESIGNS_H
+#define SAMPLING_DESIGNS_H
+
+#include <cstddef>  // for size_t
+#include <cstdint>  // for uint32_t
+#include <vector>
+
+/**
+ *  @class sobol_sequence
+ *
+ *  @brief Generates the points of a Sobol low-discrepancy sequence in the unit
+ *  hypercube, one at a time.
+ *
+ *  Each coordinate is a multiple of 2^-32, and the sequence begins with the
+ *  origin. The first 2^k points are evenly stratified along each coordinate,
+ *  so sample sizes that are powers of two give the most uniform coverage.
+ *
+ *  The direction numbers are derived from primitive polynomials over GF(2),
+ *  taken in order of increasing degree. The initial direction numbers for the
+ *  first 65 dimensions are those of Joe and Kuo (2008), which were chosen to
+ *  give uniform two-dimensional projections; later dimensions use odd initial
+ *  numbers chosen at random, which gives a valid but less uniform sequence.
+ */
+class sobol_sequence
+{
+   public:
+    explicit sobol_sequence(size_t ndims);
+
+    size_t get_ndims() const { return directions.size(); }
+
+    std::vector<double> next();
+
+   private:
+    // The direction numbers for each dimension, scaled to 32 bits
+    std::vector<std::vector<uint32_t>> directions;
+
+    std::vector<uint32_t> current;
+    uint32_t index = 0;
+};
+
+std::vector<std::vector<double>> latin_hypercube(size_t npoints, size_t ndims, unsigned seed);
+
+#endif
@@ -0,0 +1,116 @@
+#include <limits>     // for std::numeric_limits
+#include <stdexcept>  // for std::logic_error
+#include <string>
+#include "sobol_indices.h"
+
+namespace
+{
+double const undefined = std::numeric_limits<double>::quiet_NaN();
+}
+
+sobol_index_accumulator::sobol_index_accumulator(size_t nparams, size_t noutputs)
+    : nparams{nparams},
+      noutputs{noutputs},
+      pooled_means(noutputs, 0.0),
+      pooled_m2(noutputs, 0.0),
+      b_means(noutputs, 0.0),
+      difference_means(noutputs * nparams, 0.0),
+      comoments(noutputs * nparams, 0.0),
+      squared_differences(noutputs * nparams, 0.0)
+{
+}
+
+/**
+ *  @brief Adds the outputs of one Saltelli sample; `values` must contain
+ *  `noutputs` values for A, then for B, and then for each AB_i in turn.
+ */
+void sobol_index_accumulator::add(std::vector<double> const& values)
+{
+    if (values.size() != (nparams + 2) * noutputs) {
+        throw std::logic_error(
+            std::string("Thrown by sobol_index_accumulator::add: the ") +
+            std::string("sample has the wrong number of values.\n"));
+    }
+
+    ++nsamples;
+    double const n = static_cast<double>(nsamples);
+
+    for (size_t k = 0; k < noutputs; ++k) {
+        double const fa = values[k];
+        double const fb = values[noutputs + k];
+
+        // Pooled mean and variance of f(A) and f(B)
+        double const pooled_n = 2.0 * n;
+        double delta = fa - pooled_means[k];
+        pooled_means[k] += delta / (pooled_n - 1.0);
+        pooled_m2[k] += delta * (fa - pooled_means[k]);
+
+        delta = fb - pooled_means[k];
+        pooled_means[k] += delta / pooled_n;
+        pooled_m2[k] += delta * (fb - pooled_means[k]);
+
+        // Co-moments of f(B) with each f(AB_i) - f(A)
+        double const b_delta = fb - b_means[k];
+        b_means[k] += b_delta / n;
+
+        for (size_t i = 0; i < nparams; ++i) {
+            size_t const ki = k * nparams + i;
+            double const difference = values[(i + 2) * noutputs + k] - fa;
+
+            difference_means[ki] += (difference - difference_means[ki]) / n;
+            comoments[ki] += b_delta * (difference - difference_means[ki]);
+            squared_differences[ki] += difference * difference;
+        }
+    }
+}
+
+std::vector<double> sobol_index_accumulator::get_first_order_indices() const
+{
+    std::vector<double> const variances = get_variances();
+    std::vector<double> indices(noutputs * nparams, undefined);
+
+    for (size_t k = 0; k < noutputs; ++k) {
+        if (nsamples < 2 || !(variances[k] > 0)) {
+            continue;
+        }
+        for (size_t i = 0; i < nparams; ++i) {
+            size_t const ki = k * nparams + i;
+            indices[ki] = comoments[ki] / nsamples / variances[k];
+        }
+    }
+
+    return indices;
+}
+
+std::vector<double> sobol_index_accumulator::get_total_indices() const
+{
+    std::vector<double> const variances = get_variances();
+    std::vector<double> indices(noutputs * nparams, undefined);
+
+    for (size_t k = 0; k < noutputs; ++k) {
+        if (nsamples < 2 || !(variances[k] > 0)) {
+            continue;
+        }
+        for (size_t i = 0; i < nparams; ++i) {
+            size_t const ki = k * nparams + i;
+            indices[ki] = squared_differences[ki] / (2.0 * nsamples) / variances[k];
+        }
+    }
+
+    return indices;
+}
+
+/**
+ *  @brief Returns the variance of each output over the pooled values of f(A)
+ *  and f(B), normalized by the number of values.
+ */
+std::vector<double> sobol_index_accumulator::get_variances() const
+{
+    std::vector<double> variances(noutputs, undefined);
+    if (nsamples > 0) {
+        for (size_t k = 0; k < noutputs; ++k) {
+            variances[k] = pooled_m2[k] / (2.0 * nsamples);
+        }
+    }
+    return variances;
+}
@@ -0,0 +1,65 @@
+#ifndef SOBOL_INDICES_H
+#define SOBOL_INDICES_H
+
+#include <cstddef>  // for size_t
+#include <vector>
+
+/**
+ *  @class sobol_index_accumulator
+ *
+ *  @brief Estimates the first-order and total Sobol sensitivity indices of one
+ *  or more scalar outputs from a stream of Saltelli samples, keeping only
+ *  running sums rather than the sampled values.
+ *
+ *  Each sample consists of the outputs of a model evaluated at `nparams + 2`
+ *  points: a point A, a point B whose coordinates are drawn independently of
+ *  those of A, and, for each parameter i, the point AB_i that equals A except
+ *  for coordinate i, which is taken from B. The outputs are passed to `add` in
+ *  that order, with all the outputs of one point stored together.
+ *
+ *  The first-order index of parameter i is estimated as Cov(f(B), f(AB_i) -
+ *  f(A)) / V, which is the estimator of Saltelli et al. (2010) with f(B)
+ *  centred on its mean, and the total index is estimated as
+ *  E[(f(A) - f(AB_i))^2] / (2 V), the estimator of Jansen (1999). The output
+ *  variance V is estimated from the pooled values of f(A) and f(B). The means,
+ *  variances, and covariances are updated using Welford's method, so the
+ *  estimates do not lose precision when the outputs have large means.
+ *
+ *  An index is NaN when fewer than two samples have been added or when the
+ *  output variance is zero.
+ */
+class sobol_index_accumulator
+{
+   public:
+    sobol_index_accumulator(size_t nparams, size_t noutputs);
+
+    void add(std::vector<double> const& values);
+
+    size_t get_nsamples() const { return nsamples; }
+
+    // Each of these has one element for each output; the indices are stored
+    // with all the parameters of one output together
+    std::vector<double> get_first_order_indices() const;
+    std::vector<double> get_total_indices() const;
+    std::vector<double> get_means() const { return pooled_means; }
+    std::vector<double> get_variances() const;
+
+   private:
+    size_t const nparams;
+    size_t const noutputs;
+    size_t nsamples = 0;
+
+    // The pooled values of f(A) and f(B) for each output
+    std::vector<double> pooled_means;
+    std::vector<double> pooled_m2;
+
+    // The running mean of f(B) for each output, and the running mean of
+    // f(AB_i) - f(A), its co-moment with f(B), and the sum of its squares for
+    // each output and parameter
+    std::vector<double> b_means;
+    std::vector<double> difference_means;
+    std::vector<double> comoments;
+    std::vector<double> squared_differences;
+};
+
+#endif
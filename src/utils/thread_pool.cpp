@@ -0,0 +1,93 @@
+#include "thread_pool.h"
+
+thread_pool::thread_pool(size_t nworkers)
+{
+    for (size_t worker = 1; worker < nworkers; ++worker) {
+        threads.emplace_back(&thread_pool::wait_for_batches, this, worker);
+    }
+}
+
+thread_pool::~thread_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start_condition.notify_all();
+
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+/**
+ *  @brief Runs `task` for each index from 0 to `ntasks - 1`, returning when all
+ *  of them are finished
+ */
+void thread_pool::run(size_t ntasks, task_type const& task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        current_task = &task;
+        this->ntasks = ntasks;
+        next_task = 0;
+        nbusy = threads.size();
+        error = nullptr;
+        ++batch;
+    }
+    start_condition.notify_all();
+
+    do_tasks(0);
+
+    std::exception_ptr batch_error;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        done_condition.wait(lock, [this] { return nbusy == 0; });
+        current_task = nullptr;
+        batch_error = error;
+    }
+
+    if (batch_error) {
+        std::rethrow_exception(batch_error);
+    }
+}
+
+void thread_pool::wait_for_batches(size_t worker)
+{
+    size_t finished_batch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start_condition.wait(lock, [this, finished_batch] {
+                return stopping || batch != finished_batch;
+            });
+            if (stopping) {
+                return;
+            }
+            finished_batch = batch;
+        }
+
+        do_tasks(worker);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--nbusy == 0) {
+                done_condition.notify_one();
+            }
+        }
+    }
+}
+
+void thread_pool::do_tasks(size_t worker)
+{
+    for (size_t i = next_task++; i < ntasks; i = next_task++) {
+        try {
+            (*current_task)(i, worker);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>   // for std::exception_ptr
+#include <functional>  // for std::function
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ *  @class thread_pool
+ *
+ *  @brief Runs batches of independent tasks on a fixed set of worker threads.
+ *
+ *  The threads are started when the pool is constructed and wait between
+ *  batches, so a pool can run many small batches without paying for thread
+ *  creation each time. The thread that calls `run` also works on the batch, so
+ *  a pool with `nworkers` workers starts `nworkers - 1` threads.
+ *
+ *  Each task is identified by its index and is passed the index of the worker
+ *  that runs it, which is always less than `get_nworkers()`. No two tasks run
+ *  on the same worker at the same time, so a task can safely use data that
+ *  belongs to its worker. If any task throws an exception, the rest of the
+ *  batch still runs and the first exception is rethrown by `run`.
+ */
+class thread_pool
+{
+   public:
+    typedef std::function<void(size_t task, size_t worker)> task_type;
+
+    explicit thread_pool(size_t nworkers);
+    ~thread_pool();
+
+    thread_pool(thread_pool const&) = delete;
+    thread_pool& operator=(thread_pool const&) = delete;
+
+    size_t get_nworkers() const { return threads.size() + 1; }
+
+    void run(size_t ntasks, task_type const& task);
+
+   private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable start_condition;
+    std::condition_variable done_condition;
+
+    // The current batch
+    task_type const* current_task = nullptr;
+    size_t ntasks = 0;
+    std::atomic<size_t> next_task{0};
+    size_t nbusy = 0;
+    size_t batch = 0;
+    std::exception_ptr error;
+
+    bool stopping = false;
+
+    void wait_for_batches(size_t worker);
+    void do_tasks(size_t worker);
+};
+
+#endif